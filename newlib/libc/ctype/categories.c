@@ -2,6 +2,23 @@
 #include <stdint.h>
 #include "categories.h"
 
+#ifdef _UNICODE_PAGE_TABLES
+
+#include "catpages.t"
+
+enum category category(wint_t ucs)
+{
+  unsigned int cat;
+
+  if (ucs >= CAT_PAGE_LIMIT)
+    return -1;
+  cat = cat_pages[cat_page_index[ucs >> CAT_PAGE_SHIFT]]
+		 [ucs & ((1 << CAT_PAGE_SHIFT) - 1)];
+  return cat == 0xff ? (enum category) -1 : (enum category) cat;
+}
+
+#else /* !_UNICODE_PAGE_TABLES */
+
 struct _category {
   enum category cat: 8;
   uint_least32_t first: 24;
@@ -38,3 +55,5 @@ enum category category(wint_t ucs)
   return bisearch_cat(ucs, categories,
 		      sizeof(categories) / sizeof(*categories) - 1);
 }
+
+#endif /* !_UNICODE_PAGE_TABLES */
@@ -47,6 +47,22 @@ caseconv_table [] = {
 #define first(ce)	ce.first
 #define last(ce)	(ce.first + ce.diff)
 
+#ifdef _UNICODE_PAGE_TABLES
+#include "casepages.t"
+
+/* look up the entry for ucs in the two-stage table generated by mkpagetab */
+static const struct caseconv_entry *
+find_caseconv (wint_t ucs)
+{
+  unsigned int idx;
+
+  if (ucs >= CASECONV_PAGE_LIMIT)
+    return 0;
+  idx = caseconv_pages[caseconv_page_index[ucs >> CASECONV_PAGE_SHIFT]]
+		      [ucs & ((1 << CASECONV_PAGE_SHIFT) - 1)];
+  return idx ? &caseconv_table[idx - 1] : 0;
+}
+#else /* !_UNICODE_PAGE_TABLES */
 /* auxiliary function for binary search in interval properties table */
 static const struct caseconv_entry *
 bisearch (wint_t ucs, const struct caseconv_entry *table, int max)
@@ -69,12 +85,18 @@ bisearch (wint_t ucs, const struct caseconv_entry *table, int max)
   return 0;
 }
 
+static const struct caseconv_entry *
+find_caseconv (wint_t ucs)
+{
+  return bisearch(ucs, caseconv_table,
+		  sizeof(caseconv_table) / sizeof(*caseconv_table) - 1);
+}
+#endif /* !_UNICODE_PAGE_TABLES */
+
 static wint_t
 toulower (wint_t c)
 {
-  const struct caseconv_entry * cce =
-    bisearch(c, caseconv_table,
-             sizeof(caseconv_table) / sizeof(*caseconv_table) - 1);
+  const struct caseconv_entry * cce = find_caseconv (c);
 
   if (cce)
     switch (cce->mode)
@@ -107,9 +129,7 @@ toulower (wint_t c)
 static wint_t
 touupper (wint_t c)
 {
-  const struct caseconv_entry * cce =
-    bisearch(c, caseconv_table,
-             sizeof(caseconv_table) / sizeof(*caseconv_table) - 1);
+  const struct caseconv_entry * cce = find_caseconv (c);
 
   if (cce)
     switch (cce->mode)
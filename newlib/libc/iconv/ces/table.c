@@ -41,6 +41,13 @@
 #include "../lib/local.h"
 #include "../lib/ucsconv.h"
 #include "../ccs/ccs.h"
+#include "../ccs/ccsbi.h"
+
+#if defined (ICONV_BULK_CONVERSION) \
+ && (defined (ICONV_TO_UCS_CCS_ISO_8859_1) \
+     || defined (ICONV_FROM_UCS_CCS_ISO_8859_1))
+#  define TABLE_BULK_LATIN1
+#endif
 
 /*
  * Table-based CES converter is implemented here.  Table-based CES converter
@@ -253,6 +260,21 @@ table_get_mb_cur_max (void *data)
   return ((iconv_ccs_desc_t *)data)->bits/8;
 }
 
+#ifdef TABLE_BULK_LATIN1
+/* The built-in ISO-8859-1 tables map each byte to the same code point.  */
+static int
+table_get_bulk (void *data)
+{
+  const iconv_ccs_desc_t *ccsp = (iconv_ccs_desc_t *)data;
+
+  if (ccsp->type == TABLE_BUILTIN
+      && (ccsp->tbl == _iconv_ccs_iso_8859_1.to_ucs
+          || ccsp->tbl == _iconv_ccs_iso_8859_1.from_ucs))
+    return ICONV_BULK_LATIN1;
+  return ICONV_BULK_NONE;
+}
+#endif
+
 
 #if defined (ICONV_TO_UCS_CES_TABLE)
 const iconv_to_ucs_ces_handlers_t
@@ -264,7 +286,10 @@ _iconv_to_ucs_ces_handlers_table =
   NULL,
   NULL,
   NULL,
-  table_convert_to_ucs
+  table_convert_to_ucs,
+#ifdef TABLE_BULK_LATIN1
+  table_get_bulk
+#endif
 };
 #endif /* ICONV_FROM_UCS_CES_TABLE */
 
@@ -278,7 +303,10 @@ _iconv_from_ucs_ces_handlers_table =
   NULL,
   NULL,
   NULL,
-  table_convert_from_ucs
+  table_convert_from_ucs,
+#ifdef TABLE_BULK_LATIN1
+  table_get_bulk
+#endif
 };
 #endif /* ICONV_TO_UCS_CES_TABLE */
 
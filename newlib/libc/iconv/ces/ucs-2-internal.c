@@ -92,6 +92,18 @@ ucs_2_internal_get_mb_cur_max (void *data)
   return 2;
 }
 
+#ifdef ICONV_BULK_CONVERSION
+static int
+ucs_2_internal_get_bulk (void *data)
+{
+#if (BYTE_ORDER == LITTLE_ENDIAN)
+  return ICONV_BULK_UCS2LE;
+#else
+  return ICONV_BULK_UCS2BE;
+#endif
+}
+#endif
+
 #if defined (ICONV_TO_UCS_CES_UCS_2_INTERNAL)
 const iconv_to_ucs_ces_handlers_t
 _iconv_to_ucs_ces_handlers_ucs_2_internal = 
@@ -102,7 +114,10 @@ _iconv_to_ucs_ces_handlers_ucs_2_internal =
   NULL,
   NULL,
   NULL,
-  ucs_2_internal_convert_to_ucs
+  ucs_2_internal_convert_to_ucs,
+#ifdef ICONV_BULK_CONVERSION
+  ucs_2_internal_get_bulk
+#endif
 };
 #endif
 
@@ -116,7 +131,10 @@ _iconv_from_ucs_ces_handlers_ucs_2_internal =
   NULL,
   NULL,
   NULL,
-  ucs_2_internal_convert_from_ucs
+  ucs_2_internal_convert_from_ucs,
+#ifdef ICONV_BULK_CONVERSION
+  ucs_2_internal_get_bulk
+#endif
 };
 #endif
 
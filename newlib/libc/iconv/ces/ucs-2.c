@@ -133,6 +133,15 @@ ucs_2_get_mb_cur_max (void *data)
   return 2;
 }
 
+#ifdef ICONV_BULK_CONVERSION
+static int
+ucs_2_get_bulk (void *data)
+{
+  return *((int *)data) == UCS_2_BIG_ENDIAN ? ICONV_BULK_UCS2BE
+                                           : ICONV_BULK_UCS2LE;
+}
+#endif
+
 #if defined (ICONV_TO_UCS_CES_UCS_2)
 const iconv_to_ucs_ces_handlers_t
 _iconv_to_ucs_ces_handlers_ucs_2 = 
@@ -143,7 +152,10 @@ _iconv_to_ucs_ces_handlers_ucs_2 =
   NULL,
   NULL,
   NULL,
-  ucs_2_convert_to_ucs
+  ucs_2_convert_to_ucs,
+#ifdef ICONV_BULK_CONVERSION
+  ucs_2_get_bulk
+#endif
 };
 #endif
 
@@ -157,7 +169,10 @@ _iconv_from_ucs_ces_handlers_ucs_2 =
   NULL,
   NULL,
   NULL,
-  ucs_2_convert_from_ucs
+  ucs_2_convert_from_ucs,
+#ifdef ICONV_BULK_CONVERSION
+  ucs_2_get_bulk
+#endif
 };
 #endif
 
@@ -135,6 +135,15 @@ ucs_4_get_mb_cur_max (void *data)
   return 4;
 }
 
+#ifdef ICONV_BULK_CONVERSION
+static int
+ucs_4_get_bulk (void *data)
+{
+  return *((int *)data) == UCS_4_BIG_ENDIAN ? ICONV_BULK_UCS4BE
+                                           : ICONV_BULK_UCS4LE;
+}
+#endif
+
 #if defined (ICONV_TO_UCS_CES_UCS_4)
 const iconv_to_ucs_ces_handlers_t
 _iconv_to_ucs_ces_handlers_ucs_4 = 
@@ -145,7 +154,10 @@ _iconv_to_ucs_ces_handlers_ucs_4 =
   NULL,
   NULL,
   NULL,
-  ucs_4_convert_to_ucs
+  ucs_4_convert_to_ucs,
+#ifdef ICONV_BULK_CONVERSION
+  ucs_4_get_bulk
+#endif
 };
 #endif
 
@@ -159,7 +171,10 @@ _iconv_from_ucs_ces_handlers_ucs_4 =
   NULL,
   NULL,
   NULL,
-  ucs_4_convert_from_ucs
+  ucs_4_convert_from_ucs,
+#ifdef ICONV_BULK_CONVERSION
+  ucs_4_get_bulk
+#endif
 };
 #endif
 
@@ -86,6 +86,14 @@ us_ascii_get_mb_cur_max (void *data)
   return 2;
 }
 
+#ifdef ICONV_BULK_CONVERSION
+static int
+us_ascii_get_bulk (void *data)
+{
+  return ICONV_BULK_ASCII;
+}
+#endif
+
 #if defined (ICONV_TO_UCS_CES_US_ASCII)
 const iconv_to_ucs_ces_handlers_t
 _iconv_to_ucs_ces_handlers_us_ascii = 
@@ -96,7 +104,10 @@ _iconv_to_ucs_ces_handlers_us_ascii =
   NULL,
   NULL,
   NULL,
-  us_ascii_convert_to_ucs
+  us_ascii_convert_to_ucs,
+#ifdef ICONV_BULK_CONVERSION
+  us_ascii_get_bulk
+#endif
 };
 #endif
 
@@ -110,7 +121,10 @@ _iconv_from_ucs_ces_handlers_us_ascii =
   NULL,
   NULL,
   NULL,
-  us_ascii_convert_from_ucs
+  us_ascii_convert_from_ucs,
+#ifdef ICONV_BULK_CONVERSION
+  us_ascii_get_bulk
+#endif
 };
 #endif
 
@@ -268,6 +268,29 @@ utf_16_get_mb_cur_max (void *data)
   return 6;
 }
 
+#ifdef ICONV_BULK_CONVERSION
+/* Until the byte order is known from the BOM, or the BOM has been written,
+   characters go through the per-character handlers.  */
+static int
+utf_16_get_bulk (void *data)
+{
+  switch (*((int *)data))
+    {
+      case UTF16_BIG_ENDIAN:
+        return ICONV_BULK_UTF16BE;
+      case UTF16_LITTLE_ENDIAN:
+        return ICONV_BULK_UTF16LE;
+      case (UTF16_SYSTEM_ENDIAN | UTF16_BOM_WRITTEN):
+#if (BYTE_ORDER == LITTLE_ENDIAN)
+        return ICONV_BULK_UTF16LE;
+#else
+        return ICONV_BULK_UTF16BE;
+#endif
+    }
+  return ICONV_BULK_NONE;
+}
+#endif
+
 #if defined (ICONV_TO_UCS_CES_UTF_16)
 const iconv_to_ucs_ces_handlers_t
 _iconv_to_ucs_ces_handlers_utf_16 = 
@@ -278,7 +301,10 @@ _iconv_to_ucs_ces_handlers_utf_16 =
   NULL,
   NULL,
   NULL,
-  utf_16_convert_to_ucs
+  utf_16_convert_to_ucs,
+#ifdef ICONV_BULK_CONVERSION
+  utf_16_get_bulk
+#endif
 };
 #endif
 
@@ -292,7 +318,10 @@ _iconv_from_ucs_ces_handlers_utf_16 =
   NULL,
   NULL,
   NULL,
-  utf_16_convert_from_ucs
+  utf_16_convert_from_ucs,
+#ifdef ICONV_BULK_CONVERSION
+  utf_16_get_bulk
+#endif
 };
 #endif
 
@@ -262,6 +262,14 @@ get_mb_cur_max (void *data)
   return UTF8_MB_CUR_MAX;
 }
 
+#ifdef ICONV_BULK_CONVERSION
+static int
+get_bulk (void *data)
+{
+  return ICONV_BULK_UTF8;
+}
+#endif
+
 #if defined (ICONV_TO_UCS_CES_UTF_8)
 const iconv_to_ucs_ces_handlers_t
 _iconv_to_ucs_ces_handlers_utf_8 = 
@@ -272,7 +280,10 @@ _iconv_to_ucs_ces_handlers_utf_8 =
   NULL,
   NULL,
   NULL,
-  convert_to_ucs
+  convert_to_ucs,
+#ifdef ICONV_BULK_CONVERSION
+  get_bulk
+#endif
 };
 #endif
 
@@ -286,7 +297,10 @@ _iconv_from_ucs_ces_handlers_utf_8 =
   NULL,
   NULL,
   NULL,
-  convert_from_ucs
+  convert_from_ucs,
+#ifdef ICONV_BULK_CONVERSION
+  get_bulk
+#endif
 };
 #endif
 
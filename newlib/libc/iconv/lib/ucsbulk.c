@@ -0,0 +1,435 @@
+/*
+ * ====================================================
+ * Permission to use, copy, modify, and distribute this
+ * software is freely granted, provided that this notice
+ * is preserved.
+ * ====================================================
+ */
+#include <_ansi.h>
+#include <sys/types.h>
+#include <sys/cdefs.h>
+#include <string.h>
+#include "local.h"
+#include "ucsconv.h"
+
+#ifdef ICONV_BULK_CONVERSION
+
+/*
+ * Whole-buffer conversion kernels for ucs_based_conversion_convert.
+ *
+ * A kernel converts only characters it can be sure of: well-formed UTF-8
+ * and UTF-16 input, code points up to U+10FFFF other than surrogates,
+ * U+FFFE and U+FFFF, and output the destination form can represent.
+ * Anything else is left to the per-character handlers of the CES
+ * converters, which report the error or substitute the character exactly
+ * as they always did.
+ *
+ * Runs of ASCII characters, common in all kinds of text, are found a
+ * machine word at a time and copied without decoding.
+ */
+
+/* Code unit size and the offset of its low byte, by ICONV_BULK_XXX form */
+static const struct
+{
+  unsigned char unit;
+  unsigned char low;
+} forms[] =
+{
+  { 1, 0 }, /* NONE */
+  { 1, 0 }, /* ASCII */
+  { 1, 0 }, /* LATIN1 */
+  { 1, 0 }, /* UTF8 */
+  { 2, 1 }, /* UCS2BE */
+  { 2, 0 }, /* UCS2LE */
+  { 2, 1 }, /* UTF16BE */
+  { 2, 0 }, /* UTF16LE */
+  { 4, 3 }, /* UCS4BE */
+  { 4, 0 }  /* UCS4LE */
+};
+
+#define IS_LE(form) ((form) == ICONV_BULK_UCS2LE \
+                     || (form) == ICONV_BULK_UTF16LE \
+                     || (form) == ICONV_BULK_UCS4LE)
+
+static __inline ucs4_t
+get16 (const unsigned char *p,
+              int le)
+{
+  return le ? (ucs4_t)p[0] | (ucs4_t)p[1] << 8
+            : (ucs4_t)p[0] << 8 | (ucs4_t)p[1];
+}
+
+static __inline void
+put16 (unsigned char *p,
+              ucs4_t c,
+              int le)
+{
+  p[!le] = (unsigned char)c;
+  p[le] = (unsigned char)(c >> 8);
+}
+
+/*
+ * Decode one character at IN, with LEFT bytes available. Returns the
+ * length of the character, or 0 if the kernels don't handle it.
+ */
+static __always_inline size_t
+decode (int form,
+               const unsigned char *in,
+               size_t left,
+               ucs4_t *res)
+{
+  ucs4_t c, c2;
+
+  switch (form)
+    {
+      case ICONV_BULK_ASCII:
+        if (in[0] >= 0x80)
+          return 0;
+        /* FALLTHROUGH */
+      case ICONV_BULK_LATIN1:
+        *res = in[0];
+        return 1;
+
+      case ICONV_BULK_UTF8:
+        c = in[0];
+        if (c < 0x80)
+          {
+            *res = c;
+            return 1;
+          }
+        if (c < 0xC2) /* Continuation byte or overlong sequence */
+          return 0;
+        if (c < 0xE0)
+          {
+            if (left < 2 || (in[1] & 0xC0) != 0x80)
+              return 0;
+            *res = (c & 0x1F) << 6 | (in[1] & 0x3F);
+            return 2;
+          }
+        if (c < 0xF0)
+          {
+            if (left < 3 || (in[1] & 0xC0) != 0x80 || (in[2] & 0xC0) != 0x80)
+              return 0;
+            c = (c & 0x0F) << 12 | (ucs4_t)(in[1] & 0x3F) << 6 | (in[2] & 0x3F);
+            if (c < 0x800 || (c >= 0xD800 && c <= 0xDFFF) || c >= 0xFFFE)
+              return 0;
+            *res = c;
+            return 3;
+          }
+        if (c < 0xF5)
+          {
+            if (left < 4 || (in[1] & 0xC0) != 0x80 || (in[2] & 0xC0) != 0x80
+                || (in[3] & 0xC0) != 0x80)
+              return 0;
+            c = (c & 0x07) << 18 | (ucs4_t)(in[1] & 0x3F) << 12
+                | (ucs4_t)(in[2] & 0x3F) << 6 | (in[3] & 0x3F);
+            if (c < 0x10000 || c > 0x10FFFF)
+              return 0;
+            *res = c;
+            return 4;
+          }
+        return 0;
+
+      case ICONV_BULK_UCS2BE:
+      case ICONV_BULK_UCS2LE:
+        if (left < 2)
+          return 0;
+        c = get16 (in, IS_LE (form));
+        if ((c >= 0xD800 && c <= 0xDFFF) || c >= 0xFFFE)
+          return 0;
+        *res = c;
+        return 2;
+
+      case ICONV_BULK_UTF16BE:
+      case ICONV_BULK_UTF16LE:
+        if (left < 2)
+          return 0;
+        c = get16 (in, IS_LE (form));
+        if (c < 0xD800 || (c > 0xDFFF && c < 0xFFFE))
+          {
+            *res = c;
+            return 2;
+          }
+        if (c > 0xDBFF || left < 4)
+          return 0;
+        c2 = get16 (in + 2, IS_LE (form));
+        if (c2 < 0xDC00 || c2 > 0xDFFF)
+          return 0;
+        *res = (((c & 0x3FF) << 10) | (c2 & 0x3FF)) + 0x10000;
+        return 4;
+
+      case ICONV_BULK_UCS4BE:
+      case ICONV_BULK_UCS4LE:
+        if (left < 4)
+          return 0;
+        if (form == ICONV_BULK_UCS4LE)
+          c = (ucs4_t)in[3] << 24 | (ucs4_t)in[2] << 16
+              | (ucs4_t)in[1] << 8 | in[0];
+        else
+          c = (ucs4_t)in[0] << 24 | (ucs4_t)in[1] << 16
+              | (ucs4_t)in[2] << 8 | in[3];
+        if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)
+            || c == 0xFFFE || c == 0xFFFF)
+          return 0;
+        *res = c;
+        return 4;
+    }
+
+  return 0;
+}
+
+/*
+ * Encode the character C, which decode has accepted, at OUT with LEFT
+ * bytes available. Returns the length written, or 0 if C can't be
+ * represented or doesn't fit.
+ */
+static __always_inline size_t
+encode (int form,
+               ucs4_t c,
+               unsigned char *out,
+               size_t left)
+{
+  switch (form)
+    {
+      case ICONV_BULK_ASCII:
+        if (c >= 0x80 || left < 1)
+          return 0;
+        *out = (unsigned char)c;
+        return 1;
+
+      case ICONV_BULK_LATIN1:
+        if (c > 0xFF || left < 1)
+          return 0;
+        *out = (unsigned char)c;
+        return 1;
+
+      case ICONV_BULK_UTF8:
+        if (c < 0x80)
+          {
+            if (left < 1)
+              return 0;
+            out[0] = (unsigned char)c;
+            return 1;
+          }
+        if (c < 0x800)
+          {
+            if (left < 2)
+              return 0;
+            out[0] = (unsigned char)(c >> 6 | 0xC0);
+            out[1] = (unsigned char)((c & 0x3F) | 0x80);
+            return 2;
+          }
+        if (c < 0x10000)
+          {
+            if (left < 3)
+              return 0;
+            out[0] = (unsigned char)(c >> 12 | 0xE0);
+            out[1] = (unsigned char)((c >> 6 & 0x3F) | 0x80);
+            out[2] = (unsigned char)((c & 0x3F) | 0x80);
+            return 3;
+          }
+        if (left < 4)
+          return 0;
+        out[0] = (unsigned char)(c >> 18 | 0xF0);
+        out[1] = (unsigned char)((c >> 12 & 0x3F) | 0x80);
+        out[2] = (unsigned char)((c >> 6 & 0x3F) | 0x80);
+        out[3] = (unsigned char)((c & 0x3F) | 0x80);
+        return 4;
+
+      case ICONV_BULK_UCS2BE:
+      case ICONV_BULK_UCS2LE:
+        if (c > 0xFFFF || left < 2)
+          return 0;
+        put16 (out, c, IS_LE (form));
+        return 2;
+
+      case ICONV_BULK_UTF16BE:
+      case ICONV_BULK_UTF16LE:
+        if (c < 0x10000)
+          {
+            if (left < 2)
+              return 0;
+            put16 (out, c, IS_LE (form));
+            return 2;
+          }
+        if (left < 4)
+          return 0;
+        c -= 0x10000;
+        put16 (out, 0xD800 | c >> 10, IS_LE (form));
+        put16 (out + 2, 0xDC00 | (c & 0x3FF), IS_LE (form));
+        return 4;
+
+      case ICONV_BULK_UCS4BE:
+      case ICONV_BULK_UCS4LE:
+        if (left < 4)
+          return 0;
+        if (form == ICONV_BULK_UCS4LE)
+          {
+            out[0] = (unsigned char)c;
+            out[1] = (unsigned char)(c >> 8);
+            out[2] = (unsigned char)(c >> 16);
+            out[3] = 0;
+          }
+        else
+          {
+            out[0] = 0;
+            out[1] = (unsigned char)(c >> 16);
+            out[2] = (unsigned char)(c >> 8);
+            out[3] = (unsigned char)c;
+          }
+        return 4;
+    }
+
+  return 0;
+}
+
+/* Nonzero if the code unit of size UNIT at P, with its low byte at LOW,
+   is an ASCII character.  */
+static __always_inline int
+ascii_unit (const unsigned char *p,
+                   size_t unit,
+                   size_t low)
+{
+  size_t j;
+
+  for (j = 0; j < unit; j++)
+    if (p[j] & (j == low ? 0x80 : 0xFF))
+      return 0;
+  return 1;
+}
+
+/*
+ * Return the number of ASCII code units, up to N, at IN. MASK has the
+ * bits set which are clear in every ASCII unit, for a word's worth of
+ * units.
+ */
+static __always_inline size_t
+ascii_run (const unsigned char *in,
+                  size_t n,
+                  size_t unit,
+                  size_t low,
+                  unsigned long mask)
+{
+  size_t per = sizeof (unsigned long) / unit;
+  size_t i = 0;
+
+  /* One unit at a time up to a word boundary, then whole words */
+  for (; i < n && ((long)(in + i * unit) & (sizeof (long) - 1)) != 0; i++)
+    if (!ascii_unit (in + i * unit, unit, low))
+      return i;
+
+  for (; i + per <= n; i += per)
+    if (*(const unsigned long *)(in + i * unit) & mask)
+      break;
+
+  for (; i < n; i++)
+    if (!ascii_unit (in + i * unit, unit, low))
+      return i;
+
+  return i;
+}
+
+/* Convert as _iconv_ucs_bulk_convert does; inlined for each of the
+   common pairs of forms so that the form tests fold away.  */
+static __always_inline void
+bulk_convert (int from,
+                     int to,
+                     const unsigned char **inbuf,
+                     size_t *inbytesleft,
+                     unsigned char **outbuf,
+                     size_t *outbytesleft)
+{
+  const unsigned char *in = *inbuf;
+  const unsigned char *inend = in + *inbytesleft;
+  unsigned char *out = *outbuf;
+  unsigned char *outend = out + *outbytesleft;
+  size_t inunit = forms[from].unit, inlow = forms[from].low;
+  size_t outunit = forms[to].unit, outlow = forms[to].low;
+  unsigned char m[sizeof (unsigned long)];
+  unsigned long mask;
+  size_t i, n, len;
+  ucs4_t c;
+
+  /* 0x80 in the low byte of each unit, 0xFF in the others */
+  for (i = 0; i < sizeof (m); i++)
+    m[i] = (i % inunit == inlow) ? 0x80 : 0xFF;
+  memcpy (&mask, m, sizeof (mask));
+
+  while (in < inend)
+    {
+      n = (size_t)(inend - in) / inunit;
+      if (n > (size_t)(outend - out) / outunit)
+        n = (size_t)(outend - out) / outunit;
+      n = ascii_run (in, n, inunit, inlow, mask);
+
+      if (n > 0)
+        {
+          if (inunit == 1 && outunit == 1)
+            memcpy (out, in, n);
+          else if (outunit == 1)
+            for (i = 0; i < n; i++)
+              out[i] = in[i * inunit + inlow];
+          else if (outunit == 2)
+            for (i = 0; i < n; i++)
+              put16 (out + i * 2, in[i * inunit + inlow], IS_LE (to));
+          else
+            for (i = 0; i < n; i++)
+              {
+                out[i * 4] = out[i * 4 + 1] = out[i * 4 + 2] = out[i * 4 + 3] = 0;
+                out[i * 4 + outlow] = in[i * inunit + inlow];
+              }
+          in += n * inunit;
+          out += n * outunit;
+          if (in == inend)
+            break;
+        }
+
+      if ((len = decode (from, in, inend - in, &c)) == 0)
+        break;
+      if ((n = encode (to, c, out, outend - out)) == 0)
+        break;
+      in += len;
+      out += n;
+    }
+
+  *inbytesleft -= in - *inbuf;
+  *inbuf = in;
+  *outbytesleft -= out - *outbuf;
+  *outbuf = out;
+}
+
+#define PAIR(from, to) ((from) << 4 | (to))
+
+void
+_iconv_ucs_bulk_convert (int from,
+                                int to,
+                                const unsigned char **inbuf,
+                                size_t *inbytesleft,
+                                unsigned char **outbuf,
+                                size_t *outbytesleft)
+{
+#define KERNEL(from, to) \
+    case PAIR (from, to): \
+      bulk_convert (from, to, inbuf, inbytesleft, outbuf, outbytesleft); \
+      return; \
+    case PAIR (to, from): \
+      bulk_convert (to, from, inbuf, inbytesleft, outbuf, outbytesleft); \
+      return;
+
+  switch (PAIR (from, to))
+    {
+      KERNEL (ICONV_BULK_UTF8, ICONV_BULK_ASCII)
+      KERNEL (ICONV_BULK_UTF8, ICONV_BULK_LATIN1)
+      KERNEL (ICONV_BULK_UTF8, ICONV_BULK_UCS2BE)
+      KERNEL (ICONV_BULK_UTF8, ICONV_BULK_UCS2LE)
+      KERNEL (ICONV_BULK_UTF8, ICONV_BULK_UTF16BE)
+      KERNEL (ICONV_BULK_UTF8, ICONV_BULK_UTF16LE)
+      KERNEL (ICONV_BULK_UTF8, ICONV_BULK_UCS4BE)
+      KERNEL (ICONV_BULK_UTF8, ICONV_BULK_UCS4LE)
+    }
+
+  /* Other pairs, not specialized */
+  bulk_convert (from, to, inbuf, inbytesleft, outbuf, outbytesleft);
+}
+
+#endif /* ICONV_BULK_CONVERSION */
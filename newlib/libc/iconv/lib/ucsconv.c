@@ -159,8 +159,33 @@ ucs_based_conversion_convert (struct _reent *rptr,
     {
       register size_t bytes;
       register ucs4_t ch;
-      const unsigned char *inbuf_save = *inbuf;
-      size_t inbyteslef_save = *inbytesleft;
+      const unsigned char *inbuf_save;
+      size_t inbyteslef_save;
+
+#ifdef ICONV_BULK_CONVERSION
+      /*
+       * Let the bulk kernels take as much as they can; the character they
+       * stop at, if any, goes through the per-character handlers below.
+       */
+      if (!(flags & ICONV_DONT_SAVE_BIT)
+          && uc->to_ucs.handlers->get_bulk != NULL
+          && uc->from_ucs.handlers->get_bulk != NULL)
+        {
+          int from = uc->to_ucs.handlers->get_bulk (uc->to_ucs.data);
+          int to = uc->from_ucs.handlers->get_bulk (uc->from_ucs.data);
+
+          if (from != ICONV_BULK_NONE && to != ICONV_BULK_NONE)
+            {
+              _iconv_ucs_bulk_convert (from, to, inbuf, inbytesleft,
+                                       outbuf, outbytesleft);
+              if (*inbytesleft == 0)
+                break;
+            }
+        }
+#endif
+
+      inbuf_save = *inbuf;
+      inbyteslef_save = *inbytesleft;
 
       if (*outbytesleft == 0)
         {
@@ -219,8 +244,10 @@ ucs_based_conversion_convert (struct _reent *rptr,
                                          (ucs4_t)DEFAULT_CHARACTER,
                                          outbuf,
                                          outbytesleft);
-          if ((__int32_t)bytes < 0)
+          if (bytes == (size_t)ICONV_CES_NOSPACE || (__int32_t)bytes < 0)
             {
+              *inbuf = inbuf_save;
+              *inbytesleft = inbyteslef_save;
               _REENT_ERRNO (rptr) = E2BIG;
               return (size_t)-1;
             }
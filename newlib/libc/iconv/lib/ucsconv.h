@@ -41,6 +41,26 @@
 /* All unknown characters are marked by this code */
 #define DEFAULT_CHARACTER 0x3f /* ASCII '?' */
 
+/*
+ * Whole-buffer conversion between the common Unicode encodings is done by
+ * the kernels in ucsbulk.c rather than one character at a time.
+ */
+#if !defined (PREFER_SIZE_OVER_SPEED) && !defined (__OPTIMIZE_SIZE__)
+#  define ICONV_BULK_CONVERSION
+#endif
+
+/* Encoding forms known to the bulk conversion kernels */
+#define ICONV_BULK_NONE    0 /* Use the per-character handlers only */
+#define ICONV_BULK_ASCII   1
+#define ICONV_BULK_LATIN1  2
+#define ICONV_BULK_UTF8    3
+#define ICONV_BULK_UCS2BE  4
+#define ICONV_BULK_UCS2LE  5
+#define ICONV_BULK_UTF16BE 6
+#define ICONV_BULK_UTF16LE 7
+#define ICONV_BULK_UCS4BE  8
+#define ICONV_BULK_UCS4LE  9
+
 
 /*
  * iconv_to_ucs_ces_handlers_t - "to UCS" CES converter handlers.
@@ -158,6 +178,20 @@ typedef struct
   ucs4_t (*convert_to_ucs) (void *data,
                                  const unsigned char **inbuf,
                                  size_t *inbytesleft);
+
+  /*
+   * get_bulk - get encoding form for bulk conversion.
+   *
+   * PARAMETERS:
+   *   void *data   - CES converter-specific data;
+   *
+   * DESCRIPTION:
+   *   May be NULL. Returns one of the ICONV_BULK_XXX codes if, in the
+   *   current state, every character the bulk kernels accept for that form
+   *   is converted by 'convert_to_ucs' in the same way, else returns
+   *   ICONV_BULK_NONE.
+   */
+  int (*get_bulk) (void *data);
 } iconv_to_ucs_ces_handlers_t;
 
 
@@ -219,6 +253,9 @@ typedef struct
                                    ucs4_t in,
                                    unsigned char **outbuf,
                                    size_t *outbytesleft);
+
+  /* Same as in iconv_to_ucs_ces_handlers_t, for 'convert_from_ucs' */
+  int (*get_bulk) (void *data);
 } iconv_from_ucs_ces_handlers_t;
 
 
@@ -315,6 +352,34 @@ typedef struct
 } iconv_from_ucs_ces_t;
  
 
+#ifdef ICONV_BULK_CONVERSION
+/*
+ * _iconv_ucs_bulk_convert - convert a run of characters between two
+ * encoding forms.
+ *
+ * PARAMETERS:
+ *   int from, int to           - ICONV_BULK_XXX forms of input and output;
+ *   const unsigned char **inbuf - input buffer;
+ *   size_t *inbytesleft         - input buffer bytes count;
+ *   unsigned char **outbuf      - output buffer;
+ *   size_t *outbytesleft        - output buffer bytes count.
+ *
+ * DESCRIPTION:
+ *   Converts characters until the input ends, the output is full or a
+ *   character is met which the kernels leave to the per-character
+ *   handlers (malformed input, characters the output can't represent,
+ *   characters outside the Unicode range). The buffer pointers and
+ *   counts are updated as by the per-character handlers.
+ */
+void
+_iconv_ucs_bulk_convert (int from,
+                                int to,
+                                const unsigned char **inbuf,
+                                size_t *inbytesleft,
+                                unsigned char **outbuf,
+                                size_t *outbytesleft);
+#endif
+
 /* List of "to UCS" linked-in CES converters. */
 extern const iconv_to_ucs_ces_t
 _iconv_to_ucs_ces[];
@@ -12,4 +12,22 @@
 void __env_lock (struct _reent *reent);
 void __env_unlock (struct _reent *reent);
 
+/* Bumped under ENV_LOCK by every change setenv, putenv and unsetenv make
+   to the environment, so that tzset can tell that TZ is unchanged without
+   looking it up.  */
+extern unsigned int __env_gen;
+
+#ifdef _WANT_ENV_INDEX
+/* Drop the hash index getenv looks variables up in, under ENV_LOCK, after
+   changing the environment.  getenv_r.c builds it again when needed.  */
+void __env_index_drop (struct _reent *reent);
+
+#define ENV_CHANGED \
+  (__atomic_store_n (&__env_gen, __env_gen + 1, __ATOMIC_RELEASE), \
+   __env_index_drop (reent_ptr))
+#else
+#define ENV_CHANGED \
+  __atomic_store_n (&__env_gen, __env_gen + 1, __ATOMIC_RELEASE)
+#endif
+
 #endif /* _INCLUDE_ENVLOCK_H_ */
@@ -137,6 +137,61 @@ extern void __malloc_lock(struct _reent *);
 
 extern void __malloc_unlock(struct _reent *);
 
+#ifdef _MALLOC_INSTRUMENT
+/* Allocation counters, kept if newlib is configured with
+   --enable-newlib-malloc-instrument.  */
+
+#define MALLOC_HISTOGRAM_CLASSES 32
+
+struct malloc_counters {
+  size_t allocs[MALLOC_HISTOGRAM_CLASSES]; /* blocks allocated, by size class */
+  size_t frees[MALLOC_HISTOGRAM_CLASSES];  /* blocks freed, by size class */
+  unsigned long lock_acquires;   /* outermost __malloc_lock calls */
+  unsigned long lock_contended;  /* ... finding the lock held elsewhere */
+  unsigned long lock_hold_total; /* clock ticks the lock was held */
+  unsigned long lock_hold_max;   /* longest hold, in clock ticks */
+};
+
+#define MALLOC_EVENT_ALLOC 1
+#define MALLOC_EVENT_FREE  2
+
+typedef void (*malloc_event_hook_t) (int, void *, size_t, void *);
+
+extern void malloc_counters (struct malloc_counters *);
+extern void _malloc_counters_r (struct _reent *, struct malloc_counters *);
+
+extern malloc_event_hook_t malloc_set_event_hook (malloc_event_hook_t, void *);
+
+extern void malloc_set_lock_clock (unsigned long (*) (void));
+
+extern void malloc_dump_bins (void);
+extern void _malloc_dump_bins_r (struct _reent *);
+
+extern struct malloc_counters __malloc_counters;
+#endif
+
+#ifdef _MALLOC_TCACHE
+/* Return the calling thread's cached chunks to the shared pool.  */
+extern int __malloc_tcache_flush(struct _reent *);
+#endif
+
+/* Arenas: allocate many objects cheaply and release them together.  */
+
+struct marena;
+
+extern struct marena *marena_create (size_t);
+extern struct marena *_marena_create_r (struct _reent *, size_t);
+
+extern void *marena_alloc (struct marena *, size_t);
+extern void *_marena_alloc_r (struct _reent *, struct marena *, size_t);
+
+extern void marena_reset (struct marena *);
+
+extern void marena_destroy (struct marena *);
+extern void _marena_destroy_r (struct _reent *, struct marena *);
+
+extern struct mallinfo marena_mallinfo (struct marena *);
+
 /* A compatibility routine for an earlier version of the allocator.  */
 
 extern void mstats (char *);
@@ -80,6 +80,20 @@ _BEGIN_STD_C
 
 #endif /* !gcc >= 3.3  */
 
+/* libm has vector variants of some functions (see
+   libm/machine/x86_64/vec_variants.h and libm/machine/aarch64/vec_advsimd.c),
+   which GCC calls from the loops it vectorizes when errno need not be
+   set, that is with -fno-math-errno or -ffast-math.  */
+#if __GNUC_PREREQ (9, 0) && !__OBSOLETE_MATH && !defined (_LIBC) \
+    && !defined (__CYGWIN__) \
+    && ((defined (__x86_64__) && !defined (__ILP32__) \
+	 && !defined (__AVX512F__)) \
+	|| (defined (__aarch64__) && !defined (__ARM_FEATURE_SVE)))
+# define __DECL_SIMD __attribute__ ((__simd__ ("notinbranch")))
+#else
+# define __DECL_SIMD
+#endif
+
 /* Reentrant ANSI C functions.  */
 
 #ifndef __math_68881
@@ -104,9 +118,9 @@ extern double asin (double);
 extern double atan2 (double, double);
 extern double cosh (double);
 extern double sinh (double);
-extern double exp (double);
+extern double exp (double) __DECL_SIMD;
 extern double ldexp (double, int);
-extern double log (double);
+extern double log (double) __DECL_SIMD;
 extern double log10 (double);
 extern double pow (double, double);
 extern double sqrt (double);
@@ -371,8 +385,8 @@ extern double hypot (double, double);
 /* Single precision versions of ANSI functions.  */
 
 extern float atanf (float);
-extern float cosf (float);
-extern float sinf (float);
+extern float cosf (float) __DECL_SIMD;
+extern float sinf (float) __DECL_SIMD;
 extern float tanf (float);
 extern float tanhf (float);
 extern float frexpf (float, int *);
@@ -387,18 +401,18 @@ extern float asinf (float);
 extern float atan2f (float, float);
 extern float coshf (float);
 extern float sinhf (float);
-extern float expf (float);
+extern float expf (float) __DECL_SIMD;
 extern float ldexpf (float, int);
-extern float logf (float);
+extern float logf (float) __DECL_SIMD;
 extern float log10f (float);
-extern float powf (float, float);
+extern float powf (float, float) __DECL_SIMD;
 extern float sqrtf (float);
 extern float fmodf (float, float);
 #endif /* ! defined (_REENT_ONLY) */
 
 /* Other single precision functions.  */
 
-extern float exp2f (float);
+extern float exp2f (float) __DECL_SIMD;
 extern float scalblnf (float, long int);
 extern float tgammaf (float);
 extern float nearbyintf (float);
@@ -33,6 +33,7 @@ typedef enum {
 typedef struct node {
 	char         *key;
 	struct node  *llink, *rlink;
+	int           balance;	/* AVL: right minus left subtree height */
 } node_t;
 #endif
 
@@ -54,6 +55,8 @@ ENTRY	*hsearch(ENTRY, ACTION);
 int	 hcreate_r(size_t, struct hsearch_data *);
 void	 hdestroy_r(struct hsearch_data *);
 int	hsearch_r(ENTRY, ACTION, ENTRY **, struct hsearch_data *);
+int	hdelete(const char *);
+int	hdelete_r(const char *, struct hsearch_data *);
 void	*tdelete(const void *__restrict, void **__restrict, __compar_fn_t);
 void	tdestroy (void *, void (*)(void *));
 void	*tfind(const void *, void **, __compar_fn_t);
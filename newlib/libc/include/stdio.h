@@ -106,6 +106,7 @@ typedef _ssize_t ssize_t;
 
 /* _flags2 flags */
 #define	__SNLK  0x0001		/* stdio functions do not lock streams themselves */
+#define	__SMAP  0x0002		/* _bf is a read-only mapping of the file */
 #define	__SWID	0x2000		/* true => stream orientation wide, false => byte, only valid if __SORD in _flags is true */
 
 /*
@@ -21,6 +21,9 @@ _BEGIN_STD_C
 
 void	 __fpurge (FILE *);
 int	 __fsetlocking (FILE *, int);
+#ifdef _STDIO_ADAPTIVE_BUF
+size_t	 __fsetbufmax (size_t);
+#endif
 
 /* TODO:
 
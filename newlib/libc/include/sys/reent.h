@@ -190,9 +190,18 @@ struct __sFILE {
 
 #ifndef __SINGLE_THREAD__
   _flock_t _lock;	/* for thread-safety locking */
+#ifdef _STDIO_BIASED_LOCK
+  struct _reent *_lock_bias;	/* thread locking without atomics, or NULL */
+  int	_lock_busy;	/* its lock depth while it does so */
+  int	_lock_revoked;	/* set once another thread used the stream */
+#endif
 #endif
   _mbstate_t _mbstate;	/* for wide char stdio functions. */
   int   _flags2;        /* for future use */
+#ifdef _STDIO_ADAPTIVE_BUF
+  int	_bufrun;	/* full buffers transferred in a row, -1 if fixed */
+  int	_bufmin;	/* size the buffer was first allocated with */
+#endif
 };
 
 #ifdef __CUSTOM_FILE_IO__
@@ -245,8 +254,17 @@ struct __sFILE64 {
 
 #ifndef __SINGLE_THREAD__
   _flock_t _lock;	/* for thread-safety locking */
+#ifdef _STDIO_BIASED_LOCK
+  struct _reent *_lock_bias;	/* thread locking without atomics, or NULL */
+  int	_lock_busy;	/* its lock depth while it does so */
+  int	_lock_revoked;	/* set once another thread used the stream */
+#endif
 #endif
   _mbstate_t _mbstate;	/* for wide char stdio functions. */
+#ifdef _STDIO_ADAPTIVE_BUF
+  int	_bufrun;	/* full buffers transferred in a row, -1 if fixed */
+  int	_bufmin;	/* size the buffer was first allocated with */
+#endif
 };
 typedef struct __sFILE64 __FILE;
 #else
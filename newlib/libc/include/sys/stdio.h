@@ -4,6 +4,63 @@
 #include <sys/lock.h>
 #include <sys/reent.h>
 
+#if !defined (__SINGLE_THREAD__) && defined (_STDIO_BIASED_LOCK) \
+    && !defined (_flockfile)
+/* Biased stream locks.  A stream is biased to the thread that opened
+   it: as long as no other thread uses the stream, that thread only
+   counts its lock depth in _lock_busy, with plain stores and one fence
+   at the outermost level, and never touches _lock.  The first other
+   thread to lock the stream sets _lock_revoked and waits for
+   _lock_busy to drop to zero in __sflock_revoke; from then on all
+   threads use _lock.  _REENT must identify the calling thread.  */
+
+extern void __sflock_revoke (__FILE *);
+
+static __inline__ void
+__sflock_acquire (__FILE *fp)
+{
+  if (__atomic_load_n (&fp->_lock_bias, __ATOMIC_RELAXED) == _REENT)
+    {
+      int busy = fp->_lock_busy;
+
+      /* Nested, or first use: no other thread can hold the stream.  */
+      if (busy > 0)
+	{
+	  __atomic_store_n (&fp->_lock_busy, busy + 1, __ATOMIC_RELAXED);
+	  return;
+	}
+      if (!__atomic_load_n (&fp->_lock_revoked, __ATOMIC_RELAXED))
+	{
+	  __atomic_store_n (&fp->_lock_busy, 1, __ATOMIC_RELAXED);
+	  /* Pairs with the revoking thread's store and load, so that at
+	     least one of both threads sees the other's store.  */
+	  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+	  if (!__atomic_load_n (&fp->_lock_revoked, __ATOMIC_RELAXED))
+	    return;
+	  __atomic_store_n (&fp->_lock_busy, 0, __ATOMIC_RELEASE);
+	}
+    }
+  else if (__atomic_load_n (&fp->_lock_bias, __ATOMIC_RELAXED) != 0)
+    __sflock_revoke (fp);
+  __lock_acquire_recursive (fp->_lock);
+}
+
+static __inline__ void
+__sflock_release (__FILE *fp)
+{
+  int busy;
+
+  if (__atomic_load_n (&fp->_lock_bias, __ATOMIC_RELAXED) == _REENT
+      && (busy = fp->_lock_busy) > 0)
+    __atomic_store_n (&fp->_lock_busy, busy - 1, __ATOMIC_RELEASE);
+  else
+    __lock_release_recursive (fp->_lock);
+}
+
+#  define _flockfile(fp) (((fp)->_flags & __SSTR) ? (void) 0 : __sflock_acquire (fp))
+#  define _funlockfile(fp) (((fp)->_flags & __SSTR) ? (void) 0 : __sflock_release (fp))
+#endif /* !__SINGLE_THREAD__ && _STDIO_BIASED_LOCK && !_flockfile */
+
 /* Internal locking macros, used to protect stdio functions.  In the
    general case, expand to nothing. Use __SSTR flag in FILE _flags to
    detect if FILE is private to sprintf/sscanf class of functions; if
@@ -187,6 +187,7 @@ wchar_t	*wmemcpy (wchar_t *__restrict, const wchar_t *__restrict,
 				 size_t);
 wchar_t	*wmemmove (wchar_t *, const wchar_t *, size_t);
 #if __GNU_VISIBLE
+wchar_t	*wmemmem (const wchar_t *, size_t, const wchar_t *, size_t);
 wchar_t	*wmempcpy (wchar_t *__restrict, const wchar_t *__restrict,
 				 size_t);
 #endif
@@ -0,0 +1,13 @@
+/*
+ * ====================================================
+ * Permission to use, copy, modify, and distribute this
+ * software is freely granted, provided that this notice
+ * is preserved.
+ * ====================================================
+ */
+
+#if (defined (__OPTIMIZE_SIZE__) || defined (PREFER_SIZE_OVER_SPEED))
+# include "../../string/memmove.c"
+#else
+/* See memmove.S  */
+#endif
@@ -39,6 +39,7 @@
 #define r13 REG(r13)
 #define r14 REG(r14)
 #define r15 REG(r15)
+#define rip REG(rip)
 
 #define eax REG(eax)
 #define ebx REG(ebx)
@@ -49,6 +50,11 @@
 #define ebp REG(ebp)
 #define esp REG(esp)
 
+#define r8d  REG(r8d)
+#define r9d  REG(r9d)
+#define r10d REG(r10d)
+#define r11d REG(r11d)
+
 #define st0 REG(st)
 #define st1 REG(st(1))
 #define st2 REG(st(2))
@@ -74,6 +80,8 @@
 #define dl REG(dl)
 
 #define sil REG(sil)
+#define r8b REG(r8b)
+#define r8w REG(r8w)
 
 #define mm1 REG(mm1)
 #define mm2 REG(mm2)
@@ -91,6 +99,17 @@
 #define xmm5 REG(xmm5)
 #define xmm6 REG(xmm6)
 #define xmm7 REG(xmm7)
+#define xmm8 REG(xmm8)
+
+#define ymm0 REG(ymm0)
+#define ymm1 REG(ymm1)
+#define ymm2 REG(ymm2)
+#define ymm3 REG(ymm3)
+#define ymm4 REG(ymm4)
+#define ymm5 REG(ymm5)
+#define ymm6 REG(ymm6)
+#define ymm7 REG(ymm7)
+#define ymm8 REG(ymm8)
 
 #define cr0 REG(cr0)
 #define cr1 REG(cr1)
@@ -104,6 +123,50 @@
 #define SOTYPE_FUNCTION(sym)
 #endif
 
+/* Local labels.  */
+
+#define L(l) .L ## l
+
+/* Define SYM (name) to jump through a pointer which its first call sets
+   to SYM (__name_avx2) if the processor and the system support AVX2, and
+   to SYM (__name_sse2) otherwise.  The argument registers are saved
+   around the check for up to three arguments.  */
+
+#define DISPATCH(name) \
+  .text; \
+  .global SYM (name); \
+  SOTYPE_FUNCTION(name); \
+  .p2align 4; \
+SYM (name): \
+  jmp     *L(name ## _ptr)(rip); \
+L(name ## _init): \
+  pushq   rdi; \
+  pushq   rsi; \
+  pushq   rdx; \
+  call    SYM (__x86_64_avx2_usable); \
+  leaq    SYM (__ ## name ## _sse2)(rip), rcx; \
+  leaq    SYM (__ ## name ## _avx2)(rip), rdx; \
+  testl   eax, eax; \
+  cmovnzq rdx, rcx; \
+  movq    rcx, L(name ## _ptr)(rip); \
+  popq    rdx; \
+  popq    rsi; \
+  popq    rdi; \
+  jmp     *rcx; \
+  .data; \
+  .p2align 3; \
+L(name ## _ptr): \
+  .quad   L(name ## _init); \
+  .text
+
+/* Start the definition of a global function.  */
+
+#define ENTRY(name) \
+  .global SYM (name); \
+  SOTYPE_FUNCTION(name); \
+  .p2align 4; \
+SYM (name):
+
 #ifndef _I386MACH_DISABLE_HW_INTERRUPTS
 #define        __CLI
 #define        __STI
@@ -47,6 +47,9 @@
 #define	matcher	smatcher
 #define	fast	sfast
 #define	slow	sslow
+#define	dfast	sdfast
+#define	dfatrans	sdfatrans
+#define	dfastate	sdfastate
 #define	dissect	sdissect
 #define	backref	sbackref
 #define	step	sstep
@@ -58,6 +61,9 @@
 #define	matcher	lmatcher
 #define	fast	lfast
 #define	slow	lslow
+#define	dfast	ldfast
+#define	dfatrans	ldfatrans
+#define	dfastate	ldfastate
 #define	dissect	ldissect
 #define	backref	lbackref
 #define	step	lstep
@@ -94,6 +100,11 @@ static char *dissect(struct match *m, char *start, char *stop, sopno startst, so
 static char *backref(struct match *m, char *start, char *stop, sopno startst, sopno stopst, sopno lev);
 static char *fast(struct match *m, char *start, char *stop, sopno startst, sopno stopst);
 static char *slow(struct match *m, char *start, char *stop, sopno startst, sopno stopst);
+#ifdef RE_DFA
+static int dfast(struct match *m, char *start, char *stop, char **endpp);
+static int dfatrans(struct match *m, int s, int col);
+static int dfastate(struct match *m, states st, int bol);
+#endif
 static states step(struct re_guts *g, sopno start, sopno stop, states bef, int ch, states aft);
 #define	BOL	(OUT+1)
 #define	EOL	(BOL+1)
@@ -151,13 +162,6 @@ int eflags;
 	const sopno gl = g->laststate;
 	char *start;
 	char *stop;
-	/* Boyer-Moore algorithms variables */
-	char *pp;
-	int cj, mj;
-	char *mustfirst;
-	char *mustlast;
-	int *matchjump;
-	int *charjump;
 
 	/* simplify the situation where possible */
 	if (g->cflags&REG_NOSUB)
@@ -173,47 +177,20 @@ int eflags;
 		return(REG_INVARG);
 
 	/* prescreening; this does wonders for this rather slow code */
+	if (g->iflags&BOLANCHOR) {
+		/* any match starts with ^ and the prefix, at start only */
+		if ((eflags&REG_NOTBOL) || stop - start < g->plen ||
+		    (g->plen > 0 && memcmp(start, g->prefix, (size_t)g->plen) != 0))
+			return(REG_NOMATCH);
+	}
 	if (g->must != NULL) {
-		if (g->charjump != NULL && g->matchjump != NULL) {
-			mustfirst = g->must;
-			mustlast = g->must + g->mlen - 1;
-			charjump = g->charjump;
-			matchjump = g->matchjump;
-			pp = mustlast;
-			for (dp = start+g->mlen-1; dp < stop;) {
-				/* Fast skip non-matches */
-				while (dp < stop && charjump[(unsigned char) *dp])
-					dp += charjump[(unsigned char) *dp];
-
-				if (dp >= stop)
-					break;
-
-				/* Greedy matcher */
-				/* We depend on not being used for
-				 * for strings of length 1
-				 */
-				while (*--dp == *--pp && pp != mustfirst);
-
-				if (*dp == *pp)
-					break;
-
-				/* Jump to next possible match */
-				mj = matchjump[pp - mustfirst];
-				cj = charjump[(unsigned char) *dp];
-				dp += (cj < mj ? mj : cj);
-				pp = mustlast;
-			}
-			if (pp != mustfirst)
-				return(REG_NOMATCH);
-		} else {
-			for (dp = start; dp < stop; dp++)
-				if (*dp == g->must[0] &&
-				    stop - dp >= g->mlen &&
-				    memcmp(dp, g->must, (size_t)g->mlen) == 0)
-					break;
-			if (dp == stop)		/* we didn't find g->must */
-				return(REG_NOMATCH);
-		}
+		if (g->mlen == 1)
+			dp = memchr(start, g->must[0], (size_t)(stop - start));
+		else
+			dp = memmem(start, (size_t)(stop - start), g->must,
+			    (size_t)g->mlen);
+		if (dp == NULL)		/* we didn't find g->must */
+			return(REG_NOMATCH);
 	}
 
 	/* match struct setup */
@@ -235,9 +212,28 @@ int eflags;
 	if (g->moffset > -1)
 		start = ((dp - g->moffset) < start) ? start : dp - g->moffset;
 
+	/* No match can start before the first copy of the prefix */
+	if (g->plen > 0 && !(g->iflags&BOLANCHOR)) {
+		if (g->plen == 1)
+			dp = memchr(start, g->prefix[0], (size_t)(stop - start));
+		else
+			dp = memmem(start, (size_t)(stop - start), g->prefix,
+			    (size_t)g->plen);
+		if (dp == NULL) {
+			STATETEARDOWN(m);
+			return(REG_NOMATCH);
+		}
+		start = dp;
+	}
+
 	/* this loop does only one repetition except for backrefs */
 	for (;;) {
-		endp = fast(m, start, stop, gf, gl);
+#ifdef RE_DFA
+		if (g->dfa == NULL || g->dfa->keysize != KEYSIZE(g) ||
+		    DFA_GET(&g->dfa->giveups) >= DFA_MAXGIVEUPS ||
+		    !dfast(m, start, stop, &endp))
+#endif
+			endp = fast(m, start, stop, gf, gl);
 		if (endp == NULL) {		/* a miss */
 			STATETEARDOWN(m);
 			return(REG_NOMATCH);
@@ -829,6 +825,190 @@ sopno stopst;
 		return(NULL);
 }
 
+#ifdef RE_DFA
+/*
+ - dfast - do the work of fast() for the whole RE, through the DFA cache
+ == static int dfast(struct match *m, char *start, char *stop, \
+ ==	char **endpp);
+ * Returns 0, having found no room for a state it needed, if fast() has
+ * to do the work instead.  Otherwise sets *endpp and m->coldp as
+ * fast() would and returns 1.  stop must be m->endp.
+ */
+static int
+dfast(m, start, stop, endpp)
+struct match *m;
+char *start;
+char *stop;
+char **endpp;
+{
+	struct re_guts *g = m->g;
+	struct re_dfa *d = g->dfa;
+	const sopno gf = g->firststate+1;
+	states fresh = m->fresh;
+	const short *row;
+	char *p = start;
+	char *coldp = NULL;
+	int bol, col, s, t;
+
+	assert(stop == m->endp);
+	CLEAR(fresh);
+	SET1(fresh, gf);
+	fresh = step(g, gf, g->laststate, fresh, NOTHING, fresh);
+	m->fresh = fresh;
+
+	/* the start state depends on whether a ^ can match first */
+	bol = 0;
+	if (g->nbol > 0) {
+		if (start == m->beginp)
+			bol = !(m->eflags&REG_NOTBOL);
+		else
+			bol = start[-1] == '\n' && (g->cflags&REG_NEWLINE);
+	}
+	s = DFA_GET(&d->start[bol]);
+	if (s == DFA_UNKNOWN) {
+		__lock_acquire(d->lock);
+		if ((s = d->start[bol]) == DFA_UNKNOWN) {
+			s = dfastate(m, fresh, bol);
+			if (s == DFA_FULL)
+				DFA_PUT(&d->giveups, d->giveups + 1);
+			else
+				DFA_PUT(&d->start[bol], s);
+		}
+		__lock_release(d->lock);
+		if (s == DFA_FULL)
+			return(0);
+	}
+
+	for (;;) {
+		row = d->rows[s];
+		if (row[DFA_FRESH])
+			coldp = p;
+		if (p < stop)
+			col = (uch)*p;
+		else
+			col = (m->eflags&REG_NOTEOL) ? DFA_COLOUTNE : DFA_COLOUT;
+		t = DFA_GET(&row[col]);
+		if (t == DFA_UNKNOWN)
+			t = dfatrans(m, s, col);
+		if (t < 0)
+			break;
+		s = t;
+		p++;
+	}
+	if (t == DFA_FULL)
+		return(0);
+
+	assert(coldp != NULL);
+	m->coldp = coldp;
+	*endpp = (t == DFA_MATCH) ? p+1 : NULL;
+	return(1);
+}
+
+/*
+ - dfatrans - compute and publish a transition of the DFA cache
+ == static int dfatrans(struct match *m, int s, int col);
+ * Follows the steps fast() takes for one character, from the state set
+ * of state s.  Returns the next state, DFA_MATCH, DFA_NOMATCH, or
+ * DFA_FULL when the next state is new and there is no room for it.
+ */
+static int
+dfatrans(m, s, col)
+struct match *m;
+int s;
+int col;
+{
+	struct re_guts *g = m->g;
+	struct re_dfa *d = g->dfa;
+	const sopno gf = g->firststate+1;
+	const sopno gl = g->laststate;
+	states st = m->st;
+	states tmp = m->tmp;
+	short *row;
+	char *key;
+	int c, flagch, i, t;
+
+	__lock_acquire(d->lock);
+	row = d->rows[s];
+	if ((t = row[col]) != DFA_UNKNOWN) {	/* computed meanwhile */
+		__lock_release(d->lock);
+		return(t);
+	}
+	key = (char *)(row + DFA_NCOLS);
+	FROMKEY(st, key);
+	c = (col < NC) ? (char)col : OUT;
+
+	/* is there an EOL and/or BOL before c? */
+	flagch = '\0';
+	i = 0;
+	if (key[d->keysize]) {
+		flagch = BOL;
+		i = g->nbol;
+	}
+	if ( (c == '\n' && g->cflags&REG_NEWLINE) || col == DFA_COLOUT ) {
+		flagch = (flagch == BOL) ? BOLEOL : EOL;
+		i += g->neol;
+	}
+	for (; i > 0; i--)
+		st = step(g, gf, gl, st, flagch, st);
+
+	if (ISSET(st, gl))
+		t = DFA_MATCH;
+	else if (c == OUT)
+		t = DFA_NOMATCH;
+	else {
+		ASSIGN(tmp, st);
+		ASSIGN(st, m->fresh);
+		st = step(g, gf, gl, tmp, c, st);
+		t = dfastate(m, st, g->nbol > 0 && c == '\n' &&
+						(g->cflags&REG_NEWLINE));
+	}
+
+	if (t == DFA_FULL)
+		DFA_PUT(&d->giveups, d->giveups + 1);
+	else
+		DFA_PUT(&row[col], t);
+	__lock_release(d->lock);
+	return(t);
+}
+
+/*
+ - dfastate - find or add the DFA state for a state set
+ == static int dfastate(struct match *m, states st, int bol);
+ * bol tells whether a ^ can match before the next character.  Called
+ * with the DFA lock held.  Returns the state, or DFA_FULL.
+ */
+static int
+dfastate(m, st, bol)
+struct match *m;
+states st;
+int bol;
+{
+	struct re_dfa *d = m->g->dfa;
+	short *row;
+	char *key;
+	int i;
+
+	for (i = 0; i < d->nstates; i++) {
+		key = (char *)(d->rows[i] + DFA_NCOLS);
+		if (EQKEY(key, st) && key[d->keysize] == bol)
+			return(i);
+	}
+	if (d->nstates == DFA_MAXSTATES)
+		return(DFA_FULL);
+	row = (short *)malloc(DFA_NCOLS*sizeof(short) + d->keysize + 1);
+	if (row == NULL)
+		return(DFA_FULL);
+	for (i = 0; i < DFA_FRESH; i++)
+		row[i] = DFA_UNKNOWN;
+	row[DFA_FRESH] = EQ(st, m->fresh);
+	key = (char *)(row + DFA_NCOLS);
+	TOKEY(key, st);
+	key[d->keysize] = bol;
+	d->rows[d->nstates] = row;
+	return(d->nstates++);
+}
+#endif /* RE_DFA */
+
 /*
  - slow - step through the string more deliberately
  == static char *slow(struct match *m, char *start, \
@@ -1133,6 +1313,9 @@ int ch;
 #undef	matcher
 #undef	fast
 #undef	slow
+#undef	dfast
+#undef	dfatrans
+#undef	dfastate
 #undef	dissect
 #undef	backref
 #undef	step
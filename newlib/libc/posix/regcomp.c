@@ -122,9 +122,9 @@ static void enlarge(struct parse *p, sopno size);
 static void stripsnug(struct parse *p, struct re_guts *g);
 static void findmust(struct parse *p, struct re_guts *g);
 static int altoffset(sop *scan, int offset, int mccs);
-static void computejumps(struct parse *p, struct re_guts *g);
-static void computematchjumps(struct parse *p, struct re_guts *g);
+static void findprefix(struct parse *p, struct re_guts *g);
 static sopno pluscount(struct parse *p, struct re_guts *g);
+static void dfasetup(struct parse *p, struct re_guts *g);
 
 #ifdef __cplusplus
 }
@@ -169,9 +169,6 @@ static int never = 0;		/* for use in asserts; shuts lint up */
 #define	never	0		/* some <assert.h>s have bugs too */
 #endif
 
-/* Macro used by computejump()/computematchjump() */
-#define MIN(a,b)	((a)<(b)?(a):(b))
-
 /*
  - regcomp - interface for parser and compilation
  = extern int regcomp(regex_t *__restrict, const char *__restrict, int);
@@ -245,14 +242,15 @@ int cflags;
 	g->neol = 0;
 	g->must = NULL;
 	g->moffset = -1;
-	g->charjump = NULL;
-	g->matchjump = NULL;
 	g->mlen = 0;
+	g->prefix = NULL;
+	g->plen = 0;
 	g->nsub = 0;
 	g->ncategories = 1;	/* category 0 is "everything else" */
 	g->categories = &g->catspace[-(CHAR_MIN)];
 	(void) memset((char *)g->catspace, 0, NC*sizeof(cat_t));
 	g->backrefs = 0;
+	g->dfa = NULL;
 
 	/* do it */
 	EMIT(OEND, 0);
@@ -270,18 +268,9 @@ int cflags;
 	categorize(p, g);
 	stripsnug(p, g);
 	findmust(p, g);
-	/* only use Boyer-Moore algorithm if the pattern is bigger
-	 * than three characters
-	 */
-	if(g->mlen > 3) {
-		computejumps(p, g);
-		computematchjumps(p, g);
-		if(g->matchjump == NULL && g->charjump != NULL) {
-			free(g->charjump);
-			g->charjump = NULL;
-		}
-	}
+	findprefix(p, g);
 	g->nplus = pluscount(p, g);
+	dfasetup(p, g);
 	g->magic = MAGIC2;
 	preg->re_nsub = g->nsub;
 	preg->re_g = g;
@@ -1921,132 +1910,58 @@ int mccs;
 }
 
 /*
- - computejumps - compute char jumps for BM scan
- == static void computejumps(struct parse *p, struct re_guts *g);
+ - findprefix - fill in prefix and plen with literal string matches start with
+ == static void findprefix(struct parse *p, struct re_guts *g);
  *
- * This algorithm assumes g->must exists and is has size greater than
- * zero. It's based on the algorithm found on Computer Algorithms by
- * Sara Baase.
- *
- * A char jump is the number of characters one needs to jump based on
- * the value of the character from the text that was mismatched.
+ * Also notes in iflags whether the RE starts with ^ outside REG_NEWLINE
+ * mode, in which case a match can only start at the start of the string.
  */
 static void
-computejumps(p, g)
+findprefix(p, g)
 struct parse *p;
 struct re_guts *g;
 {
-	int ch;
-	int mindex;
-
-	/* Avoid making errors worse */
-	if (p->error != 0)
-		return;
-
-	g->charjump = (int*) malloc((NC + 1) * sizeof(int));
-	if (g->charjump == NULL)	/* Not a fatal error */
-		return;
-	/* Adjust for signed chars, if necessary */
-	g->charjump = &g->charjump[-(CHAR_MIN)];
-
-	/* If the character does not exist in the pattern, the jump
-	 * is equal to the number of characters in the pattern.
-	 */
-	for (ch = CHAR_MIN; ch < (CHAR_MAX + 1); ch++)
-		g->charjump[ch] = g->mlen;
-
-	/* If the character does exist, compute the jump that would
-	 * take us to the last character in the pattern equal to it
-	 * (notice that we match right to left, so that last character
-	 * is the first one that would be matched).
-	 */
-	for (mindex = 0; mindex < g->mlen; mindex++)
-		g->charjump[(unsigned char) g->must[mindex]] = g->mlen - mindex - 1;
-}
+	sop *scan;
+	sop *start;
+	sop s;
+	char *cp;
 
-/*
- - computematchjumps - compute match jumps for BM scan
- == static void computematchjumps(struct parse *p, struct re_guts *g);
- *
- * This algorithm assumes g->must exists and is has size greater than
- * zero. It's based on the algorithm found on Computer Algorithms by
- * Sara Baase.
- *
- * A match jump is the number of characters one needs to advance based
- * on the already-matched suffix.
- * Notice that all values here are minus (g->mlen-1), because of the way
- * the search algorithm works.
- */
-static void
-computematchjumps(p, g)
-struct parse *p;
-struct re_guts *g;
-{
-	int mindex;		/* General "must" iterator */
-	int suffix;		/* Keeps track of matching suffix */
-	int ssuffix;		/* Keeps track of suffixes' suffix */
-	int* pmatches;		/* pmatches[k] points to the next i
-				 * such that i+1...mlen is a substring
-				 * of k+1...k+mlen-i-1
-				 */
-
-	/* Avoid making errors worse */
+	/* avoid making error situations worse */
 	if (p->error != 0)
 		return;
 
-	pmatches = (int*) malloc(g->mlen * sizeof(unsigned int));
-	if (pmatches == NULL) {
-		g->matchjump = NULL;
-		return;
+	scan = g->strip + 1;
+	while (OP(*scan) == OLPAREN || OP(*scan) == ORPAREN)
+		scan++;
+	if (OP(*scan) == OBOL) {
+		if (!(g->cflags&REG_NEWLINE))
+			g->iflags |= BOLANCHOR;
+		scan++;
 	}
 
-	g->matchjump = (int*) malloc(g->mlen * sizeof(unsigned int));
-	if (g->matchjump == NULL)	/* Not a fatal error */
+	/* find the OCHAR sequence at the start of strip */
+	start = scan;
+	for (;;) {
+		s = *scan++;
+		if (OP(s) == OCHAR)
+			g->plen++;
+		else if (OP(s) != OLPAREN && OP(s) != ORPAREN)
+			break;
+	}
+	if (g->plen == 0)
 		return;
 
-	/* Set maximum possible jump for each character in the pattern */
-	for (mindex = 0; mindex < g->mlen; mindex++)
-		g->matchjump[mindex] = 2*g->mlen - mindex - 1;
-
-	/* Compute pmatches[] */
-	for (mindex = g->mlen - 1, suffix = g->mlen; mindex >= 0;
-	    mindex--, suffix--) {
-		pmatches[mindex] = suffix;
-
-		/* If a mismatch is found, interrupting the substring,
-		 * compute the matchjump for that position. If no
-		 * mismatch is found, then a text substring mismatched
-		 * against the suffix will also mismatch against the
-		 * substring.
-		 */
-		while (suffix < g->mlen
-		    && g->must[mindex] != g->must[suffix]) {
-			g->matchjump[suffix] = MIN(g->matchjump[suffix],
-			    g->mlen - mindex - 1);
-			suffix = pmatches[suffix];
-		}
+	/* turn it into a character string */
+	g->prefix = malloc((size_t)g->plen + 1);
+	if (g->prefix == NULL) {	/* argh; just forget it */
+		g->plen = 0;
+		return;
 	}
-
-	/* Compute the matchjump up to the last substring found to jump
-	 * to the beginning of the largest must pattern prefix matching
-	 * it's own suffix.
-	 */
-	for (mindex = 0; mindex <= suffix; mindex++)
-		g->matchjump[mindex] = MIN(g->matchjump[mindex],
-		    g->mlen + suffix - mindex);
-
-        ssuffix = pmatches[suffix];
-        while (suffix < g->mlen) {
-                while (suffix <= ssuffix && suffix < g->mlen) {
-                        g->matchjump[suffix] = MIN(g->matchjump[suffix],
-			    g->mlen + ssuffix - suffix);
-                        suffix++;
-                }
-		if (suffix < g->mlen)
-                	ssuffix = pmatches[ssuffix];
-        }
-
-	free(pmatches);
+	cp = g->prefix;
+	for (scan = start; cp < g->prefix + g->plen; scan++)
+		if (OP(*scan) == OCHAR)
+			*cp++ = (char)OPND(*scan);
+	*cp = '\0';		/* just on general principles */
 }
 
 /*
@@ -2085,4 +2000,40 @@ struct re_guts *g;
 	return(maxnest);
 }
 
+/*
+ - dfasetup - set up the DFA cache for regexec(), if the RE can use one
+ == static void dfasetup(struct parse *p, struct re_guts *g);
+ */
+static void
+dfasetup(p, g)
+struct parse *p;
+struct re_guts *g;
+{
+#ifdef RE_DFA
+	struct re_dfa *d;
+	sopno i;
+
+	if (p->error != 0 || g->backrefs || (g->iflags&BAD))
+		return;
+	/* word boundaries depend on the locale at matching time */
+	for (i = 0; i < g->nstates; i++)
+		if (OP(g->strip[i]) == OBOW || OP(g->strip[i]) == OEOW)
+			return;
+
+	d = (struct re_dfa *)malloc(sizeof(struct re_dfa));
+	if (d == NULL)
+		return;		/* regexec() just does without */
+	/* size of the state sets of the matcher regexec() will choose */
+	if (g->nstates <= CHAR_BIT*sizeof(long))
+		d->keysize = sizeof(long);
+	else
+		d->keysize = g->nstates;
+	d->nstates = 0;
+	d->giveups = 0;
+	d->start[0] = d->start[1] = DFA_UNKNOWN;
+	__lock_init(d->lock);
+	g->dfa = d;
+#endif
+}
+
 #endif /* !_NO_REGEX  */
@@ -152,22 +152,81 @@ struct re_guts {
 #		define	USEBOL	01	/* used ^ */
 #		define	USEEOL	02	/* used $ */
 #		define	BAD	04	/* something wrong */
+#		define	BOLANCHOR 010	/* matches can only start at string start */
 	int nbol;		/* number of ^ used */
 	int neol;		/* number of $ used */
 	int ncategories;	/* how many character categories */
 	cat_t *categories;	/* ->catspace[-CHAR_MIN] */
 	char *must;		/* match must contain this string */
 	int moffset;		/* latest point at which must may be located */
-	int *charjump;		/* Boyer-Moore char jump table */
-	int *matchjump;		/* Boyer-Moore match jump table */
 	int mlen;		/* length of must */
+	char *prefix;		/* every match starts with this string */
+	int plen;		/* length of prefix */
 	size_t nsub;		/* copy of re_nsub */
 	int backrefs;		/* does it use back references? */
 	sopno nplus;		/* how deep does it nest +s? */
+	struct re_dfa *dfa;	/* DFA cache for fast(), or NULL */
 	/* catspace must be last */
 	cat_t catspace[1];	/* actually [NC] */
 };
 
+/*
+ * DFA cache.  For REs without back references or word boundaries,
+ * regexec() does the work of fast() with a DFA whose states are the
+ * state sets fast() goes through, each with a flag telling whether the
+ * previous character allows a ^ to match.  States and transitions are
+ * only computed when first needed, and at most DFA_MAXSTATES states are
+ * kept; when more would be needed, fast() is used instead.
+ *
+ * A state is a row of DFA_NCOLS transitions, one for each character
+ * value (as unsigned char) and two for the end of the string, without
+ * and with REG_NOTEOL; followed by a flag telling whether the state is
+ * that of a fresh start and by the state set it stands for.  Rows are
+ * never changed once their transitions are computed and published, so
+ * matchers read them without locking; the lock only serializes the
+ * computation of new transitions and states.
+ */
+#if !defined(PREFER_SIZE_OVER_SPEED) && !defined(__OPTIMIZE_SIZE__)
+#define	RE_DFA
+#endif
+#ifdef RE_DFA
+#include <sys/lock.h>
+
+#define	DFA_MAXSTATES	64
+#define	DFA_COLOUT	NC		/* end of string */
+#define	DFA_COLOUTNE	(NC+1)		/* end of string with REG_NOTEOL */
+#define	DFA_FRESH	(NC+2)		/* fresh start flag */
+#define	DFA_NCOLS	(NC+3)
+#define	DFA_UNKNOWN	(-1)		/* transition not computed yet */
+#define	DFA_MATCH	(-2)		/* the RE matched before this column */
+#define	DFA_NOMATCH	(-3)		/* the string ended without a match */
+#define	DFA_FULL	(-4)		/* no room for the next state */
+#define	DFA_MAXGIVEUPS	16		/* give up on the DFA after that many */
+
+struct re_dfa {
+	size_t keysize;		/* bytes in a state set */
+	int nstates;		/* states in use */
+	int giveups;		/* times a state was needed but no room */
+	short start[2];		/* start state, without and with ^ allowed */
+	short *rows[DFA_MAXSTATES];	/* -> short[DFA_NCOLS], then set */
+	_LOCK_T lock;		/* for adding transitions and states */
+};
+
+/*
+ * Transitions and start states are published with a release store
+ * after the row they lead to is filled in.  Matchers load them without
+ * ordering: the row is only reached through the loaded value, and
+ * dependent loads are not reordered.
+ */
+#ifndef __SINGLE_THREAD__
+#define	DFA_GET(p)	__atomic_load_n((p), __ATOMIC_RELAXED)
+#define	DFA_PUT(p, v)	__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+#define	DFA_GET(p)	(*(p))
+#define	DFA_PUT(p, v)	(*(p) = (v))
+#endif
+#endif /* RE_DFA */
+
 /* misc utilities */
 #define	OUT	(CHAR_MAX+1)	/* a non-character value */
 #define ISWORD(c)       (isalnum((uch)(c)) || (c) == '_')
@@ -84,6 +84,11 @@ static int nope = 0;		/* for use in asserts; shuts lint up */
 #define	FWD(dst, src, n)	((dst) |= ((unsigned long)(src)&(here)) << (n))
 #define	BACK(dst, src, n)	((dst) |= ((unsigned long)(src)&(here)) >> (n))
 #define	ISSETBACK(v, n)	(((v) & ((unsigned long)here >> (n))) != 0)
+/* state sets as keys of the DFA cache */
+#define	KEYSIZE(g)	sizeof(long)
+#define	TOKEY(k, v)	memcpy(k, &(v), sizeof(long))
+#define	FROMKEY(v, k)	memcpy(&(v), k, sizeof(long))
+#define	EQKEY(k, v)	(memcmp(k, &(v), sizeof(long)) == 0)
 /* function names */
 #define SNAMES			/* engine.c looks after details */
 
@@ -108,6 +113,10 @@ static int nope = 0;		/* for use in asserts; shuts lint up */
 #undef	FWD
 #undef	BACK
 #undef	ISSETBACK
+#undef	KEYSIZE
+#undef	TOKEY
+#undef	FROMKEY
+#undef	EQKEY
 #undef	SNAMES
 
 /* macros for manipulating states, large version */
@@ -133,6 +142,11 @@ static int nope = 0;		/* for use in asserts; shuts lint up */
 #define	FWD(dst, src, n)	((dst)[here+(n)] |= (src)[here])
 #define	BACK(dst, src, n)	((dst)[here-(n)] |= (src)[here])
 #define	ISSETBACK(v, n)	((v)[here - (n)])
+/* state sets as keys of the DFA cache */
+#define	KEYSIZE(g)	((size_t)(g)->nstates)
+#define	TOKEY(k, v)	memcpy(k, v, m->g->nstates)
+#define	FROMKEY(v, k)	memcpy(v, k, m->g->nstates)
+#define	EQKEY(k, v)	(memcmp(k, v, m->g->nstates) == 0)
 /* function names */
 #define	LNAMES			/* flag */
 
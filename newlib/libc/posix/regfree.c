@@ -58,6 +58,9 @@ regfree(preg)
 regex_t *preg;
 {
 	struct re_guts *g;
+#ifdef RE_DFA
+	int i;
+#endif
 
 	if (preg->re_magic != MAGIC1)	/* oops */
 		return;			/* nice to complain, but hard */
@@ -76,10 +79,16 @@ regex_t *preg;
 		free((char *)g->setbits);
 	if (g->must != NULL)
 		free(g->must);
-	if (g->charjump != NULL)
-		free(&g->charjump[CHAR_MIN]);
-	if (g->matchjump != NULL)
-		free(g->matchjump);
+	if (g->prefix != NULL)
+		free(g->prefix);
+#ifdef RE_DFA
+	if (g->dfa != NULL) {
+		for (i = 0; i < g->dfa->nstates; i++)
+			free(g->dfa->rows[i]);
+		__lock_close(g->dfa->lock);
+		free(g->dfa);
+	}
+#endif
 	free((char *)g);
 }
 
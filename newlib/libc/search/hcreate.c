@@ -78,3 +78,9 @@ hsearch (ENTRY item,
 
   return retval;
 }
+
+int
+hdelete (const char *key)
+{
+  return hdelete_r (key, &htab);
+}
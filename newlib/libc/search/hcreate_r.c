@@ -39,6 +39,15 @@
  *
  * I tried to look at Knuth (as cited by the Solaris manual page), but
  * nobody had a copy in the office, so...
+ *
+ * The table uses open addressing with linear probing.  Each slot holds
+ * the hash of its key and a pointer to a separately allocated ENTRY, so
+ * that the pointers returned by hsearch_r() stay valid while the table
+ * is resized.  When the table gets three quarters full it is replaced
+ * by one twice as big (or by one of the same size if most of the used
+ * slots are deleted entries), and the entries are moved over a few
+ * slots at a time by the following insertions and deletions.  Until all
+ * are moved, lookups search both tables.
  */
 
 #include <sys/cdefs.h>
@@ -49,9 +58,9 @@ __RCSID("$NetBSD: hcreate.c,v 1.2 2001/02/19 21:26:04 ross Exp $");
 #endif
 
 #include <sys/types.h>
-#include <sys/queue.h>
 #include <errno.h>
 #include <search.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -59,18 +68,35 @@ __RCSID("$NetBSD: hcreate.c,v 1.2 2001/02/19 21:26:04 ross Exp $");
  * DO NOT MAKE THIS STRUCTURE LARGER THAN 32 BYTES (4 ptrs on 64-bit
  * ptr machine) without adjusting MAX_BUCKETS_LG2 below.
  */
-struct internal_entry {
-	SLIST_ENTRY(internal_entry) link;
-	ENTRY ent;
+struct internal_slot {
+	size_t hash;		/* hash of the key */
+	ENTRY *ent;		/* NULL if free, DELETED if deleted */
+};
+
+/*
+ * The state of a table, pointed to by the htable member of struct
+ * hsearch_data, whose layout is part of the ABI.
+ */
+struct internal_head {
+	struct internal_slot *table;	/* current table */
+	size_t size;			/* its number of slots, a power of 2 */
+	size_t used;			/* its used slots, deleted ones included */
+	size_t count;			/* entries in both tables */
+	struct internal_slot *oldtable;	/* table being rehashed, or NULL */
+	size_t oldsize;			/* its number of slots */
+	size_t rehash;			/* next slot of oldtable to move */
 };
-SLIST_HEAD(internal_head, internal_entry);
+
+/* Marks the slot of a deleted entry, so that probing goes on past it. */
+static ENTRY deleted_entry;
+#define	DELETED	(&deleted_entry)
 
 #define	MIN_BUCKETS_LG2	4
 #define	MIN_BUCKETS	(1 << MIN_BUCKETS_LG2)
 
 /*
- * max * sizeof internal_entry must fit into size_t.
- * assumes internal_entry is <= 32 (2^5) bytes.
+ * max * sizeof internal_slot must fit into size_t.
+ * assumes internal_slot is <= 32 (2^5) bytes.
  */
 #ifdef __MSP430X_LARGE__
 /* 20-bit size_t.  */
@@ -80,14 +106,160 @@ SLIST_HEAD(internal_head, internal_entry);
 #endif
 #define	MAX_BUCKETS	((size_t)1 << MAX_BUCKETS_LG2)
 
-/* Default hash function, from db/hash/hash_func.c */
-extern __uint32_t (*__default_hash)(const void *, size_t);
+/* Grow when this many slots of a table of SIZE slots are used. */
+#define	MAX_USED(size)	((size) - (size) / 4)
+
+/* Number of slots of the old table moved by each insertion or deletion. */
+#define	REHASH_STEP	8
+
+/*
+ * Hash the LEN bytes of KEY, eight at a time.  Each word is mixed in by
+ * a multiplication whose high bits are folded back into the low ones,
+ * and the result goes through the MurmurHash3 finalizer, so that the low
+ * bits used to index the table depend on all of the key.
+ */
+static size_t
+hash_key(const char *key, size_t len)
+{
+	const uint64_t m = 0x9e3779b97f4a7c15ULL;
+	uint64_t h = len * m, w;
+
+	for (; len >= 8; key += 8, len -= 8) {
+		memcpy(&w, key, 8);
+		h = (h ^ w) * m;
+		h ^= h >> 32;
+	}
+	if (len > 0) {
+		w = 0;
+		memcpy(&w, key, len);
+		h = (h ^ w) * m;
+		h ^= h >> 32;
+	}
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return (size_t)h;
+}
+
+static struct internal_slot *
+alloc_table(size_t size)
+{
+	/* A zeroed slot is free. */
+	return calloc(size, sizeof (struct internal_slot));
+}
+
+/*
+ * Return the slot of TABLE holding KEY, whose hash is HASH, or NULL.
+ * If FREEP is not NULL, also return in it the first slot where KEY
+ * could be inserted.
+ */
+static struct internal_slot *
+lookup(struct internal_slot *table, size_t size, const char *key, size_t hash,
+    struct internal_slot **freep)
+{
+	struct internal_slot *slot, *avail = NULL;
+	size_t idx;
+
+	for (idx = hash & (size - 1);; idx = (idx + 1) & (size - 1)) {
+		slot = &table[idx];
+		if (slot->ent == NULL)
+			break;
+		if (slot->ent == DELETED) {
+			if (avail == NULL)
+				avail = slot;
+		} else if (slot->hash == hash && strcmp(slot->ent->key, key) == 0)
+			return slot;
+	}
+	if (freep != NULL)
+		*freep = avail != NULL ? avail : slot;
+	return NULL;
+}
+
+/* Put an entry known not to be in the table into a free slot. */
+static void
+insert(struct internal_head *h, size_t hash, ENTRY *ent)
+{
+	struct internal_slot *slot;
+	size_t idx, mask = h->size - 1;
+
+	for (idx = hash & mask;; idx = (idx + 1) & mask) {
+		slot = &h->table[idx];
+		if (slot->ent == NULL) {
+			h->used++;
+			break;
+		}
+		if (slot->ent == DELETED)
+			break;
+	}
+	slot->hash = hash;
+	slot->ent = ent;
+}
+
+/* Move up to N slots of the old table into the current one. */
+static void
+rehash(struct internal_head *h, size_t n)
+{
+	struct internal_slot *slot;
+
+	while (n-- > 0 && h->rehash < h->oldsize) {
+		slot = &h->oldtable[h->rehash++];
+		if (slot->ent != NULL && slot->ent != DELETED) {
+			insert(h, slot->hash, slot->ent);
+			/* Keep the probe sequences of the old table intact. */
+			slot->ent = DELETED;
+		}
+	}
+	if (h->rehash == h->oldsize) {
+		free(h->oldtable);
+		h->oldtable = NULL;
+		h->oldsize = 0;
+	}
+}
+
+/*
+ * Make room for one more entry in a table that is getting full: start
+ * moving the entries to a new table.  Return 0 if there is no room left.
+ */
+static int
+make_room(struct internal_head *h)
+{
+	struct internal_slot *table;
+	size_t size = h->size;
+
+	/* The previous resize has to be finished first. */
+	if (h->oldtable != NULL)
+		rehash(h, h->oldsize);
+	if (h->used + 1 <= MAX_USED(size))
+		return 1;
+
+	/* Grow if live entries fill half the table, else drop the deleted. */
+	if (h->count + 1 > size / 2) {
+		if (size >= MAX_BUCKETS) {
+			/* Cannot grow any more; fill up the table. */
+			return h->used + 1 < size;
+		}
+		size *= 2;
+	}
+
+	table = alloc_table(size);
+	if (table == NULL)
+		return h->used + 1 < h->size;
+	h->oldtable = h->table;
+	h->oldsize = h->size;
+	h->rehash = 0;
+	h->table = table;
+	h->size = size;
+	h->used = 0;
+	return 1;
+}
 
 int
 hcreate_r(size_t nel, struct hsearch_data *htab)
 {
-	size_t idx;
-	unsigned int p2;
+	struct internal_head *h;
+	size_t size;
 
 	/* Make sure this this isn't called when a table already exists. */
 	if (htab->htable != NULL) {
@@ -95,100 +267,153 @@ hcreate_r(size_t nel, struct hsearch_data *htab)
 		return 0;
 	}
 
-	/* If nel is too small, make it min sized. */
-	if (nel < MIN_BUCKETS)
-		nel = MIN_BUCKETS;
-
-	/* If it's too large, cap it. */
+	/* Leave room for NEL entries before the table needs to grow. */
 	if (nel > MAX_BUCKETS)
 		nel = MAX_BUCKETS;
+	nel += nel / 3;
+
+	/* Round up to a power of two, within bounds. */
+	for (size = MIN_BUCKETS; size < nel && size < MAX_BUCKETS; size <<= 1)
+		;
 
-	/* If it's is not a power of two in size, round up. */
-	if ((nel & (nel - 1)) != 0) {
-		for (p2 = 0; nel != 0; p2++)
-			nel >>= 1;
-		nel = 1 << p2;
-	}
-	
 	/* Allocate the table. */
-	htab->htablesize = nel;
-	htab->htable = malloc(htab->htablesize * sizeof htab->htable[0]);
-	if (htab->htable == NULL) {
+	h = malloc(sizeof *h);
+	if (h == NULL || (h->table = alloc_table(size)) == NULL) {
+		free(h);
 		errno = ENOMEM;
 		return 0;
 	}
+	h->size = size;
+	h->used = 0;
+	h->count = 0;
+	h->oldtable = NULL;
+	h->oldsize = 0;
+	h->rehash = 0;
 
-	/* Initialize it. */
-	for (idx = 0; idx < htab->htablesize; idx++)
-		SLIST_INIT(&(htab->htable[idx]));
-
+	htab->htable = h;
+	htab->htablesize = size;
 	return 1;
 }
 
+static void
+free_entries(struct internal_slot *table, size_t size)
+{
+	size_t idx;
+
+	for (idx = 0; idx < size; idx++)
+		if (table[idx].ent != NULL && table[idx].ent != DELETED)
+			free(table[idx].ent);
+}
+
 void
 hdestroy_r(struct hsearch_data *htab)
 {
-#if 0
-	struct internal_entry *ie;
-	size_t idx;
-#endif
-	if (htab->htable == NULL)
+	struct internal_head *h = htab->htable;
+
+	if (h == NULL)
 		return;
 
-#if 0
-	for (idx = 0; idx < htab->htablesize; idx++) {
-		while (!SLIST_EMPTY(&(htab->htable[idx]))) {
-			ie = SLIST_FIRST(&(htab->htable[idx]));
-			SLIST_REMOVE_HEAD(&(htab->htable[idx]), link);
-                        free(ie->ent.key);
-			free(ie);
-		}
+	/* The keys and data belong to the caller; only free the entries. */
+	free_entries(h->table, h->size);
+	free(h->table);
+	if (h->oldtable != NULL) {
+		free_entries(h->oldtable, h->oldsize);
+		free(h->oldtable);
 	}
-#endif
-	free(htab->htable);
+	free(h);
 	htab->htable = NULL;
 }
 
+/* Find the slot holding KEY in either table. */
+static struct internal_slot *
+find(struct internal_head *h, const char *key, size_t hash,
+    struct internal_slot **freep)
+{
+	struct internal_slot *slot;
+
+	slot = lookup(h->table, h->size, key, hash, freep);
+	if (slot == NULL && h->oldtable != NULL)
+		slot = lookup(h->oldtable, h->oldsize, key, hash,
+		    NULL);
+	return slot;
+}
+
 int
 hsearch_r(ENTRY item, ACTION action, ENTRY **retval, struct hsearch_data *htab)
 {
-	struct internal_head *head;
-	struct internal_entry *ie;
-	__uint32_t hashval;
-	size_t len;
-
-	len = strlen(item.key);
-	hashval = (*__default_hash)(item.key, len);
-
-        head = &(htab->htable[hashval & (htab->htablesize - 1)]);
-	ie = SLIST_FIRST(head);
-	while (ie != NULL) {
-		if (strcmp(ie->ent.key, item.key) == 0)
-			break;
-		ie = SLIST_NEXT(ie, link);
-	}
+	struct internal_head *h = htab->htable;
+	struct internal_slot *slot, *avail;
+	ENTRY *ent;
+	size_t hash;
 
-	if (ie != NULL)
+	hash = hash_key(item.key, strlen(item.key));
+
+	slot = find(h, item.key, hash, &avail);
+	if (slot != NULL)
           {
-            *retval = &ie->ent;
+            *retval = slot->ent;
             return 1;
           }
 	else if (action == FIND)
           {
+            errno = ESRCH;
             *retval = NULL;
             return 0;
           }
 
-	ie = malloc(sizeof *ie);
-	if (ie == NULL)
+	ent = malloc(sizeof *ent);
+	if (ent == NULL)
           {
+            errno = ENOMEM;
             *retval = NULL;
             return 0;
           }
-	ie->ent.key = item.key;
-	ie->ent.data = item.data;
+	ent->key = item.key;
+	ent->data = item.data;
+
+	if (avail->ent == NULL && h->used + 1 > MAX_USED(h->size))
+	  {
+	    /* This may change the tables, so look for a slot again. */
+	    if (!make_room(h))
+	      {
+	        free(ent);
+	        errno = ENOMEM;
+	        *retval = NULL;
+	        return 0;
+	      }
+	    insert(h, hash, ent);
+	    htab->htablesize = h->size;
+	  }
+	else
+	  {
+	    if (avail->ent == NULL)
+	      h->used++;
+	    avail->hash = hash;
+	    avail->ent = ent;
+	  }
+	h->count++;
+	if (h->oldtable != NULL)
+	  rehash(h, REHASH_STEP);
+        *retval = ent;
+	return 1;
+}
+
+int
+hdelete_r(const char *key, struct hsearch_data *htab)
+{
+	struct internal_head *h = htab->htable;
+	struct internal_slot *slot;
 
-	SLIST_INSERT_HEAD(head, ie, link);
-        *retval = &ie->ent;
+	slot = find(h, key, hash_key(key, strlen(key)), NULL);
+	if (slot == NULL)
+          {
+            errno = ESRCH;
+            return 0;
+          }
+	free(slot->ent);
+	slot->ent = DELETED;
+	h->count--;
+	if (h->oldtable != NULL)
+	  rehash(h, REHASH_STEP);
 	return 1;
 }
@@ -64,6 +64,7 @@ PORTABILITY
 
 #include <_ansi.h>
 #include <sys/cdefs.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #ifndef __GNUC__
@@ -78,12 +79,15 @@ typedef int		 cmp_t(const void *, const void *, void *);
 typedef int		 cmp_t(const void *, const void *);
 #endif
 static inline char	*med3 (char *, char *, char *, cmp_t *, void *);
-static inline void	 swapfunc (char *, char *, int, int);
+static inline void	 swapfunc (char *, char *, size_t, int);
+static inline void	 swapelem (char *, char *, size_t, int);
 
 #define min(a, b)	(a) < (b) ? a : b
 
 /*
- * Qsort routine from Bentley & McIlroy's "Engineering a Sort Function".
+ * Qsort routine from Bentley & McIlroy's "Engineering a Sort Function",
+ * turned into an introsort: a heapsort takes over from partitions that
+ * go too deep, which bounds the running time to O(n log n).
  */
 #define swapcode(TYPE, parmi, parmj, n) { 		\
 	long i = (n) / sizeof (TYPE); 			\
@@ -96,28 +100,72 @@ static inline void	 swapfunc (char *, char *, int, int);
         } while (--i > 0);				\
 }
 
-#define SWAPINIT(a, es) swaptype = ((char *)a - (char *)0) % sizeof(long) || \
-	es % sizeof(long) ? 2 : es == sizeof(long)? 0 : 1;
+/*
+ * Elements of 4, 8 and 16 bytes are swapped with fixed size code, other
+ * sizes in a loop over the widest word the size and alignment allow.
+ */
+#define SWAP_4		0	/* 4 bytes, aligned for uint32_t */
+#define SWAP_8		1	/* 8 bytes, aligned for long */
+#define SWAP_16		2	/* 16 bytes, aligned for long */
+#define SWAP_LONG	3	/* multiple of long, aligned for long */
+#define SWAP_INT32	4	/* multiple of 4, aligned for uint32_t */
+#define SWAP_BYTES	5
+
+#define ALIGNED(a, es, TYPE) \
+	(((uintptr_t)(a) | (es)) % sizeof(TYPE) == 0)
+
+#define SWAPINIT(a, es) swaptype =				\
+	ALIGNED(a, es, long) ?					\
+	  ((es) == 8 ? SWAP_8 : (es) == 16 ? SWAP_16 :		\
+	   (es) == 4 ? SWAP_4 : SWAP_LONG) :			\
+	ALIGNED(a, es, uint32_t) ?				\
+	  ((es) == 4 ? SWAP_4 : SWAP_INT32) : SWAP_BYTES;
 
 static inline void
 swapfunc (char *a,
 	char *b,
-	int n,
+	size_t n,
 	int swaptype)
 {
-	if(swaptype <= 1)
+	switch (swaptype) {
+	case SWAP_8:
+	case SWAP_16:
+	case SWAP_LONG:
 		swapcode(long, a, b, n)
-	else
+		break;
+	case SWAP_4:
+	case SWAP_INT32:
+		swapcode(uint32_t, a, b, n)
+		break;
+	default:
 		swapcode(char, a, b, n)
+		break;
+	}
+}
+
+static inline void
+swapelem (char *a,
+	char *b,
+	size_t es,
+	int swaptype)
+{
+	switch (swaptype) {
+	case SWAP_4:
+		swapcode(uint32_t, a, b, 4)
+		break;
+	case SWAP_8:
+		swapcode(long, a, b, 8)
+		break;
+	case SWAP_16:
+		swapcode(long, a, b, 16)
+		break;
+	default:
+		swapfunc(a, b, es, swaptype);
+		break;
+	}
 }
 
-#define swap(a, b)					\
-	if (swaptype == 0) {				\
-		long t = *(long *)(a);			\
-		*(long *)(a) = *(long *)(b);		\
-		*(long *)(b) = t;			\
-	} else						\
-		swapfunc(a, b, es, swaptype)
+#define swap(a, b)	swapelem(a, b, es, swaptype)
 
 #define vecswap(a, b, n) 	if ((n) > 0) swapfunc(a, b, n, swaptype)
 
@@ -129,22 +177,92 @@ swapfunc (char *a,
 #define	CMP(t, x, y) (cmp((x), (y)))
 #endif
 
+#if !defined(I_AM_QSORT_R) && !defined(I_AM_GNU_QSORT_R)
+#define THUNK_UNUSED __unused
+#else
+#define THUNK_UNUSED
+#endif
+
 static inline char *
 med3 (char *a,
 	char *b,
 	char *c,
 	cmp_t *cmp,
-	void *thunk
-#if !defined(I_AM_QSORT_R) && !defined(I_AM_GNU_QSORT_R)
-__unused
-#endif
-)
+	void *thunk THUNK_UNUSED)
 {
 	return CMP(thunk, a, b) < 0 ?
 	       (CMP(thunk, b, c) < 0 ? b : (CMP(thunk, a, c) < 0 ? c : a ))
               :(CMP(thunk, b, c) > 0 ? b : (CMP(thunk, a, c) < 0 ? a : c ));
 }
 
+/*
+ * Insertion sort the n elements at a.  If limit is not zero, give up
+ * once more than limit elements have been moved; return 0 then, and 1
+ * if the elements were sorted.
+ */
+static int
+insertion_sort (char *a,
+	size_t n,
+	size_t es,
+	cmp_t *cmp,
+	void *thunk THUNK_UNUSED,
+	int swaptype,
+	size_t limit)
+{
+	char *pl, *pm, *pn;
+	size_t moves = 0;
+
+	pn = a + n * es;
+	for (pm = a + es; pm < pn; pm += es) {
+		for (pl = pm; pl > a && CMP(thunk, pl - es, pl) > 0;
+		     pl -= es) {
+			swap(pl, pl - es);
+			moves++;
+		}
+		if (limit != 0 && moves > limit)
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * Heapsort the n elements at a.  Used when partitioning goes too deep,
+ * which only happens for inputs crafted against the pivot selection.
+ */
+static void
+heap_sort (char *a,
+	size_t n,
+	size_t es,
+	cmp_t *cmp,
+	void *thunk THUNK_UNUSED,
+	int swaptype)
+{
+	size_t i, child, root, end;
+
+	for (i = n / 2; i-- > 0; ) {
+		/* Sift element i down into the heap below it. */
+		for (root = i; (child = 2 * root + 1) < n; root = child) {
+			if (child + 1 < n &&
+			    CMP(thunk, a + child * es, a + (child + 1) * es) < 0)
+				child++;
+			if (CMP(thunk, a + root * es, a + child * es) >= 0)
+				break;
+			swap(a + root * es, a + child * es);
+		}
+	}
+	for (end = n - 1; end > 0; end--) {
+		swap(a, a + end * es);
+		for (root = 0; (child = 2 * root + 1) < end; root = child) {
+			if (child + 1 < end &&
+			    CMP(thunk, a + child * es, a + (child + 1) * es) < 0)
+				child++;
+			if (CMP(thunk, a + root * es, a + child * es) >= 0)
+				break;
+			swap(a + root * es, a + child * es);
+		}
+	}
+}
+
 /*
  * Classical function call recursion wastes a lot of stack space. Each
  * recursion level requires a full stack frame comprising all local variables
@@ -161,52 +279,42 @@ __unused
  */
 #define PARAMETER_STACK_LEVELS 8u
 
-#if defined(I_AM_QSORT_R)
-void
-__bsd_qsort_r (void *a,
-	size_t n,
-	size_t es,
-	void *thunk,
-	cmp_t *cmp)
-#elif defined(I_AM_GNU_QSORT_R)
-void
-qsort_r (void *a,
+/* Arrays shorter than this are insertion sorted. */
+#define INSERTION_SORT_THRESHOLD 7
+
+static void
+introsort (char *a,
 	size_t n,
 	size_t es,
 	cmp_t *cmp,
-	void *thunk)
-#else
-#define thunk NULL
-void
-qsort (void *a,
-	size_t n,
-	size_t es,
-	cmp_t *cmp)
-#endif
+	void *thunk,
+	int swaptype,
+	int depth)
 {
 	char *pa, *pb, *pc, *pd, *pl, *pm, *pn;
 	size_t d, r;
 	int cmp_result;
-	int swaptype, swap_cnt;
+	int swap_cnt;
 	size_t recursion_level = 0;
-	struct { void *a; size_t n; } parameter_stack[PARAMETER_STACK_LEVELS];
+	struct { char *a; size_t n; int depth; }
+		parameter_stack[PARAMETER_STACK_LEVELS];
 
-	SWAPINIT(a, es);
 loop:	swap_cnt = 0;
-	if (n < 7) {
-		/* Short arrays are insertion sorted. */
-		for (pm = (char *) a + es; pm < (char *) a + n * es; pm += es)
-			for (pl = pm; pl > (char *) a && CMP(thunk, pl - es, pl) > 0;
-			     pl -= es)
-				swap(pl, pl - es);
+	if (n < INSERTION_SORT_THRESHOLD) {
+		insertion_sort(a, n, es, cmp, thunk, swaptype, 0);
+		goto pop;
+	}
+	if (depth-- == 0) {
+		/* Too many bad pivots: this part would go quadratic. */
+		heap_sort(a, n, es, cmp, thunk, swaptype);
 		goto pop;
 	}
 
 	/* Select a pivot element, move it to the left. */
-	pm = (char *) a + (n / 2) * es;
+	pm = a + (n / 2) * es;
 	if (n > 7) {
 		pl = a;
-		pn = (char *) a + (n - 1) * es;
+		pn = a + (n - 1) * es;
 		if (n > 40) {
 			d = (n / 8) * es;
 			pl = med3(pl, pl + d, pl + 2 * d, cmp, thunk);
@@ -221,8 +329,8 @@ loop:	swap_cnt = 0;
 	 * Sort the array relative the pivot in four ranges as follows:
 	 * { elems == pivot, elems < pivot, elems > pivot, elems == pivot }
 	 */
-	pa = pb = (char *) a + es;
-	pc = pd = (char *) a + (n - 1) * es;
+	pa = pb = a + es;
+	pc = pd = a + (n - 1) * es;
 	for (;;) {
 		/* Scan left to right stopping at first element > pivot. */
 		while (pb <= pc && (cmp_result = CMP(thunk, pb, a)) <= 0) {
@@ -252,20 +360,13 @@ loop:	swap_cnt = 0;
 		pb += es;
 		pc -= es;
 	}
-	if (swap_cnt == 0) {  /* Switch to insertion sort */
-		for (pm = (char *) a + es; pm < (char *) a + n * es; pm += es)
-			for (pl = pm; pl > (char *) a && CMP(thunk, pl - es, pl) > 0;
-			     pl -= es)
-				swap(pl, pl - es);
-		goto pop;
-	}
 
 	/*
 	 * Rearrange the array in three parts sorted like this:
 	 * { elements < pivot, elements == pivot, elements > pivot }
 	 */
-	pn = (char *) a + n * es;
-	r = min(pa - (char *)a, pb - pa);
+	pn = a + n * es;
+	r = min(pa - a, pb - pa);
 	vecswap(a, pb - r, r);
 	r = min(pd - pc, pn - pd - es);
 	vecswap(pb, pn - r, r);
@@ -273,6 +374,22 @@ loop:	swap_cnt = 0;
 	r = pd - pc; /* r = Size of right part. */
 	pn -= r;     /* pn = Base of right part. */
 
+	if (swap_cnt == 0) {
+		/*
+		 * Nothing was out of place relative to the pivot, so the
+		 * input may be nearly sorted.  Try to finish both parts
+		 * with an insertion sort that gives up after as many moves
+		 * as there are elements, and partition them as usual if
+		 * that fails.  Unlike an unbounded insertion sort this
+		 * cannot go quadratic.
+		 */
+		if (insertion_sort(a, d / es, es, cmp, thunk, swaptype,
+				   d / es + 1) &&
+		    insertion_sort(pn, r / es, es, cmp, thunk, swaptype,
+				   r / es + 1))
+			goto pop;
+	}
+
 	/*
 	 * Check which of the left and right parts are larger.
 	 * Set (a, n)  to (base, size) of the larger part.
@@ -310,6 +427,7 @@ loop:	swap_cnt = 0;
 			 */
 			parameter_stack[recursion_level].a = a;
 			parameter_stack[recursion_level].n = n / es;
+			parameter_stack[recursion_level].depth = depth;
 			recursion_level++;
 			a = pa;
 			n = r / es;
@@ -321,13 +439,7 @@ loop:	swap_cnt = 0;
 			 * is sorted using function call recursion. The larger
 			 * part will be sorted after the function call returns.
 			 */
-#if defined(I_AM_QSORT_R)
-			__bsd_qsort_r(pa, r / es, es, thunk, cmp);
-#elif defined(I_AM_GNU_QSORT_R)
-			qsort_r(pa, r / es, es, cmp, thunk);
-#else
-			qsort(pa, r / es, es, cmp);
-#endif
+			introsort(pa, r / es, es, cmp, thunk, swaptype, depth);
 		}
 	}
 	if (n > es) {  /* The larger part needs sorting. Iterate to sort.  */
@@ -340,6 +452,43 @@ pop:
 		recursion_level--;
 		a = parameter_stack[recursion_level].a;
 		n = parameter_stack[recursion_level].n;
+		depth = parameter_stack[recursion_level].depth;
 		goto loop;
 	}
 }
+
+#if defined(I_AM_QSORT_R)
+void
+__bsd_qsort_r (void *a,
+	size_t n,
+	size_t es,
+	void *thunk,
+	cmp_t *cmp)
+#elif defined(I_AM_GNU_QSORT_R)
+void
+qsort_r (void *a,
+	size_t n,
+	size_t es,
+	cmp_t *cmp,
+	void *thunk)
+#else
+#define thunk NULL
+void
+qsort (void *a,
+	size_t n,
+	size_t es,
+	cmp_t *cmp)
+#endif
+{
+	int swaptype;
+	int depth;
+	size_t m;
+
+	SWAPINIT(a, es);
+
+	/* Allow 2 * log2(n) levels of partitioning before heapsort. */
+	for (depth = 0, m = n; m > 1; m >>= 1)
+		depth += 2;
+
+	introsort(a, n, es, cmp, thunk, swaptype, depth);
+}
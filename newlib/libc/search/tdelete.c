@@ -22,6 +22,7 @@ __RCSID("$NetBSD: tdelete.c,v 1.2 1999/09/16 11:45:37 lukem Exp $");
 #define _SEARCH_PRIVATE
 #include <search.h>
 #include <stdlib.h>
+#include "tsearch.h"
 
 
 /* delete node with given key */
@@ -31,36 +32,66 @@ tdelete (const void *__restrict vkey,	/* key to be deleted */
 	int       (*compar)(const void *, const void *))
 {
 	node_t **rootp = (node_t **)vrootp;
+	node_t **path[TREE_MAX_DEPTH];
+	node_t **shrunk;
 	node_t *p, *q, *r;
-	int  cmp;
+	int  cmp, depth = 0;
 
 	if (rootp == NULL || (p = *rootp) == NULL)
 		return NULL;
 
 	while ((cmp = (*compar)(vkey, (*rootp)->key)) != 0) {
 		p = *rootp;
+		path[depth++] = rootp;
 		rootp = (cmp < 0) ?
 		    &(*rootp)->llink :		/* follow llink branch */
 		    &(*rootp)->rlink;		/* follow rlink branch */
 		if (*rootp == NULL)
 			return NULL;		/* key not found */
 	}
-	r = (*rootp)->rlink;			/* D1: */
-	if ((q = (*rootp)->llink) == NULL)	/* Left NULL? */
-		q = r;
-	else if (r != NULL) {			/* Right link is NULL? */
-		if (r->llink == NULL) {		/* D2: Find successor */
-			r->llink = q;
-			q = r;
-		} else {			/* D3: Find NULL link */
-			for (q = r->llink; q->llink != NULL; q = r->llink)
-				r = q;
-			r->llink = q->rlink;
-			q->llink = (*rootp)->llink;
-			q->rlink = (*rootp)->rlink;
-		}
+	q = *rootp;				/* D1: */
+	if (q->llink == NULL) {			/* Left NULL? */
+		*rootp = q->rlink;
+		shrunk = rootp;
+	} else if (q->rlink == NULL) {		/* Right link is NULL? */
+		*rootp = q->llink;
+		shrunk = rootp;
+	} else {				/* D2: Find successor */
+		int top = depth;
+
+		path[depth++] = rootp;
+		for (shrunk = &q->rlink; (*shrunk)->llink != NULL;
+		    shrunk = &(*shrunk)->llink)
+			path[depth++] = shrunk;
+		r = *shrunk;			/* D3: unlink it */
+		*shrunk = r->rlink;
+		/*
+		 * Move the successor into the place of the deleted node,
+		 * and have the path go through it instead.
+		 */
+		r->llink = q->llink;
+		r->rlink = q->rlink;
+		r->balance = q->balance;
+		*rootp = r;
+		if (depth > top + 1)
+			path[top + 1] = &r->rlink;
+		if (shrunk == &q->rlink)
+			shrunk = &r->rlink;
+	}
+	free(q);				/* D4: Free node */
+
+	/*
+	 * The subtree at shrunk is one level lower.  Walk back up, updating
+	 * the balance of each ancestor, until one keeps its height.
+	 */
+	while (depth-- > 0) {
+		q = *path[depth];
+		q->balance -= (shrunk == &q->rlink) ? 1 : -1;
+		if (q->balance == 1 || q->balance == -1)
+			break;
+		if (q->balance != 0 && !tree_rotate(path[depth]))
+			break;
+		shrunk = path[depth];
 	}
-	free(*rootp);				/* D4: Free node */
-	*rootp = q;				/* link parent to new node */
 	return p;
 }
@@ -2,7 +2,9 @@
 
 /*
  * Tree search generalized from Knuth (6.2.2) Algorithm T just like
- * the AT&T man page says.
+ * the AT&T man page says.  The tree is kept balanced as an AVL tree
+ * (Knuth 6.2.3), so that sorted insertions do not degrade it into a
+ * list.
  *
  * The node_t structure is for internal use only, lint doesn't grok it.
  *
@@ -22,6 +24,7 @@ __RCSID("$NetBSD: tsearch.c,v 1.3 1999/09/16 11:45:37 lukem Exp $");
 #define _SEARCH_PRIVATE
 #include <search.h>
 #include <stdlib.h>
+#include "tsearch.h"
 
 /* find or insert datum into search tree */
 void *
@@ -29,8 +32,10 @@ tsearch (const void *vkey,		/* key to be located */
 	void **vrootp,		/* address of tree root */
 	int (*compar)(const void *, const void *))
 {
-	node_t *q;
+	node_t *q, *p;
 	node_t **rootp = (node_t **)vrootp;
+	node_t **path[TREE_MAX_DEPTH];
+	int depth = 0;
 
 	if (rootp == NULL)
 		return NULL;
@@ -41,17 +46,37 @@ tsearch (const void *vkey,		/* key to be located */
 		if ((r = (*compar)(vkey, (*rootp)->key)) == 0)	/* T2: */
 			return *rootp;		/* we found it! */
 
+		path[depth++] = rootp;
 		rootp = (r < 0) ?
 		    &(*rootp)->llink :		/* T3: follow left branch */
 		    &(*rootp)->rlink;		/* T4: follow right branch */
 	}
 
 	q = malloc(sizeof(node_t));		/* T5: key not found */
-	if (q != 0) {				/* make new node */
-		*rootp = q;			/* link new node to old */
-		/* LINTED const castaway ok */
-		q->key = (void *)vkey;		/* initialize new node */
-		q->llink = q->rlink = NULL;
+	if (q == 0)
+		return q;
+						/* make new node */
+	*rootp = q;				/* link new node to old */
+	/* LINTED const castaway ok */
+	q->key = (void *)vkey;			/* initialize new node */
+	q->llink = q->rlink = NULL;
+	q->balance = 0;
+
+	/*
+	 * The subtree at rootp grew by one level.  Walk back up, updating
+	 * the balance of each ancestor, until one absorbs the growth or
+	 * needs a rotation, which restores the height it had before.
+	 */
+	while (depth-- > 0) {
+		p = *path[depth];
+		p->balance += (rootp == &p->rlink) ? 1 : -1;
+		if (p->balance == 0)
+			break;
+		if (p->balance != 1 && p->balance != -1) {
+			tree_rotate(path[depth]);
+			break;
+		}
+		rootp = path[depth];
 	}
 	return q;
 }
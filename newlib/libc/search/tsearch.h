@@ -0,0 +1,74 @@
+/*
+ * AVL balancing of the node_t trees built by tsearch() and tdelete().
+ *
+ * Each node records the height of its right subtree minus that of its
+ * left subtree in its balance field, which is kept within -1..1.  The
+ * height of a tree of n nodes is then below 1.45 log2(n + 2), so the
+ * search paths of tsearch() and tdelete() fit in TREE_MAX_DEPTH
+ * entries whatever the number of nodes that can fit in memory.
+ *
+ * Written for newlib, public domain like the rest of the tree code.
+ */
+
+#define TREE_MAX_DEPTH	(sizeof(void *) * 8 * 3 / 2)
+
+/*
+ * Rotate the subtree at *linkp, whose root has a balance of -2 or 2,
+ * back into balance.  Return 1 if the subtree is now one level lower
+ * than it was before it got out of balance, 0 if its height is the same.
+ */
+static inline int
+tree_rotate(node_t **linkp)
+{
+	node_t *p = *linkp, *c, *g;
+	int lower = 1;
+
+	if (p->balance > 0) {
+		c = p->rlink;
+		if (c->balance >= 0) {		/* single left rotation */
+			p->rlink = c->llink;
+			c->llink = p;
+			if (c->balance == 0) {
+				p->balance = 1;
+				c->balance = -1;
+				lower = 0;
+			} else
+				p->balance = c->balance = 0;
+			*linkp = c;
+		} else {			/* right-left rotation */
+			g = c->llink;
+			c->llink = g->rlink;
+			p->rlink = g->llink;
+			g->llink = p;
+			g->rlink = c;
+			p->balance = g->balance > 0 ? -1 : 0;
+			c->balance = g->balance < 0 ? 1 : 0;
+			g->balance = 0;
+			*linkp = g;
+		}
+	} else {
+		c = p->llink;
+		if (c->balance <= 0) {		/* single right rotation */
+			p->llink = c->rlink;
+			c->rlink = p;
+			if (c->balance == 0) {
+				p->balance = -1;
+				c->balance = 1;
+				lower = 0;
+			} else
+				p->balance = c->balance = 0;
+			*linkp = c;
+		} else {			/* left-right rotation */
+			g = c->rlink;
+			c->rlink = g->llink;
+			p->llink = g->rlink;
+			g->rlink = p;
+			g->llink = c;
+			p->balance = g->balance < 0 ? 1 : 0;
+			c->balance = g->balance > 0 ? -1 : 0;
+			g->balance = 0;
+			*linkp = g;
+		}
+	}
+	return lower;
+}
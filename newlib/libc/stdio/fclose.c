@@ -97,11 +97,15 @@ _fclose_r (struct _reent *rptr,
     r = EOF;
   if (fp->_flags & __SMBF)
     _free_r (rptr, (char *) fp->_bf._base);
+#ifdef _STDIO_MMAP
+  if (fp->_flags2 & __SMAP)
+    __sunmapbuf_r (rptr, fp);
+#endif
   if (HASUB (fp))
     FREEUB (rptr, fp);
   if (HASLB (fp))
     FREELB (rptr, fp);
-  __sfp_lock_acquire ();
+  __sfp_free_lock (fp);
   fp->_flags = 0;		/* release this FILE for reuse */
   if (!(fp->_flags2 & __SNLK))
     _funlockfile (fp);
@@ -109,7 +113,7 @@ _fclose_r (struct _reent *rptr,
   __lock_close_recursive (fp->_lock);
 #endif
 
-  __sfp_lock_release ();
+  __sfp_free (fp);
 #ifdef _STDIO_WITH_THREAD_CANCELLATION_SUPPORT
   pthread_setcancelstate (__oldcancel, &__oldcancel);
 #endif
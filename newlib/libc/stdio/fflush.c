@@ -107,6 +107,9 @@ __sflush_r (struct _reent *ptr,
   register _READ_WRITE_BUFSIZE_TYPE n;
   register _READ_WRITE_RETURN_TYPE t;
   short flags;
+#ifdef _STDIO_ADAPTIVE_BUF
+  int full;
+#endif
 
   flags = fp->_flags;
   if ((flags & __SWR) == 0)
@@ -218,6 +221,9 @@ __sflush_r (struct _reent *ptr,
    */
   fp->_p = p;
   fp->_w = flags & (__SLBF | __SNBF) ? 0 : fp->_bf._size;
+#ifdef _STDIO_ADAPTIVE_BUF
+  full = n == fp->_bf._size;
+#endif
 
   while (n > 0)
     {
@@ -230,6 +236,17 @@ __sflush_r (struct _reent *ptr,
       p += t;
       n -= t;
     }
+#ifdef _STDIO_ADAPTIVE_BUF
+  /* Grow the buffer of a stream that keeps filling it, shrink it when
+     the writer pauses to flush part of it.  */
+  if (__SADAPT (fp) && p != fp->_p)
+    {
+      if (!full)
+	__sresetbuf_r (ptr, fp);
+      else if (++fp->_bufrun >= _STDIO_BUFRUN)
+	__sgrowbuf_r (ptr, fp);
+    }
+#endif
   return 0;
 }
 
@@ -20,6 +20,7 @@
 #include <reent.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <errno.h>
 #include <string.h>
 #include <fcntl.h>
@@ -72,6 +73,10 @@ std (FILE *ptr,
   ptr->_bf._base = 0;
   ptr->_bf._size = 0;
   ptr->_lbfsize = 0;
+#ifdef _STDIO_ADAPTIVE_BUF
+  ptr->_bufrun = 0;
+  ptr->_bufmin = 0;
+#endif
   memset (&ptr->_mbstate, 0, sizeof (_mbstate_t));
   ptr->_cookie = ptr;
   ptr->_read = __sread;
@@ -92,6 +97,11 @@ std (FILE *ptr,
   if (__stextmode (ptr->_file))
     ptr->_flags |= __SCLE;
 #endif
+#if !defined (__SINGLE_THREAD__) && defined (_STDIO_BIASED_LOCK)
+  ptr->_lock_bias = _REENT;
+  ptr->_lock_busy = 0;
+  ptr->_lock_revoked = 0;
+#endif
 }
 
 static inline void
@@ -129,6 +139,63 @@ struct glue_with_file {
   FILE file;
 };
 
+/*
+ * Free FILEs are kept on SFP_SHARDS stacks, linked through their
+ * _cookie, so that __sfp and __sfp_free take constant time and
+ * threads opening and closing unrelated streams seldom wait for the
+ * same lock.  __sfp starts at a stack chosen from the caller's
+ * reentrancy structure, __sfp_free pushes FILEs on a stack chosen
+ * from their address.  __sfp_lock is only taken to add more FILEs.
+ */
+#if !defined (__SINGLE_THREAD__) && \
+    !defined (__OPTIMIZE_SIZE__) && !defined (PREFER_SIZE_OVER_SPEED)
+#define SFP_SHARD_BITS 3
+#else
+#define SFP_SHARD_BITS 0
+#endif
+#define SFP_SHARDS (1 << SFP_SHARD_BITS)
+
+static struct sfp_shard {
+  FILE *free;
+#ifndef __SINGLE_THREAD__
+  _LOCK_T lock;
+#endif
+} sfp_shards[SFP_SHARDS];
+
+#ifndef __SINGLE_THREAD__
+#define sfp_shard_lock(s) __lock_acquire ((s)->lock)
+#define sfp_shard_unlock(s) __lock_release ((s)->lock)
+#else
+#define sfp_shard_lock(s)
+#define sfp_shard_unlock(s)
+#endif
+
+static struct _glue *sglue_last = &__sglue;
+
+static inline struct sfp_shard *
+sfp_shard (const void *p)
+{
+#if SFP_SHARD_BITS > 0
+  uint32_t h = (uint32_t) ((uintptr_t) p >> 4) * 0x9e3779b1U;
+
+  return &sfp_shards[h >> (32 - SFP_SHARD_BITS)];
+#else
+  return &sfp_shards[0];
+#endif
+}
+
+static FILE *
+sfp_pop (struct sfp_shard *s)
+{
+  FILE *fp;
+
+  sfp_shard_lock (s);
+  if ((fp = s->free) != NULL)
+    s->free = (FILE *) fp->_cookie;
+  sfp_shard_unlock (s);
+  return fp;
+}
+
 static struct _glue *
 sfmoreglue (struct _reent *d, int n)
 {
@@ -155,10 +222,18 @@ static void
 global_stdio_init (void)
 {
   if (__stdio_exit_handler == NULL) {
-    __stdio_exit_handler = stdio_exit_handler;
+#ifndef __SINGLE_THREAD__
+    int i;
+
+    for (i = 0; i < SFP_SHARDS; i++)
+      __lock_init (sfp_shards[i].lock);
+#endif
     stdin_init (&__sf[0]);
     stdout_init (&__sf[1]);
     stderr_init (&__sf[2]);
+    /* Set last, __sfp checks it without holding __sfp_lock.  */
+    __atomic_store_n (&__stdio_exit_handler, stdio_exit_handler,
+		      __ATOMIC_RELEASE);
   }
 }
 
@@ -172,22 +247,50 @@ __sfp (struct _reent *d)
   FILE *fp;
   int n;
   struct _glue *g;
+  struct sfp_shard *s, *start;
 
-  _newlib_sfp_lock_start ();
-  global_stdio_init ();
+  if (__atomic_load_n (&__stdio_exit_handler, __ATOMIC_ACQUIRE) == NULL)
+    {
+      _newlib_sfp_lock_start ();
+      global_stdio_init ();
+      _newlib_sfp_lock_end ();
+    }
 
-  for (g = &__sglue;; g = g->_next)
+  s = start = sfp_shard (d);
+  do
     {
-      for (fp = g->_iobs, n = g->_niobs; --n >= 0; fp++)
-	if (fp->_flags == 0)
-	  goto found;
-      if (g->_next == NULL &&
-	  (g->_next = sfmoreglue (d, NDYNAMIC)) == NULL)
-	break;
+      if ((fp = sfp_pop (s)) != NULL)
+	goto found;
+      if (++s == &sfp_shards[SFP_SHARDS])
+	s = sfp_shards;
     }
-  _newlib_sfp_lock_exit ();
-  _REENT_ERRNO(d) = ENOMEM;
-  return NULL;
+  while (s != start);
+
+  /* No free FILE: add a block of them, keep the first one and make the
+     others available from our stack.  */
+  _newlib_sfp_lock_start ();
+  if ((fp = sfp_pop (s)) == NULL)
+    {
+      if ((g = sfmoreglue (d, NDYNAMIC)) == NULL)
+	{
+	  _newlib_sfp_lock_exit ();
+	  _REENT_ERRNO(d) = ENOMEM;
+	  return NULL;
+	}
+      while (sglue_last->_next != NULL)
+	sglue_last = sglue_last->_next;
+      sglue_last->_next = g;
+      sglue_last = g;
+      sfp_shard_lock (s);
+      for (n = g->_niobs; --n > 0; )
+	{
+	  g->_iobs[n]._cookie = s->free;
+	  s->free = &g->_iobs[n];
+	}
+      sfp_shard_unlock (s);
+      fp = g->_iobs;
+    }
+  _newlib_sfp_lock_end ();
 
 found:
   fp->_file = -1;		/* no file */
@@ -195,8 +298,13 @@ found:
   fp->_flags2 = 0;
 #ifndef __SINGLE_THREAD__
   __lock_init_recursive (fp->_lock);
+#ifdef _STDIO_BIASED_LOCK
+  /* Bias the lock to the thread opening the stream.  */
+  fp->_lock_bias = _REENT;
+  fp->_lock_busy = 0;
+  fp->_lock_revoked = 0;
+#endif
 #endif
-  _newlib_sfp_lock_end ();
 
   fp->_p = NULL;		/* no current pointer */
   fp->_w = 0;			/* nothing to read or write */
@@ -204,6 +312,10 @@ found:
   fp->_bf._base = NULL;		/* no buffer */
   fp->_bf._size = 0;
   fp->_lbfsize = 0;		/* not line buffered */
+#ifdef _STDIO_ADAPTIVE_BUF
+  fp->_bufrun = 0;		/* buffer may grow */
+  fp->_bufmin = 0;
+#endif
   memset (&fp->_mbstate, 0, sizeof (_mbstate_t));
   /* fp->_cookie = <any>; */	/* caller sets cookie, _read/_write etc */
   fp->_ub._base = NULL;		/* no ungetc buffer */
@@ -214,6 +326,32 @@ found:
   return fp;
 }
 
+#ifndef __SINGLE_THREAD__
+/*
+ * Lock the free stack FP will be returned to.  Callers releasing a
+ * FILE hold this lock while they clear its _flags and close its lock,
+ * like they held __sfp_lock before, and drop it with __sfp_free.
+ */
+void
+__sfp_free_lock (FILE *fp)
+{
+  sfp_shard_lock (sfp_shard (fp));
+}
+#endif
+
+/*
+ * Return FP, obtained from __sfp and released as above, for reuse.
+ */
+void
+__sfp_free (FILE *fp)
+{
+  struct sfp_shard *s = sfp_shard (fp);
+
+  fp->_cookie = s->free;
+  s->free = fp;
+  sfp_shard_unlock (s);
+}
+
 /*
  * exit() calls _cleanup() through *__cleanup, set whenever we
  * open or buffer a file.  This chicanery is done so that programs
@@ -271,6 +409,29 @@ __sfp_lock_release (void)
   __lock_release_recursive (__sfp_recursive_mutex);
 }
 
+#ifdef _STDIO_BIASED_LOCK
+
+/* sched_yield is only available on some systems.  */
+extern int sched_yield (void) __attribute__ ((__weak__));
+
+/* Called by a thread other than the one the lock of FP is biased to,
+   before it takes the lock.  Stop the biased thread from locking FP
+   without _lock, and wait until it does not hold FP any more.  Stdio
+   functions only hold FP for the duration of the call, so this does
+   not normally wait long.  */
+void
+__sflock_revoke (FILE *fp)
+{
+  __atomic_store_n (&fp->_lock_revoked, 1, __ATOMIC_SEQ_CST);
+  while (__atomic_load_n (&fp->_lock_busy, __ATOMIC_SEQ_CST) != 0)
+    if (sched_yield)
+      sched_yield ();
+  /* The biased thread now uses _lock too; let others skip this.  */
+  __atomic_store_n (&fp->_lock_bias, NULL, __ATOMIC_RELAXED);
+}
+
+#endif /* _STDIO_BIASED_LOCK */
+
 /* Walkable file locking routine.  */
 static int
 __fp_lock (struct _reent * ptr __unused, FILE * fp)
@@ -294,14 +455,25 @@ __fp_unlock (struct _reent * ptr __unused, FILE * fp)
 void
 __fp_lock_all (void)
 {
+  int i;
+
   __sfp_lock_acquire ();
+  /* The free stacks' locks only exist once stdio is initialized.  */
+  if (__stdio_exit_handler != NULL)
+    for (i = 0; i < SFP_SHARDS; i++)
+      __lock_acquire (sfp_shards[i].lock);
   (void) _fwalk_sglue (NULL, __fp_lock, &__sglue);
 }
 
 void
 __fp_unlock_all (void)
 {
+  int i;
+
   (void) _fwalk_sglue (NULL, __fp_unlock, &__sglue);
+  if (__stdio_exit_handler != NULL)
+    for (i = SFP_SHARDS; --i >= 0; )
+      __lock_release (sfp_shards[i].lock);
   __sfp_lock_release ();
 }
 #endif
@@ -285,12 +285,12 @@ _fmemopen_r (struct _reent *ptr,
   if ((c = (fmemcookie *) _malloc_r (ptr, sizeof *c + (buf ? 0 : size)))
       == NULL)
     {
-      _newlib_sfp_lock_start ();
+      __sfp_free_lock (fp);
       fp->_flags = 0;		/* release */
 #ifndef __SINGLE_THREAD__
       __lock_close_recursive (fp->_lock);
 #endif
-      _newlib_sfp_lock_end ();
+      __sfp_free (fp);
       return NULL;
     }
 
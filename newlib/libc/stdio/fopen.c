@@ -85,6 +85,14 @@ that permits reading and writing anywhere in it; and <<"a+">> (or
 <<"ab+">>) to permit reading anywhere in an existing file, but writing
 only at the end.
 
+A `<<m>>' in a mode for reading only, as in <<"rm">> or <<"rbm">>, asks
+for the file to be mapped into memory with <<mmap>> rather than read
+into a buffer.  Reading the stream then takes data straight from the
+mapping, with no <<read>> calls.  Files that cannot be mapped, such as
+pipes and devices, and all files on systems without <<mmap>>, are
+buffered as usual.  Changing the buffering with <<setvbuf>> also ends
+the mapping.
+
 RETURNS
 <<fopen>> returns a file pointer which you can use for other file
 operations, unless the file you requested could not be opened; in that
@@ -95,7 +103,8 @@ PORTABILITY
 <<fopen>> is required by ANSI C.
 
 Supporting OS subroutines required: <<close>>, <<fstat>>, <<isatty>>,
-<<lseek>>, <<open>>, <<read>>, <<sbrk>>, <<write>>.
+<<lseek>>, <<open>>, <<read>>, <<sbrk>>, <<write>>; also <<mmap>> and
+<<munmap>> on systems with <<mmap>>.
 */
 
 #if defined(LIBC_SCCS) && !defined(lint)
@@ -106,6 +115,7 @@ static char sccsid[] = "%W% (Berkeley) %G%";
 #include <reent.h>
 #include <stdio.h>
 #include <errno.h>
+#include <string.h>
 #include <sys/lock.h>
 #ifdef __CYGWIN__
 #include <fcntl.h>
@@ -128,12 +138,12 @@ _fopen_r (struct _reent *ptr,
 
   if ((f = _open_r (ptr, file, oflags, 0666)) < 0)
     {
-      _newlib_sfp_lock_start (); 
+      __sfp_free_lock (fp);
       fp->_flags = 0;		/* release */
 #ifndef __SINGLE_THREAD__
       __lock_close_recursive (fp->_lock);
 #endif
-      _newlib_sfp_lock_end (); 
+      __sfp_free (fp);
       return NULL;
     }
 
@@ -147,6 +157,11 @@ _fopen_r (struct _reent *ptr,
   fp->_seek = __sseek;
   fp->_close = __sclose;
 
+#ifdef _STDIO_MMAP
+  if (flags == __SRD && strchr (mode, 'm') != NULL)
+    __smapbuf_r (ptr, fp);
+#endif
+
   if (fp->_flags & __SAPP)
     _fseek_r (ptr, fp, 0, SEEK_END);
 
@@ -84,6 +84,7 @@ Supporting OS subroutines required: <<close>>, <<fstat>>, <<isatty>>,
 #include <stdio.h>
 #include <string.h>
 #include <malloc.h>
+#include <limits.h>
 #include "local.h"
 
 #ifdef __IMPL_UNLOCKED__
@@ -140,6 +141,44 @@ crlf_r (struct _reent * ptr,
 
 #endif
 
+#if !defined(PREFER_SIZE_OVER_SPEED) && !defined(__OPTIMIZE_SIZE__)
+/*
+ * Refill fp as __srefill_r does, but into the caller's buffer p rather
+ * than fp's own, reading the largest multiple of the buffer size that
+ * is no more than resid.  fp->_r is the number read, and fp's buffer is
+ * left empty.  fp's buffer must be allocated and no ungetc buffer in use.
+ */
+static int
+refill_direct (struct _reent * ptr,
+       FILE * fp,
+       char * p,
+       size_t resid)
+{
+  unsigned char *old_base = fp->_bf._base;
+  int old_size = fp->_bf._size;
+  int rc;
+#ifdef _STDIO_ADAPTIVE_BUF
+  int old_run = fp->_bufrun;
+
+  /* Keep __srefill_r from resizing the caller's buffer.  */
+  fp->_bufrun = -1;
+#endif
+
+  if (resid > INT_MAX)
+    resid = INT_MAX;
+  fp->_bf._base = (unsigned char *) p;
+  fp->_bf._size = resid - resid % old_size;
+  rc = __srefill_r (ptr, fp);
+  fp->_bf._base = old_base;
+  fp->_bf._size = old_size;
+  fp->_p = old_base;
+#ifdef _STDIO_ADAPTIVE_BUF
+  fp->_bufrun = old_run;
+#endif
+  return rc;
+}
+#endif /* !PREFER_SIZE_OVER_SPEED && !__OPTIMIZE_SIZE__ */
+
 size_t
 _fread_r (struct _reent * ptr,
        void *__restrict buf,
@@ -150,6 +189,7 @@ _fread_r (struct _reent * ptr,
   register size_t resid;
   register char *p;
   register int r;
+  int rc;
   size_t total;
 
   if ((resid = count * size) == 0)
@@ -225,7 +265,29 @@ _fread_r (struct _reent * ptr,
 	  /* fp->_r = 0 ... done in __srefill */
 	  p += r;
 	  resid -= r;
-	  if (__srefill_r (ptr, fp))
+#if !defined(PREFER_SIZE_OVER_SPEED) && !defined(__OPTIMIZE_SIZE__)
+	  /* Once the buffer is drained, read a request larger than the
+	     buffer straight into the caller's memory, saving the copy and
+	     the read calls of a buffer at a time.  */
+	  if ((fp->_flags & __SRD) && !HASUB (fp)
+	      && !(fp->_flags2 & __SMAP))
+	    {
+	      if (fp->_bf._base == NULL)
+		__smakebuf_r (ptr, fp);
+	      if (resid >= (size_t) fp->_bf._size)
+		{
+		  rc = refill_direct (ptr, fp, p, resid);
+		  p += fp->_r;
+		  resid -= fp->_r;
+		  fp->_r = 0;
+		}
+	      else
+		rc = __srefill_r (ptr, fp);
+	    }
+	  else
+#endif /* !PREFER_SIZE_OVER_SPEED && !__OPTIMIZE_SIZE__ */
+	  rc = __srefill_r (ptr, fp);
+	  if (rc)
 	    {
 	      /* no more input: return partial result */
 #ifdef __SCLE
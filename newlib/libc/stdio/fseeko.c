@@ -310,6 +310,10 @@ _fseeko_r (struct _reent *ptr,
   fp->_p = fp->_bf._base;
   if (HASUB (fp))
     FREEUB (ptr, fp);
+#ifdef _STDIO_ADAPTIVE_BUF
+  if (__SADAPT (fp))
+    __sresetbuf_r (ptr, fp);
+#endif
   fp->_flags &= ~__SEOF;
   n = target - curoff;
   if (n)
@@ -342,6 +346,10 @@ dumb:
   fp->_p = fp->_bf._base;
   fp->_r = 0;
   /* fp->_w = 0; *//* unnecessary (I think...) */
+#ifdef _STDIO_ADAPTIVE_BUF
+  if (__SADAPT (fp))
+    __sresetbuf_r (ptr, fp);
+#endif
   fp->_flags &= ~__SEOF;
   /* Reset no-optimization flag after successful seek.  The
      no-optimization flag may be set in the case of a read
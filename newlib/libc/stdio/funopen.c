@@ -209,12 +209,12 @@ _funopen_r (struct _reent *ptr,
     return NULL;
   if ((c = (funcookie *) _malloc_r (ptr, sizeof *c)) == NULL)
     {
-      _newlib_sfp_lock_start ();
+      __sfp_free_lock (fp);
       fp->_flags = 0;		/* release */
 #ifndef __SINGLE_THREAD__
       __lock_close_recursive (fp->_lock);
 #endif
-      _newlib_sfp_lock_end ();
+      __sfp_free (fp);
       return NULL;
     }
 
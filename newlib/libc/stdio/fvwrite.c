@@ -219,6 +219,19 @@ __sfvwrite_r (struct _reent *ptr,
 	  if (!nlknown)
 	    {
 	      nl = memchr ((void *) p, '\n', len);
+#if !defined(PREFER_SIZE_OVER_SPEED) && !defined(__OPTIMIZE_SIZE__)
+	      /* Lines written together can be flushed together: go on to
+		 the last newline, so that a large write of many lines is
+		 not a write call per line.  */
+	      if (nl)
+		{
+		  char *q;
+
+		  while ((q = memchr ((void *) (nl + 1), '\n',
+				      len - (nl + 1 - p))) != NULL)
+		    nl = q;
+		}
+#endif
 	      nldist = nl ? nl + 1 - p : len + 1;
 	      nlknown = 1;
 	    }
@@ -234,6 +247,10 @@ __sfvwrite_r (struct _reent *ptr,
 	    }
 	  else if (s >= (w = fp->_bf._size))
 	    {
+#if !defined(PREFER_SIZE_OVER_SPEED) && !defined(__OPTIMIZE_SIZE__)
+	      /* write directly, as many whole buffers as there are */
+	      w = ((int)MIN (s, INT_MAX)) / w * w;
+#endif
 	      w = fp->_write (ptr, fp->_cookie, p, w);
 	      if (w <= 0)
 		goto err;
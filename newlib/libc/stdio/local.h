@@ -162,6 +162,7 @@ int	      _svfwprintf_r (struct _reent *, FILE *, const wchar_t *,
 int	      _svfiwprintf_r (struct _reent *, FILE *, const wchar_t *, 
 				  va_list);
 extern FILE  *__sfp (struct _reent *);
+extern void   __sfp_free (FILE *);
 extern int    __sflags (struct _reent *,const char*, int*);
 extern int    __sflush_r (struct _reent *,FILE *);
 #ifdef _STDIO_BSD_SEMANTICS
@@ -184,6 +185,36 @@ extern void   __smakebuf_r (struct _reent *, FILE *);
 extern int    __swhatbuf_r (struct _reent *, FILE *, size_t *, int *);
 extern int __submore (struct _reent *, FILE *);
 
+/* fopen mode "m": read regular files through a mapping (mapbuf.c).
+   configure.host defines HAVE_MMAP for systems which have mmap.  */
+#if defined (HAVE_MMAP) \
+    && !defined (PREFER_SIZE_OVER_SPEED) && !defined (__OPTIMIZE_SIZE__)
+#define _STDIO_MMAP
+extern void   __smapbuf_r (struct _reent *, FILE *);
+extern int    __smaprefill_r (struct _reent *, FILE *);
+extern void   __sunmapbuf_r (struct _reent *, FILE *);
+#endif
+
+#ifdef _STDIO_ADAPTIVE_BUF
+/* Adaptive buffer sizing (makebuf.c).  A stream that reads or writes
+   _STDIO_BUFRUN full buffers in a row gets one twice as large, up to
+   __sbufmax_r bytes.  Seeking out of the buffer, reaching end of file
+   or flushing a partly filled buffer shrinks it back to _bufmin.  Only
+   fully buffered streams with a buffer from __smakebuf_r, or from
+   setvbuf with size 0, adapt; _bufrun is -1 for the others.  */
+#ifndef _STDIO_BUFMAX
+#define _STDIO_BUFMAX 65536
+#endif
+#define _STDIO_BUFRUN 2
+#define __SADAPT(fp) \
+  (((fp)->_flags & (__SMBF | __SLBF | __SNBF | __SSTR)) == __SMBF \
+   && (fp)->_bufrun >= 0)
+extern size_t __stdio_bufmax;
+extern size_t __sbufmax_r (struct _reent *);
+extern void   __sgrowbuf_r (struct _reent *, FILE *);
+extern void   __sresetbuf_r (struct _reent *, FILE *);
+#endif
+
 #ifdef __LARGE64_FILES
 extern _fpos64_t __sseek64 (struct _reent *, void *, _fpos64_t, int);
 extern _READ_WRITE_RETURN_TYPE __swrite64 (struct _reent *, void *,
@@ -267,9 +298,30 @@ char *_llicvt (char *, long long, char);
 #define __sfp_lock_release()
 #define __sinit_lock_acquire()
 #define __sinit_lock_release()
+#define __sfp_free_lock(fp)
 #else
 void __sfp_lock_acquire (void);
 void __sfp_lock_release (void);
+void __sfp_free_lock (FILE *);
+#endif
+
+/* Initialize the lock of a FILE that does not come from __sfp, such as
+   the one on the stack of __sbprintf.  With _STDIO_BIASED_LOCK, the lock
+   is left biased to no thread.  */
+#ifdef __SINGLE_THREAD__
+#define __sinitlock(fp)
+#elif defined (_STDIO_BIASED_LOCK)
+#define __sinitlock(fp) \
+  do \
+    { \
+      __lock_init_recursive ((fp)->_lock); \
+      (fp)->_lock_bias = NULL; \
+      (fp)->_lock_busy = 0; \
+      (fp)->_lock_revoked = 0; \
+    } \
+  while (0)
+#else
+#define __sinitlock(fp) __lock_init_recursive ((fp)->_lock)
 #endif
 
 /* Types used in positional argument support in vfprinf/vfwprintf.
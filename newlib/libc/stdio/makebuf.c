@@ -19,6 +19,7 @@
 #include <_ansi.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/unistd.h>
@@ -64,6 +65,9 @@ __smakebuf_r (struct _reent *ptr,
       fp->_flags |= __SMBF;
       fp->_bf._base = fp->_p = (unsigned char *) p;
       fp->_bf._size = size;
+#ifdef _STDIO_ADAPTIVE_BUF
+      fp->_bufmin = size;
+#endif
       if (couldbetty && _isatty_r (ptr, fp->_file))
 	fp->_flags = (fp->_flags & ~__SNBF) | __SLBF;
       fp->_flags |= flags;
@@ -122,3 +126,75 @@ __swhatbuf_r (struct _reent *ptr,
   *bufsize = BUFSIZ;
   return (snpt);
 }
+
+#ifdef _STDIO_ADAPTIVE_BUF
+/*
+ * Largest size an adaptive buffer grows to: NEWLIB_STDIO_BUFMAX from
+ * the environment if set, else _STDIO_BUFMAX, unless __fsetbufmax()
+ * has been called.  (size_t) -1 means not looked up yet.
+ */
+size_t __stdio_bufmax = (size_t) -1;
+
+size_t
+__sbufmax_r (struct _reent *ptr)
+{
+  char *s;
+  size_t max;
+
+  if ((max = __stdio_bufmax) == (size_t) -1)
+    {
+      if ((s = _getenv_r (ptr, "NEWLIB_STDIO_BUFMAX")) != NULL)
+	max = _strtoul_r (ptr, s, NULL, 0);
+      else
+	max = _STDIO_BUFMAX;
+      if (max > INT_MAX)
+	max = INT_MAX;
+      __stdio_bufmax = max;
+    }
+  return max;
+}
+
+/*
+ * Replace the empty buffer of a stream that has been transferring
+ * whole buffers by one twice the size, if that is within the limit.
+ * The stream keeps its buffer if malloc fails.
+ */
+void
+__sgrowbuf_r (struct _reent *ptr,
+       register FILE *fp)
+{
+  size_t size = fp->_bf._size;
+  void *p;
+
+  fp->_bufrun = 0;
+  if (size > __sbufmax_r (ptr) / 2
+      || (p = _malloc_r (ptr, 2 * size)) == NULL)
+    return;
+  _free_r (ptr, (void *) fp->_bf._base);
+  fp->_bf._base = fp->_p = (unsigned char *) p;
+  fp->_bf._size = 2 * size;
+  if (fp->_flags & __SWR)
+    fp->_w = fp->_bf._size;
+}
+
+/*
+ * End the sequential run of a stream whose buffer is empty, and give
+ * back the memory its buffer has grown by.
+ */
+void
+__sresetbuf_r (struct _reent *ptr,
+       register FILE *fp)
+{
+  void *p;
+
+  fp->_bufrun = 0;
+  if (fp->_bf._size > fp->_bufmin
+      && (p = _realloc_r (ptr, (void *) fp->_bf._base, fp->_bufmin)) != NULL)
+    {
+      fp->_bf._base = fp->_p = (unsigned char *) p;
+      fp->_bf._size = fp->_bufmin;
+      if (fp->_flags & __SWR)
+	fp->_w = fp->_bf._size;
+    }
+}
+#endif /* _STDIO_ADAPTIVE_BUF */
@@ -0,0 +1,128 @@
+/*
+ * ====================================================
+ * Permission to use, copy, modify, and distribute this
+ * software is freely granted, provided that this notice
+ * is preserved.
+ * ====================================================
+ */
+/* No user fns here. */
+
+#include <_ansi.h>
+#include <stdio.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "local.h"
+
+#ifdef _STDIO_MMAP
+
+#include <sys/mman.h>
+
+/*
+ * Make the buffer of a stream just opened for reading a read-only
+ * mapping of its file, if that is a nonempty regular file of at most
+ * INT_MAX bytes.  The stream is otherwise left
+ * to be buffered as usual.
+ *
+ * The whole file is the buffer; __smaprefill_r points _p and _r into
+ * it.  As for a buffer that has been read, the file offset is kept at
+ * the end of the data handed out, so ftell, fseek and fflush need no
+ * special cases.
+ */
+void
+__smapbuf_r (struct _reent *ptr,
+       register FILE *fp)
+{
+#ifdef __USE_INTERNAL_STAT64
+  struct stat64 st;
+#else
+  struct stat st;
+#endif
+  void *p;
+
+  if (fp->_file < 0
+#ifdef __USE_INTERNAL_STAT64
+      || _fstat64_r (ptr, fp->_file, &st) < 0
+#else
+      || _fstat_r (ptr, fp->_file, &st) < 0
+#endif
+      || (st.st_mode & S_IFMT) != S_IFREG
+      || st.st_size <= 0 || st.st_size > INT_MAX)
+    return;
+  p = mmap (NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fp->_file, 0);
+  if (p == MAP_FAILED)
+    return;
+  fp->_flags2 |= __SMAP;
+  fp->_flags |= __SOPT | __SOFF;
+  fp->_offset = 0;
+#ifdef HAVE_BLKSIZE
+  fp->_blksize = st.st_blksize > 0 ? st.st_blksize : 1024;
+#else
+  fp->_blksize = 1024;
+#endif
+  fp->_bf._base = fp->_p = (unsigned char *) p;
+  fp->_bf._size = (int) st.st_size;
+}
+
+/*
+ * Refill a mapped stream with the rest of the file from the current
+ * offset.  At the end of the mapping, check whether the file has grown
+ * since it was mapped; if it has, drop the mapping and return 1 to let
+ * __srefill_r read on into an ordinary buffer.
+ */
+int
+__smaprefill_r (struct _reent *ptr,
+       register FILE *fp)
+{
+#ifdef __USE_INTERNAL_STAT64
+  struct stat64 st;
+#else
+  struct stat st;
+#endif
+  _fpos_t pos;
+
+  if (fp->_flags & __SOFF)
+    pos = fp->_offset;
+  else if ((pos = fp->_seek (ptr, fp->_cookie, (_fpos_t) 0, SEEK_CUR)) == -1)
+    goto err;
+  if (pos < fp->_bf._size)
+    {
+      if (fp->_seek (ptr, fp->_cookie, (_fpos_t) fp->_bf._size, SEEK_SET)
+	  == -1)
+	goto err;
+      fp->_p = fp->_bf._base + pos;
+      fp->_r = fp->_bf._size - pos;
+      return 0;
+    }
+#ifdef __USE_INTERNAL_STAT64
+  if (_fstat64_r (ptr, fp->_file, &st) == 0 && st.st_size != fp->_bf._size)
+#else
+  if (_fstat_r (ptr, fp->_file, &st) == 0 && st.st_size != fp->_bf._size)
+#endif
+    {
+      __sunmapbuf_r (ptr, fp);
+      return 1;
+    }
+  fp->_flags |= __SEOF;
+  return EOF;
+
+err:
+  fp->_flags |= __SERR;
+  return EOF;
+}
+
+/*
+ * Drop the mapping of a mapped stream, leaving it without a buffer.
+ */
+void
+__sunmapbuf_r (struct _reent *ptr,
+       register FILE *fp)
+{
+  munmap ((void *) fp->_bf._base, (size_t) fp->_bf._size);
+  fp->_flags2 &= ~__SMAP;
+  fp->_bf._base = fp->_p = NULL;
+  fp->_bf._size = 0;
+  fp->_r = 0;
+}
+
+#endif /* _STDIO_MMAP */
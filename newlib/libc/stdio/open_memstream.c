@@ -308,12 +308,12 @@ internal_open_memstream_r (struct _reent *ptr,
     return NULL;
   if ((c = (memstream *) _malloc_r (ptr, sizeof *c)) == NULL)
     {
-      _newlib_sfp_lock_start ();
+      __sfp_free_lock (fp);
       fp->_flags = 0;		/* release */
 #ifndef __SINGLE_THREAD__
       __lock_close_recursive (fp->_lock);
 #endif
-      _newlib_sfp_lock_end ();
+      __sfp_free (fp);
       return NULL;
     }
   /* Use *size as a hint for initial sizing, but bound the initial
@@ -333,12 +333,12 @@ internal_open_memstream_r (struct _reent *ptr,
   *buf = _malloc_r (ptr, c->max);
   if (!*buf)
     {
-      _newlib_sfp_lock_start ();
+      __sfp_free_lock (fp);
       fp->_flags = 0;		/* release */
 #ifndef __SINGLE_THREAD__
       __lock_close_recursive (fp->_lock);
 #endif
-      _newlib_sfp_lock_end ();
+      __sfp_free (fp);
       _free_r (ptr, c);
       return NULL;
     }
@@ -90,6 +90,18 @@ __srefill_r (struct _reent * ptr,
 	}
     }
 
+#ifdef _STDIO_MMAP
+  if (fp->_flags2 & __SMAP)
+    {
+      int ret = __smaprefill_r (ptr, fp);
+
+      /* 1 if the file has grown past the mapping, which is gone now:
+	 read on into an ordinary buffer.  */
+      if (ret <= 0)
+	return ret;
+    }
+#endif
+
   if (fp->_bf._base == NULL)
     __smakebuf_r (ptr, fp);
 
@@ -111,8 +123,23 @@ __srefill_r (struct _reent * ptr,
 	__sflush_r (ptr, fp);
     }
 
+#ifdef _STDIO_ADAPTIVE_BUF
+  if (__SADAPT (fp) && fp->_bufrun >= _STDIO_BUFRUN)
+    __sgrowbuf_r (ptr, fp);
+#endif
   fp->_p = fp->_bf._base;
   fp->_r = fp->_read (ptr, fp->_cookie, (char *) fp->_p, fp->_bf._size);
+#ifdef _STDIO_ADAPTIVE_BUF
+  if (__SADAPT (fp))
+    {
+      if (fp->_r == fp->_bf._size)
+	fp->_bufrun++;
+      else if (fp->_r <= 0)
+	__sresetbuf_r (ptr, fp);
+      else
+	fp->_bufrun = 0;
+    }
+#endif
   if (fp->_r <= 0)
     {
       if (fp->_r == 0)
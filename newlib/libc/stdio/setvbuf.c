@@ -123,6 +123,10 @@ setvbuf (register FILE * fp,
   fp->_r = fp->_lbfsize = 0;
   if (fp->_flags & __SMBF)
     _free_r (reent, (void *) fp->_bf._base);
+#ifdef _STDIO_MMAP
+  if (fp->_flags2 & __SMAP)
+    __sunmapbuf_r (reent, fp);
+#endif
   fp->_flags &= ~(__SLBF | __SNBF | __SMBF | __SOPT | __SNPT | __SEOF);
 
   if (mode == _IONBF)
@@ -134,6 +138,12 @@ setvbuf (register FILE * fp,
    * care since our caller told us how to buffer.
    */
   fp->_flags |= __swhatbuf_r (reent, fp, &iosize, &ttyflag);
+#ifdef _STDIO_ADAPTIVE_BUF
+  /* Only a buffer of the default size may adapt to the access
+     pattern; one with a size given here stays as it is.  */
+  fp->_bufrun = size == 0 ? 0 : -1;
+  fp->_bufmin = iosize;
+#endif
   if (size == 0)
     {
       buf = NULL;
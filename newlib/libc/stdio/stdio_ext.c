@@ -1,6 +1,6 @@
 /*
 FUNCTION
-<<stdio_ext>>,<<__fbufsize>>,<<__fpending>>,<<__flbf>>,<<__freadable>>,<<__fwritable>>,<<__freading>>,<<__fwriting>>---access internals of FILE structure
+<<stdio_ext>>,<<__fbufsize>>,<<__fpending>>,<<__flbf>>,<<__freadable>>,<<__fwritable>>,<<__freading>>,<<__fwriting>>,<<__fsetbufmax>>---access internals of FILE structure
 
 INDEX
 	__fbufsize
@@ -16,6 +16,8 @@ INDEX
 	__freading
 INDEX
 	__fwriting
+INDEX
+	__fsetbufmax
 
 SYNOPSIS
 	#include <stdio.h>
@@ -27,6 +29,7 @@ SYNOPSIS
 	int __fwritable(FILE *<[fp]>);
 	int __freading(FILE *<[fp]>);
 	int __fwriting(FILE *<[fp]>);
+	size_t __fsetbufmax(size_t <[size]>);
 
 DESCRIPTION
 These functions provides access to the internals of the FILE structure <[fp]>.
@@ -48,8 +51,20 @@ it was a read, or if it read-only, and <<0>> if not.
 <<__fwriting>> returns nonzero if stream <[fp]> if the last operation on
 it was a write, or if it write-only, and <<0>> if not.
 
+<<__fsetbufmax>> is only available when newlib is configured with
+<<--enable-newlib-stdio-adaptive-buf>>.  Fully buffered streams then
+double the size of their buffer after transferring a few full buffers
+in a row, and shrink it back when they seek out of the buffer, reach
+end of file or flush a partly filled buffer.  <<__fsetbufmax>> sets the
+largest size a buffer grows to, for all streams; <<0>> stops buffers
+from growing.  The initial limit is taken from the environment variable
+<<NEWLIB_STDIO_BUFMAX>> if it is set, and is 65536 bytes otherwise.
+Buffers given a size with <<setvbuf>> keep that size.  <<__fsetbufmax>>
+returns the previous limit.
+
 PORTABILITY
 These functions originate from Solaris and are also provided by GNU libc.
+<<__fsetbufmax>> is specific to newlib.
 
 No supporting OS subroutines are required.
 */
@@ -58,6 +73,10 @@ No supporting OS subroutines are required.
 
 #include <_ansi.h>
 #include <stdio.h>
+#ifdef _STDIO_ADAPTIVE_BUF
+#include <limits.h>
+#include "local.h"
+#endif
 
 /* Subroutine versions of the inline or macro functions. */
 
@@ -103,4 +122,15 @@ __fwriting (FILE * fp)
   return (fp->_flags & __SWR) != 0;
 }
 
+#ifdef _STDIO_ADAPTIVE_BUF
+size_t
+__fsetbufmax (size_t size)
+{
+  size_t old = __sbufmax_r (_REENT);
+
+  __stdio_bufmax = size > INT_MAX ? INT_MAX : size;
+  return old;
+}
+#endif
+
 #endif /* __rtems__ */
@@ -194,9 +194,7 @@ __sbwprintf (struct _reent *rptr,
 	fake._bf._base = fake._p = buf;
 	fake._bf._size = fake._w = sizeof (buf);
 	fake._lbfsize = 0;	/* not actually used, but Just In Case */
-#ifndef __SINGLE_THREAD__
-	__lock_init_recursive (fake._lock);
-#endif
+	__sinitlock (&fake);
 
 	/* do the work, then copy any error status */
 	ret = _VFWPRINTF_R (rptr, &fake, fmt, ap);
@@ -79,12 +79,12 @@ _fopen64_r (struct _reent *ptr,
 
   if ((f = _open64_r (ptr, file, oflags, 0666)) < 0)
     {
-      _newlib_sfp_lock_start ();
+      __sfp_free_lock (fp);
       fp->_flags = 0;		/* release */
 #ifndef __SINGLE_THREAD__
       __lock_close_recursive (fp->_lock);
 #endif
-      _newlib_sfp_lock_end ();
+      __sfp_free (fp);
       return NULL;
     }
 
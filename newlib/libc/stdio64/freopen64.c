@@ -186,12 +186,19 @@ _freopen64_r (struct _reent *ptr,
 
   if (fp->_flags & __SMBF)
     _free_r (ptr, (char *) fp->_bf._base);
+#ifdef _STDIO_MMAP
+  if (fp->_flags2 & __SMAP)
+    __sunmapbuf_r (ptr, fp);
+#endif
   fp->_w = 0;
   fp->_r = 0;
   fp->_p = NULL;
   fp->_bf._base = NULL;
   fp->_bf._size = 0;
   fp->_lbfsize = 0;
+#ifdef _STDIO_ADAPTIVE_BUF
+  fp->_bufrun = 0;
+#endif
   if (HASUB (fp))
     FREEUB (ptr, fp);
   fp->_ub._size = 0;
@@ -204,7 +211,7 @@ _freopen64_r (struct _reent *ptr,
 
   if (f < 0)
     {				/* did not get it after all */
-      __sfp_lock_acquire ();
+      __sfp_free_lock (fp);
       fp->_flags = 0;		/* set it free */
       _REENT_ERRNO(ptr) = e;	/* restore in case _close clobbered */
       if (!(oflags2 & __SNLK))
@@ -212,7 +219,7 @@ _freopen64_r (struct _reent *ptr,
 #ifndef __SINGLE_THREAD__
       __lock_close_recursive (fp->_lock);
 #endif
-      __sfp_lock_release ();
+      __sfp_free (fp);
 #if !defined (__SINGLE_THREAD__) && defined (_POSIX_THREADS)
       pthread_setcancelstate (__oldcancel, &__oldcancel);
 #endif
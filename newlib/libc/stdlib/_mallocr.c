@@ -215,6 +215,14 @@ int _dummy_mallocr = 1;
   _LIBC                     (default: NOT defined)
      Defined only when compiled as part of the Cygnus newlib
      distribution.
+  _MALLOC_TCACHE            (default: NOT defined)
+     Defined by --enable-newlib-malloc-tcache.  Gives each thread a
+     small cache of freed chunks that malloc and free use without
+     taking MALLOC_LOCK.  See `Per-thread caching' below.
+  TCACHE_MAX_SIZE           (default: 256)
+  TCACHE_COUNT              (default: 16)
+     Largest chunk size held in a thread cache, and the number of
+     chunks of one size a thread may hold before free hands them back.
   WIN32                     (default: undefined)
      Define this on MS win (95, nt) platforms to compile in sbrk emulation.
   LACKS_UNISTD_H            (default: undefined)
@@ -1005,6 +1013,18 @@ extern Void_t*     sbrk();
 
 #ifdef _LIBC
 
+#ifdef _MALLOC_INSTRUMENT
+/* The public entry points are in mallinstr.c; they count and report
+   each call and call these.  */
+#define cALLOc		__malloc_raw_calloc_r
+#define fREe		__malloc_raw_free_r
+#define mALLOc		__malloc_raw_malloc_r
+#define mEMALIGn	__malloc_raw_memalign_r
+#define rEALLOc		__malloc_raw_realloc_r
+#define vALLOc		__malloc_raw_valloc_r
+#define pvALLOc		__malloc_raw_pvalloc_r
+extern void _free_r(struct _reent *, void *);
+#else
 #define cALLOc		_calloc_r
 #define fREe		_free_r
 #define mALLOc		_malloc_r
@@ -1012,14 +1032,17 @@ extern Void_t*     sbrk();
 #define rEALLOc		_realloc_r
 #define vALLOc		_valloc_r
 #define pvALLOc		_pvalloc_r
+#endif
 #define mALLINFo	_mallinfo_r
 #define mALLOPt		_mallopt_r
 
 #define malloc_stats			_malloc_stats_r
+#define malloc_dump_bins		_malloc_dump_bins_r
 #define malloc_trim			_malloc_trim_r
 #define malloc_usable_size		_malloc_usable_size_r
 
 #define malloc_update_mallinfo		__malloc_update_mallinfo
+#define malloc_tcache_flush		__malloc_tcache_flush
 
 #define malloc_av_			__malloc_av_
 #define malloc_current_mallinfo		__malloc_current_mallinfo
@@ -1028,6 +1051,7 @@ extern Void_t*     sbrk();
 #define malloc_sbrk_base		__malloc_sbrk_base
 #define malloc_top_pad			__malloc_top_pad
 #define malloc_trim_threshold		__malloc_trim_threshold
+#define malloc_tcache			__malloc_tcache
 
 #else /* ! _LIBC */
 
@@ -1758,6 +1782,66 @@ extern unsigned long max_mmapped_mem;
 /* The total memory obtained from system via sbrk */
 #define sbrked_mem  (current_mallinfo.arena)
 
+
+
+/*
+  Per-thread caching
+
+    With _MALLOC_TCACHE, every thread owns one singly-linked list of
+    recently freed chunks per chunk size up to TCACHE_MAX_SIZE, linked
+    through their fd fields.  A chunk sitting in a thread cache keeps
+    its inuse bit, so to the rest of the allocator it is simply an
+    allocated chunk: it is never coalesced, and realloc, memalign,
+    mallinfo etc. need no changes (mallinfo counts cached chunks as
+    allocated).
+
+    malloc pops an exact-size chunk from the calling thread's list and
+    free pushes onto it, neither taking MALLOC_LOCK.  When a list grows
+    to TCACHE_COUNT chunks, free hands all but TCACHE_KEEP of them back
+    to the shared bins under a single MALLOC_LOCK.
+
+    A thread should call malloc_tcache_flush before it exits, or its
+    cached chunks are lost.  malloc also flushes the calling thread's
+    cache before giving up on a request.
+*/
+
+#ifdef _MALLOC_TCACHE
+
+#ifndef TCACHE_MAX_SIZE
+#define TCACHE_MAX_SIZE     256
+#endif
+
+#ifndef TCACHE_COUNT
+#define TCACHE_COUNT         16
+#endif
+
+#define TCACHE_KEEP         (TCACHE_COUNT / 2)
+#define TCACHE_NBINS        ((TCACHE_MAX_SIZE - MINSIZE) / MALLOC_ALIGNMENT + 1)
+
+#define in_tcache_range(sz) ((unsigned long)(sz) <= TCACHE_MAX_SIZE)
+#define tcache_index(sz)    (((unsigned long)(sz) - MINSIZE) / MALLOC_ALIGNMENT)
+
+struct malloc_tcache
+{
+  mchunkptr     entries[TCACHE_NBINS];  /* cached chunks, linked via fd */
+  unsigned char counts[TCACHE_NBINS];   /* length of each list */
+  unsigned char flushing;               /* free must bypass the cache */
+};
+
+#ifdef DEFINE_MALLOC
+STATIC _Thread_local struct malloc_tcache malloc_tcache;
+#else
+extern _Thread_local struct malloc_tcache malloc_tcache;
+#endif
+
+#if __STD_C
+int malloc_tcache_flush(RONEARG);
+#else
+int malloc_tcache_flush();
+#endif
+
+#endif /* _MALLOC_TCACHE */
+
 
 
 /* 
@@ -2362,6 +2446,22 @@ Void_t* mALLOc(RARG bytes) RDECL size_t bytes;
     return 0;
   }
 
+#ifdef _MALLOC_TCACHE
+  /* Try this thread's cache first; no locking needed */
+
+  if (in_tcache_range(nb))
+  {
+    idx = tcache_index(nb);
+    victim = malloc_tcache.entries[idx];
+    if (victim != 0)
+    {
+      malloc_tcache.entries[idx] = victim->fd;
+      --malloc_tcache.counts[idx];
+      return chunk2mem(victim);
+    }
+  }
+#endif
+
   MALLOC_LOCK;
 
   /* Check for exact match in a bin */
@@ -2585,6 +2685,11 @@ Void_t* mALLOc(RARG bytes) RDECL size_t bytes;
     if (chunksize(top) < nb || remainder_size < (long)MINSIZE)
     {
       MALLOC_UNLOCK;
+#ifdef _MALLOC_TCACHE
+      /* Give back cached chunks and try once more */
+      if (malloc_tcache_flush(RONECALL) != 0)
+        return mALLOc(RCALL bytes);
+#endif
       return 0; /* propagate failure */
     }
   }
@@ -2626,6 +2731,41 @@ Void_t* mALLOc(RARG bytes) RDECL size_t bytes;
 */
 
 
+#ifdef _MALLOC_TCACHE
+
+/*
+  Hand all but the first `keep' chunks of one thread cache list back
+  to the shared bins.  Called with MALLOC_LOCK held and
+  malloc_tcache.flushing set, so that fREe bypasses the cache.
+*/
+
+#if __STD_C
+static void tcache_release(RARG int idx, int keep)
+#else
+static void tcache_release(RARG idx, keep) RDECL int idx; int keep;
+#endif
+{
+  mchunkptr* link = &malloc_tcache.entries[idx];
+  mchunkptr  p;
+  mchunkptr  next;
+  int        n;
+
+  for (n = 0; n < keep && *link != 0; ++n)
+    link = &(*link)->fd;
+
+  p = *link;
+  *link = 0;
+  malloc_tcache.counts[idx] = n;
+
+  for (; p != 0; p = next)
+  {
+    next = p->fd;
+    fREe(RCALL chunk2mem(p));
+  }
+}
+
+#endif /* _MALLOC_TCACHE */
+
 #if __STD_C
 void fREe(RARG Void_t* mem)
 #else
@@ -2652,6 +2792,27 @@ void fREe(RARG mem) RDECL Void_t* mem;
   if (mem == 0)                              /* free(0) has no effect */
     return;
 
+#ifdef _MALLOC_TCACHE
+  p = mem2chunk(mem);
+  sz = chunksize(p);
+
+  if (in_tcache_range(sz) && !chunk_is_mmapped(p) && !malloc_tcache.flushing)
+  {
+    idx = tcache_index(sz);
+    p->fd = malloc_tcache.entries[idx];
+    malloc_tcache.entries[idx] = p;
+    if (++malloc_tcache.counts[idx] >= TCACHE_COUNT)
+    {
+      malloc_tcache.flushing = 1;
+      MALLOC_LOCK;
+      tcache_release(RCALL idx, TCACHE_KEEP);
+      MALLOC_UNLOCK;
+      malloc_tcache.flushing = 0;
+    }
+    return;
+  }
+#endif
+
   MALLOC_LOCK;
 
   p = mem2chunk(mem);
@@ -3285,7 +3446,7 @@ void cfree(mem) Void_t *mem;
 #endif
 {
 #ifdef _LIBC
-  fREe(_REENT, mem);
+  _free_r(_REENT, mem);
 #else
   fREe(mem);
 #endif
@@ -3386,6 +3547,43 @@ int malloc_trim(RARG pad) RDECL size_t pad;
   }
 }
 
+#ifdef _MALLOC_TCACHE
+
+/*
+  malloc_tcache_flush returns every chunk held in the calling thread's
+  cache to the shared bins, and returns nonzero if there were any.
+  Threads should call it before they exit.
+*/
+
+#if __STD_C
+int malloc_tcache_flush(RONEARG)
+#else
+int malloc_tcache_flush(RONEARG) RDECL
+#endif
+{
+  int i;
+  int released = 0;
+
+  if (malloc_tcache.flushing)
+    return 0;
+
+  malloc_tcache.flushing = 1;
+  MALLOC_LOCK;
+  for (i = 0; i < TCACHE_NBINS; ++i)
+  {
+    if (malloc_tcache.entries[i] != 0)
+    {
+      released = 1;
+      tcache_release(RCALL i, 0);
+    }
+  }
+  MALLOC_UNLOCK;
+  malloc_tcache.flushing = 0;
+  return released;
+}
+
+#endif /* _MALLOC_TCACHE */
+
 #endif /* DEFINE_FREE */
 
 #ifdef DEFINE_MALLOC_USABLE_SIZE
@@ -3552,6 +3750,51 @@ void malloc_stats(RONEARG) RDECL
 #endif
 }
 
+#if defined(_MALLOC_INSTRUMENT) && defined(_LIBC)
+
+/*
+
+  malloc_dump_bins:
+
+    Prints on stderr the number of chunks and of bytes in each
+    non-empty bin, then the size of the top chunk.
+
+*/
+
+void malloc_dump_bins(RONEARG)
+{
+  int i;
+  mbinptr b;
+  mchunkptr p;
+  unsigned long nchunks, nbytes;
+  FILE *fp;
+
+  _REENT_SMALL_CHECK_INIT(reent_ptr);
+  fp = _stderr_r(reent_ptr);
+
+  /* Write the heading before taking the lock, so that any memory the
+     stream needs is allocated before the bins are walked.  */
+  fiprintf(fp, "bin     chunks      bytes\n");
+
+  MALLOC_LOCK;
+  for (i = 1; i < NAV; ++i)
+  {
+    b = bin_at(i);
+    nchunks = nbytes = 0;
+    for (p = last(b); p != b; p = p->bk)
+    {
+      nchunks++;
+      nbytes += chunksize(p);
+    }
+    if (nchunks != 0)
+      fiprintf(fp, "%3d %10lu %10lu\n", i, nchunks, nbytes);
+  }
+  fiprintf(fp, "top %10s %10lu\n", "", (unsigned long)chunksize(top));
+  MALLOC_UNLOCK;
+}
+
+#endif /* _MALLOC_INSTRUMENT && _LIBC */
+
 #endif /* DEFINE_MALLOC_STATS */
 
 #ifdef DEFINE_MALLINFO
@@ -144,6 +144,398 @@ quorem (_Bigint * b, _Bigint * S)
   return q;
 }
 
+/* Without the size optimizations, modes 0, 2 and 3 are first tried with
+   Grisu3 (Florian Loitsch, "Printing Floating-Point Numbers Quickly and
+   Accurately with Integers", PLDI 2010): d is scaled by a cached power
+   of ten into a 64-bit integer part and fraction, and the digits are
+   produced from these with a known error bound.  When that error leaves
+   the result in doubt, which is rare, grisu() gives up and the exact
+   algorithm below is used.  */
+
+#if defined (IEEE_Arith) && !defined (_DOUBLE_IS_32BITS) \
+  && !defined (PREFER_SIZE_OVER_SPEED) && !defined (__OPTIMIZE_SIZE__) \
+  && !defined (No_Grisu)
+#define Grisu
+#endif
+
+#ifdef Grisu
+typedef struct
+{
+  __uint64_t f;
+  int e;
+} diy_fp;			/* f * 2^e */
+
+/* 10^k for k = -348, -340, ..., 340, rounded to 64 bits.  */
+static const struct
+{
+  __uint64_t f;
+  short e, k;
+} cached_powers[] = {
+  { 0xfa8fd5a0081c0288ULL, -1220, -348 },
+  { 0xbaaee17fa23ebf76ULL, -1193, -340 },
+  { 0x8b16fb203055ac76ULL, -1166, -332 },
+  { 0xcf42894a5dce35eaULL, -1140, -324 },
+  { 0x9a6bb0aa55653b2dULL, -1113, -316 },
+  { 0xe61acf033d1a45dfULL, -1087, -308 },
+  { 0xab70fe17c79ac6caULL, -1060, -300 },
+  { 0xff77b1fcbebcdc4fULL, -1034, -292 },
+  { 0xbe5691ef416bd60cULL, -1007, -284 },
+  { 0x8dd01fad907ffc3cULL, -980, -276 },
+  { 0xd3515c2831559a83ULL, -954, -268 },
+  { 0x9d71ac8fada6c9b5ULL, -927, -260 },
+  { 0xea9c227723ee8bcbULL, -901, -252 },
+  { 0xaecc49914078536dULL, -874, -244 },
+  { 0x823c12795db6ce57ULL, -847, -236 },
+  { 0xc21094364dfb5637ULL, -821, -228 },
+  { 0x9096ea6f3848984fULL, -794, -220 },
+  { 0xd77485cb25823ac7ULL, -768, -212 },
+  { 0xa086cfcd97bf97f4ULL, -741, -204 },
+  { 0xef340a98172aace5ULL, -715, -196 },
+  { 0xb23867fb2a35b28eULL, -688, -188 },
+  { 0x84c8d4dfd2c63f3bULL, -661, -180 },
+  { 0xc5dd44271ad3cdbaULL, -635, -172 },
+  { 0x936b9fcebb25c996ULL, -608, -164 },
+  { 0xdbac6c247d62a584ULL, -582, -156 },
+  { 0xa3ab66580d5fdaf6ULL, -555, -148 },
+  { 0xf3e2f893dec3f126ULL, -529, -140 },
+  { 0xb5b5ada8aaff80b8ULL, -502, -132 },
+  { 0x87625f056c7c4a8bULL, -475, -124 },
+  { 0xc9bcff6034c13053ULL, -449, -116 },
+  { 0x964e858c91ba2655ULL, -422, -108 },
+  { 0xdff9772470297ebdULL, -396, -100 },
+  { 0xa6dfbd9fb8e5b88fULL, -369, -92 },
+  { 0xf8a95fcf88747d94ULL, -343, -84 },
+  { 0xb94470938fa89bcfULL, -316, -76 },
+  { 0x8a08f0f8bf0f156bULL, -289, -68 },
+  { 0xcdb02555653131b6ULL, -263, -60 },
+  { 0x993fe2c6d07b7facULL, -236, -52 },
+  { 0xe45c10c42a2b3b06ULL, -210, -44 },
+  { 0xaa242499697392d3ULL, -183, -36 },
+  { 0xfd87b5f28300ca0eULL, -157, -28 },
+  { 0xbce5086492111aebULL, -130, -20 },
+  { 0x8cbccc096f5088ccULL, -103, -12 },
+  { 0xd1b71758e219652cULL, -77, -4 },
+  { 0x9c40000000000000ULL, -50, 4 },
+  { 0xe8d4a51000000000ULL, -24, 12 },
+  { 0xad78ebc5ac620000ULL, 3, 20 },
+  { 0x813f3978f8940984ULL, 30, 28 },
+  { 0xc097ce7bc90715b3ULL, 56, 36 },
+  { 0x8f7e32ce7bea5c70ULL, 83, 44 },
+  { 0xd5d238a4abe98068ULL, 109, 52 },
+  { 0x9f4f2726179a2245ULL, 136, 60 },
+  { 0xed63a231d4c4fb27ULL, 162, 68 },
+  { 0xb0de65388cc8ada8ULL, 189, 76 },
+  { 0x83c7088e1aab65dbULL, 216, 84 },
+  { 0xc45d1df942711d9aULL, 242, 92 },
+  { 0x924d692ca61be758ULL, 269, 100 },
+  { 0xda01ee641a708deaULL, 295, 108 },
+  { 0xa26da3999aef774aULL, 322, 116 },
+  { 0xf209787bb47d6b85ULL, 348, 124 },
+  { 0xb454e4a179dd1877ULL, 375, 132 },
+  { 0x865b86925b9bc5c2ULL, 402, 140 },
+  { 0xc83553c5c8965d3dULL, 428, 148 },
+  { 0x952ab45cfa97a0b3ULL, 455, 156 },
+  { 0xde469fbd99a05fe3ULL, 481, 164 },
+  { 0xa59bc234db398c25ULL, 508, 172 },
+  { 0xf6c69a72a3989f5cULL, 534, 180 },
+  { 0xb7dcbf5354e9beceULL, 561, 188 },
+  { 0x88fcf317f22241e2ULL, 588, 196 },
+  { 0xcc20ce9bd35c78a5ULL, 614, 204 },
+  { 0x98165af37b2153dfULL, 641, 212 },
+  { 0xe2a0b5dc971f303aULL, 667, 220 },
+  { 0xa8d9d1535ce3b396ULL, 694, 228 },
+  { 0xfb9b7cd9a4a7443cULL, 720, 236 },
+  { 0xbb764c4ca7a44410ULL, 747, 244 },
+  { 0x8bab8eefb6409c1aULL, 774, 252 },
+  { 0xd01fef10a657842cULL, 800, 260 },
+  { 0x9b10a4e5e9913129ULL, 827, 268 },
+  { 0xe7109bfba19c0c9dULL, 853, 276 },
+  { 0xac2820d9623bf429ULL, 880, 284 },
+  { 0x80444b5e7aa7cf85ULL, 907, 292 },
+  { 0xbf21e44003acdd2dULL, 933, 300 },
+  { 0x8e679c2f5e44ff8fULL, 960, 308 },
+  { 0xd433179d9c8cb841ULL, 986, 316 },
+  { 0x9e19db92b4e31ba9ULL, 1013, 324 },
+  { 0xeb96bf6ebadf77d9ULL, 1039, 332 },
+  { 0xaf87023b9bf0ee6bULL, 1066, 340 },
+};
+
+static const __uint32_t pow10_32[] = {
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+  1000000000
+};
+
+static diy_fp
+diy_normalize (__uint64_t f,
+	int e)
+{
+  diy_fp r;
+  int n = __builtin_clzll (f);
+
+  r.f = f << n;
+  r.e = e - n;
+  return r;
+}
+
+/* x * y, rounded to 64 bits.  */
+static diy_fp
+diy_mul (diy_fp x,
+	diy_fp y)
+{
+  diy_fp r;
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 p = (unsigned __int128) x.f * y.f;
+
+  r.f = (__uint64_t) (p >> 64) + ((__uint64_t) p >> 63);
+#else
+  __uint64_t a = x.f >> 32, b = (__uint32_t) x.f;
+  __uint64_t c = y.f >> 32, d = (__uint32_t) y.f;
+  __uint64_t ad = a * d, bc = b * c;
+  __uint64_t t = ((b * d) >> 32) + (__uint32_t) ad + (__uint32_t) bc
+    + ((__uint64_t) 1 << 31);
+
+  r.f = a * c + (ad >> 32) + (bc >> 32) + (t >> 32);
+#endif
+  r.e = x.e + y.e + 64;
+  return r;
+}
+
+/* Round the last digit of buf down as long as that brings it closer to
+   the exact value, given the distance wp_w from the scaled upper bound
+   of d, the interval of width delta around it, and rest, the scaled
+   value still to be accounted for.  All are in units of 2^-kappa, with
+   unit the error of each.  Return whether the result is certain to be
+   the closest shortest one.  */
+static int
+round_weed (char *buf,
+	int len,
+	__uint64_t wp_w,
+	__uint64_t delta,
+	__uint64_t rest,
+	__uint64_t ten_kappa,
+	__uint64_t unit)
+{
+  __uint64_t small_distance = wp_w - unit;
+  __uint64_t big_distance = wp_w + unit;
+
+  while (rest < small_distance
+	 && delta - rest >= ten_kappa
+	 && (rest + ten_kappa < small_distance
+	     || small_distance - rest >= rest + ten_kappa - small_distance))
+    {
+      buf[len - 1]--;
+      rest += ten_kappa;
+    }
+  if (rest < big_distance
+      && delta - rest >= ten_kappa
+      && (rest + ten_kappa < big_distance
+	  || big_distance - rest > rest + ten_kappa - big_distance))
+    return 0;
+  return 2 * unit <= rest && rest <= delta - 4 * unit;
+}
+
+/* Round the len digits in buf, with rest left over out of ten_kappa,
+   either way off by unit.  Return 0 if the direction is not certain.  */
+static int
+round_weed_counted (char *buf,
+	int len,
+	__uint64_t rest,
+	__uint64_t ten_kappa,
+	__uint64_t unit,
+	int *kappa)
+{
+  int i;
+
+  if (unit >= ten_kappa || ten_kappa - unit <= unit)
+    return 0;
+  if (ten_kappa - rest > rest && ten_kappa - 2 * rest >= 2 * unit)
+    return 1;
+  if (rest > unit && ten_kappa - (rest - unit) <= rest - unit)
+    {
+      buf[len - 1]++;
+      for (i = len - 1; i > 0; i--)
+	{
+	  if (buf[i] != '0' + 10)
+	    break;
+	  buf[i] = '0';
+	  buf[i - 1]++;
+	}
+      if (buf[0] == '0' + 10)
+	{
+	  buf[0] = '1';
+	  ++*kappa;
+	}
+      return 1;
+    }
+  return 0;
+}
+
+/* Put the digits of d > 0 for mode 0, 2 or 3 in buf, without a
+   terminating NUL or trailing zeros, and the position of the decimal
+   point in *decpt.  Return the number of digits, or 0 if the exact
+   algorithm has to be used.  */
+static int
+grisu (union double_union d,
+	int mode,
+	int ndigits,
+	char *buf,
+	int *decpt)
+{
+  __uint64_t f, one, fractionals, rest, unit, delta, too_high;
+  __uint32_t integrals, div;
+  diy_fp w, mp, mm, c;
+  int e, kappa, shift, len, i, ok, requested;
+
+  f = (__uint64_t) (word0 (d) & Frac_mask) << 32 | word1 (d);
+  e = (int) (word0 (d) >> Exp_shift1);
+  if (e)
+    {
+      f |= (__uint64_t) 1 << (P - 1);
+      e -= Bias + P - 1;
+    }
+  else
+    e = 1 - Bias - P + 1;
+
+  /* Pick 10^k so that w * 10^k has a binary exponent in [-60, -32]:
+     ceil (x * log10 (2)) is computed exactly for |x| < 1300.  */
+  w = diy_normalize (f, e);
+  i = -60 - (w.e + 64) + 63;
+  i = -(int) ((-(long) i * 78913) >> 18);
+  c.f = cached_powers[(348 + i - 1) / 8 + 1].f;
+  c.e = cached_powers[(348 + i - 1) / 8 + 1].e;
+  i = cached_powers[(348 + i - 1) / 8 + 1].k;
+
+  len = 0;
+  if (mode == 0)
+    {
+      /* The ends of the interval that rounds to d, scaled like w.  */
+      mp = diy_normalize ((f << 1) + 1, e - 1);
+      if (f == (__uint64_t) 1 << (P - 1) && e > 1 - Bias - P + 1)
+	{
+	  mm.f = (f << 2) - 1;
+	  mm.e = e - 2;
+	}
+      else
+	{
+	  mm.f = (f << 1) - 1;
+	  mm.e = e - 1;
+	}
+      mm.f <<= mm.e - mp.e;
+      mm.e = mp.e;
+      w = diy_mul (w, c);
+      mp = diy_mul (mp, c);
+      mm = diy_mul (mm, c);
+
+      /* Generate the digits of the high end, widened by the error of
+	 the products, until they are within the narrowed interval.  */
+      unit = 1;
+      shift = -w.e;
+      one = (__uint64_t) 1 << shift;
+      too_high = mp.f + unit;
+      delta = too_high - (mm.f - unit);
+      integrals = (__uint32_t) (too_high >> shift);
+      fractionals = too_high & (one - 1);
+      for (kappa = 10; pow10_32[kappa - 1] > integrals; kappa--)
+	;
+      div = pow10_32[kappa - 1];
+      while (kappa > 0)
+	{
+	  buf[len++] = '0' + integrals / div;
+	  integrals %= div;
+	  kappa--;
+	  rest = ((__uint64_t) integrals << shift) + fractionals;
+	  if (rest < delta)
+	    {
+	      ok = round_weed (buf, len, too_high - w.f, delta, rest,
+			       (__uint64_t) div << shift, unit);
+	      goto done;
+	    }
+	  div /= 10;
+	}
+      for (;;)
+	{
+	  fractionals *= 10;
+	  unit *= 10;
+	  delta *= 10;
+	  buf[len++] = '0' + (int) (fractionals >> shift);
+	  fractionals &= one - 1;
+	  kappa--;
+	  if (fractionals < delta)
+	    {
+	      ok = round_weed (buf, len, (too_high - w.f) * unit, delta,
+			       fractionals, one, unit);
+	      break;
+	    }
+	}
+    }
+  else
+    {
+      /* Generate the digits of w, off by at most one unit, and round
+	 them if that error allows.  */
+      w = diy_mul (w, c);
+      unit = 1;
+      shift = -w.e;
+      one = (__uint64_t) 1 << shift;
+      integrals = (__uint32_t) (w.f >> shift);
+      fractionals = w.f & (one - 1);
+      for (kappa = 10; pow10_32[kappa - 1] > integrals; kappa--)
+	;
+      requested = mode == 3 ? ndigits + kappa - i : ndigits < 1 ? 1 : ndigits;
+      if (requested <= 0 || requested > 17)
+	return 0;
+      div = pow10_32[kappa - 1];
+      while (kappa > 0)
+	{
+	  buf[len++] = '0' + integrals / div;
+	  integrals %= div;
+	  kappa--;
+	  if (--requested == 0)
+	    break;
+	  div /= 10;
+	}
+      if (requested == 0)
+	ok = round_weed_counted (buf, len,
+				 ((__uint64_t) integrals << shift) + fractionals,
+				 (__uint64_t) div << shift, unit, &kappa);
+      else
+	{
+	  while (requested > 0 && fractionals > unit)
+	    {
+	      fractionals *= 10;
+	      unit *= 10;
+	      buf[len++] = '0' + (int) (fractionals >> shift);
+	      fractionals &= one - 1;
+	      kappa--;
+	      requested--;
+	    }
+	  ok = requested == 0
+	    && round_weed_counted (buf, len, fractionals, one, unit, &kappa);
+	}
+    }
+ done:
+  if (!ok)
+    return 0;
+  *decpt = len + kappa - i;
+  while (len > 1 && buf[len - 1] == '0')
+    len--;
+  return len;
+}
+#endif /* Grisu */
+
+/* Allocate the result buffer, of i bytes.  */
+static char *
+rv_alloc (struct _reent *ptr,
+	int i)
+{
+  int j = sizeof (__ULong);
+
+  for (_REENT_MP_RESULT_K(ptr) = 0; sizeof (_Bigint) - sizeof (__ULong) + j <= i;
+       j <<= 1)
+    _REENT_MP_RESULT_K(ptr)++;
+  _REENT_MP_RESULT(ptr) = eBalloc (ptr, _REENT_MP_RESULT_K(ptr));
+  return (char *) _REENT_MP_RESULT(ptr);
+}
+
 /* dtoa for IEEE arithmetic (dmg): convert double to ASCII string.
  *
  * Inspired by "How to Print Floating-Point Numbers Accurately" by
@@ -289,6 +681,26 @@ _dtoa_r (struct _reent *ptr,
       return s;
     }
 
+#ifdef Grisu
+  if (mode == 0 || mode == 2 || mode == 3)
+    {
+      char buf[20];
+
+      if ((j = grisu (d, mode, ndigits, buf, &k)) != 0)
+	{
+	  /* Leave room for the trailing zeros, as below.  */
+	  i = mode == 0 ? 18 : mode == 2 ? ndigits : ndigits + k;
+	  s0 = rv_alloc (ptr, i > j ? i : j + 1);
+	  memcpy (s0, buf, j);
+	  s0[j] = 0;
+	  *decpt = k;
+	  if (rve)
+	    *rve = s0 + j;
+	  return s0;
+	}
+    }
+#endif
+
   b = d2b (ptr, d.d, &be, &bbits);
 #ifdef Sudden_Underflow
   i = (int) (word0 (d) >> Exp_shift1 & (Exp_mask >> Exp_shift1));
@@ -424,12 +836,7 @@ _dtoa_r (struct _reent *ptr,
       if (i <= 0)
 	i = 1;
     }
-  j = sizeof (__ULong);
-  for (_REENT_MP_RESULT_K(ptr) = 0; sizeof (_Bigint) - sizeof (__ULong) + j <= i;
-       j <<= 1)
-    _REENT_MP_RESULT_K(ptr)++;
-  _REENT_MP_RESULT(ptr) = eBalloc (ptr, _REENT_MP_RESULT_K(ptr));
-  s = s0 = (char *) _REENT_MP_RESULT(ptr);
+  s = s0 = rv_alloc (ptr, i);
 
   if (ilim >= 0 && ilim <= Quick_max && try_quick)
     {
@@ -53,6 +53,7 @@ permit '=' to be in identifiers.
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include "envlock.h"
 
@@ -63,6 +64,9 @@ extern char **environ;
    'environ'.  */
 static char ***p_environ = &environ;
 
+/* The environment generation, see envlock.h.  */
+unsigned int __env_gen;
+
 /*
  * _findenv --
  *	Returns pointer to value associated with name, if any, else NULL.
@@ -111,6 +115,245 @@ _findenv_r (struct _reent *reent_ptr,
   return NULL;
 }
 
+#ifdef _WANT_ENV_INDEX
+
+/*
+ * The environment index: a hash table of the entries of an environ
+ * array by name, which lets _getenv_r find a variable without the env
+ * lock and without scanning environ.
+ *
+ * The first _getenv_r that finds no index for the current environ builds
+ * one under the env lock and publishes it with an atomic pointer store.
+ * An index is never changed once published.  setenv, putenv and unsetenv
+ * drop it (see ENV_CHANGED), and the next _getenv_r builds a new one.
+ * The index holds the entry strings themselves, which are never freed,
+ * not pointers into environ, so a reader holding a dropped index still
+ * sees the environment as it was a moment before.
+ *
+ * Readers count themselves in one of two epochs while they use an
+ * index, in a counter picked from their reentrancy structure, so that
+ * threads with their own reentrancy structures seldom write the same
+ * cache line.  That count is what a lookup still costs over a plain
+ * scan: two atomic adds to a counter usually only its own thread uses,
+ * and a check of the epoch between them.
+ *
+ * A dropped index is kept on the list of the epoch it was dropped in.
+ * Whenever no reader is left in the other epoch, the list of that epoch
+ * is freed and it becomes the current one; new readers only count in
+ * the current epoch, so the other one drains as soon as the readers in
+ * it are done.  A reader held up in the middle of a lookup still keeps
+ * every index dropped since from being freed, so no new index is built
+ * while ENV_DROPPED_MAX of them are waiting; lookups then scan environ
+ * until the lists can be freed.
+ */
+
+#if !defined (__SINGLE_THREAD__) && \
+    !defined (__OPTIMIZE_SIZE__) && !defined (PREFER_SIZE_OVER_SPEED)
+#define ENV_SHARD_BITS 3
+#else
+#define ENV_SHARD_BITS 0
+#endif
+#define ENV_SHARDS (1 << ENV_SHARD_BITS)
+
+#define ENV_DROPPED_MAX 8
+
+struct env_index
+{
+  char **env;			/* The environ array indexed */
+  struct env_index *next;	/* Next on the list of dropped indexes */
+  size_t mask;			/* Number of slots, less 1 */
+  char *slot[1];		/* Entries by hash of their name, or NULL */
+};
+
+/* Readers in each epoch, spread over a cache line per shard.  */
+static struct env_shard
+{
+  unsigned int readers[2];
+} _ATTRIBUTE ((__aligned__ (64))) env_shards[ENV_SHARDS];
+
+static struct env_index *env_index;
+static struct env_index *env_dropped[2];
+static unsigned int env_ndropped;
+static unsigned int env_epoch;
+static int env_building;
+
+static inline struct env_shard *
+env_shard (struct _reent *reent_ptr)
+{
+#if ENV_SHARD_BITS > 0
+  uint32_t h = (uint32_t) ((uintptr_t) reent_ptr >> 4) * 0x9e3779b1U;
+
+  return &env_shards[h >> (32 - ENV_SHARD_BITS)];
+#else
+  return &env_shards[0];
+#endif
+}
+
+/* Hash the name of a variable, up to an '=' or the end of STR, and
+   store its length in *LEN.  */
+static size_t
+env_hash (const char *str,
+	size_t *len)
+{
+  const unsigned char *p = (const unsigned char *) str;
+  size_t h = 2166136261u;
+
+  for (; *p && *p != '='; p++)
+    h = (h ^ *p) * 16777619u;
+  *len = (const char *) p - str;
+  return h;
+}
+
+/* If no reader is left in the other epoch, free the indexes dropped in
+   it and make it the current one.  Called under ENV_LOCK.  */
+static void
+env_reclaim (struct _reent *reent_ptr)
+{
+  struct env_index *old;
+  unsigned int epoch = env_epoch;
+  int i;
+
+  for (i = 0; i < ENV_SHARDS; i++)
+    if (__atomic_load_n (&env_shards[i].readers[!epoch], __ATOMIC_SEQ_CST))
+      return;
+  while ((old = env_dropped[!epoch]) != NULL)
+    {
+      env_dropped[!epoch] = old->next;
+      _free_r (reent_ptr, old);
+      env_ndropped--;
+    }
+  __atomic_store_n (&env_epoch, !epoch, __ATOMIC_SEQ_CST);
+}
+
+/* Replace the published index with NEW, keeping the old one on the list
+   of the current epoch.  Called under ENV_LOCK.  */
+static void
+env_publish (struct _reent *reent_ptr,
+	struct env_index *new)
+{
+  struct env_index *old;
+
+  old = __atomic_exchange_n (&env_index, new, __ATOMIC_SEQ_CST);
+  if (old)
+    {
+      old->next = env_dropped[env_epoch];
+      env_dropped[env_epoch] = old;
+      env_ndropped++;
+    }
+  env_reclaim (reent_ptr);
+}
+
+void
+__env_index_drop (struct _reent *reent_ptr)
+{
+  if (__atomic_load_n (&env_index, __ATOMIC_RELAXED) != NULL)
+    env_publish (reent_ptr, NULL);
+}
+
+/* Build and publish an index of the current environ, unless there is
+   one already or too many dropped ones wait to be freed.  Names without
+   an '=' are left out, as _findenv_r cannot match them, and of several
+   entries with the same name only the first goes in, as that is the one
+   _findenv_r finds.  */
+static void
+env_index_build (struct _reent *reent_ptr)
+{
+  struct env_index *idx;
+  char **env, **p;
+  size_t size, i, len;
+
+  ENV_LOCK;
+
+  env = *p_environ;
+  idx = __atomic_load_n (&env_index, __ATOMIC_RELAXED);
+  /* Building calls malloc, which may look up a variable itself.  */
+  if (env == NULL || env_building || (idx && idx->env == env))
+    {
+      ENV_UNLOCK;
+      return;
+    }
+  /* Freeing the lists of both epochs takes two steps.  */
+  for (i = 0; i < 2 && env_ndropped >= ENV_DROPPED_MAX; i++)
+    env_reclaim (reent_ptr);
+  if (env_ndropped >= ENV_DROPPED_MAX)
+    {
+      ENV_UNLOCK;
+      return;
+    }
+  env_building = 1;
+
+  for (p = env; *p; ++p);
+  for (size = 8; size < 2 * (size_t) (p - env); size <<= 1);
+  idx = (struct env_index *) _malloc_r (reent_ptr, sizeof (struct env_index)
+					+ (size - 1) * sizeof (char *));
+  if (idx)
+    {
+      idx->env = env;
+      idx->mask = size - 1;
+      memset (idx->slot, 0, size * sizeof (char *));
+      for (p = env; *p; ++p)
+	{
+	  i = env_hash (*p, &len) & idx->mask;
+	  if ((*p)[len] != '=')
+	    continue;
+	  while (idx->slot[i] && strncmp (idx->slot[i], *p, len + 1))
+	    i = (i + 1) & idx->mask;
+	  if (!idx->slot[i])
+	    idx->slot[i] = *p;
+	}
+      env_publish (reent_ptr, idx);
+    }
+
+  env_building = 0;
+  ENV_UNLOCK;
+}
+
+/* Look NAME up in the index, without locking, and store its value or
+   NULL in *VALUE.  Returns 0 if there is no index of the current
+   environ.  */
+static int
+env_index_find (struct _reent *reent_ptr,
+	const char *name,
+	char **value)
+{
+  unsigned int *readers = env_shard (reent_ptr)->readers;
+  struct env_index *idx;
+  unsigned int epoch;
+  size_t i, len;
+  char *s;
+  int indexed = 0;
+
+  /* Count in the current epoch.  If it changed before we were counted,
+     env_publish may have missed us; count again.  */
+  for (;;)
+    {
+      epoch = __atomic_load_n (&env_epoch, __ATOMIC_SEQ_CST);
+      __atomic_add_fetch (&readers[epoch], 1, __ATOMIC_SEQ_CST);
+      if (__atomic_load_n (&env_epoch, __ATOMIC_SEQ_CST) == epoch)
+	break;
+      __atomic_sub_fetch (&readers[epoch], 1, __ATOMIC_RELEASE);
+    }
+  idx = __atomic_load_n (&env_index, __ATOMIC_SEQ_CST);
+  if (idx && idx->env == *p_environ)
+    {
+      i = env_hash (name, &len) & idx->mask;
+      *value = NULL;
+      /* Identifiers may not contain an '=', so cannot match if does */
+      if (name[len] != '=')
+	for (; (s = idx->slot[i]) != NULL; i = (i + 1) & idx->mask)
+	  if (!strncmp (s, name, len) && s[len] == '=')
+	    {
+	      *value = s + len + 1;
+	      break;
+	    }
+      indexed = 1;
+    }
+  __atomic_sub_fetch (&readers[epoch], 1, __ATOMIC_RELEASE);
+  return indexed;
+}
+
+#endif /* _WANT_ENV_INDEX */
+
 /*
  * _getenv_r --
  *	Returns ptr to value associated with name, if any, else NULL.
@@ -121,6 +364,15 @@ _getenv_r (struct _reent *reent_ptr,
 	const char *name)
 {
   int offset;
+#ifdef _WANT_ENV_INDEX
+  char *value;
+
+  if (env_index_find (reent_ptr, name, &value))
+    return value;
+  env_index_build (reent_ptr);
+  if (env_index_find (reent_ptr, name, &value))
+    return value;
+#endif
 
   return _findenv_r (reent_ptr, name, &offset);
 }
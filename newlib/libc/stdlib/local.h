@@ -60,4 +60,21 @@ extern wchar_t __cp_conv[][0x80];
 int __cp_val_index (int);
 int __cp_index (const char *);
 
+/*
+ * Define _MB_BULK_CONVERSION to convert strings in the UTF-8 and
+ * single-byte charsets with the kernels in mbsbulk.c rather than one
+ * character at a time.
+ */
+#if defined (_MB_CAPABLE) && !defined (PREFER_SIZE_OVER_SPEED) \
+    && !defined (__OPTIMIZE_SIZE__)
+#  define _MB_BULK_CONVERSION
+#endif
+
+#ifdef _MB_BULK_CONVERSION
+size_t __mbsbulk_r (struct _reent *, wchar_t *, const char **, size_t,
+		    size_t, struct __locale_t *);
+size_t __wcsbulk_r (struct _reent *, char *, const wchar_t **, size_t,
+		    size_t, struct __locale_t *);
+#endif
+
 #endif
@@ -0,0 +1,281 @@
+/*
+FUNCTION
+<<malloc_counters>>, <<malloc_set_event_hook>>, <<malloc_dump_bins>>---malloc instrumentation
+
+INDEX
+	malloc_counters
+INDEX
+	malloc_set_event_hook
+INDEX
+	malloc_set_lock_clock
+INDEX
+	malloc_dump_bins
+INDEX
+	_malloc_counters_r
+INDEX
+	_malloc_dump_bins_r
+
+SYNOPSIS
+	#include <malloc.h>
+	void malloc_counters(struct malloc_counters *<[counters]>);
+	malloc_event_hook_t malloc_set_event_hook(malloc_event_hook_t <[hook]>,
+		void *<[arg]>);
+	void malloc_set_lock_clock(unsigned long (*<[clock]>)(void));
+	void malloc_dump_bins(void);
+
+	void _malloc_counters_r(void *<[reent]>,
+		struct malloc_counters *<[counters]>);
+	void _malloc_dump_bins_r(void *<[reent]>);
+
+DESCRIPTION
+These functions are only available if newlib was configured with
+<<--enable-newlib-malloc-instrument>>.  Without that option none of
+the code below, nor any of the bookkeeping in <<malloc>>, <<free>> and
+<<__malloc_lock>>, is compiled.
+
+<<malloc_counters>> copies the allocation counters into the structure
+pointed to by <[counters]>.  <<allocs>>[<[n]>] and <<frees>>[<[n]>]
+count the blocks allocated and freed whose usable size (see
+<<malloc_usable_size>>) is in the size class <[n]>: class 0 holds
+blocks of at most one byte, and class <[n]> blocks of 2**(<[n]>-1)+1
+to 2**<[n]> bytes.  The last class also holds all bigger blocks.
+These counters are kept without taking the malloc lock.
+
+<<lock_acquires>> counts the outermost calls of <<__malloc_lock>>, and
+<<lock_contended>> those among them which found the lock held on behalf
+of another reentrancy structure, normally another thread.  If a clock
+was set with <<malloc_set_lock_clock>>, <<lock_hold_total>> and
+<<lock_hold_max>> are the total and the longest time the lock was held,
+in units of that clock.  The lock counters are only kept by the
+<<__malloc_lock>> and <<__malloc_unlock>> provided by the library.
+
+<<malloc_set_event_hook>> registers <[hook]> to be called after every
+allocation and every free with <<MALLOC_EVENT_ALLOC>> or
+<<MALLOC_EVENT_FREE>>, the address and the usable size of the block,
+and <[arg]>.  A <<realloc>> is reported as the free of the old block
+followed by the allocation of the new one.  The hook is called without
+the malloc lock held, but must not allocate or free memory itself.
+Pass a null <[hook]> to stop the calls.
+
+<<malloc_dump_bins>> prints, for each list of free blocks kept by
+<<malloc>>, the number of blocks and the number of bytes on it on
+standard error.
+
+The alternate functions <<_malloc_counters_r>> and
+<<_malloc_dump_bins_r>> are reentrant versions.  The extra argument
+<[reent]> is a pointer to a reentrancy structure.
+
+RETURNS
+<<malloc_set_event_hook>> returns the hook previously registered, or
+<<NULL>>.
+
+PORTABILITY
+These functions are not portable.
+*/
+
+#include <_ansi.h>
+#include <reent.h>
+#include <stdlib.h>
+#include <malloc.h>
+
+/* VxWorks provides its own version of malloc, and we can't use this
+   one because VxWorks does not provide sbrk.  So we have a hook to
+   not compile this code.  */
+
+#if defined (_MALLOC_INSTRUMENT) && !defined (MALLOC_PROVIDED)
+
+/* The allocator provides the real routines under these names when
+   instrumentation is enabled; the public entry points below wrap them.  */
+extern void *__malloc_raw_malloc_r (struct _reent *, size_t);
+extern void __malloc_raw_free_r (struct _reent *, void *);
+extern void *__malloc_raw_realloc_r (struct _reent *, void *, size_t);
+extern void *__malloc_raw_calloc_r (struct _reent *, size_t, size_t);
+extern void *__malloc_raw_memalign_r (struct _reent *, size_t, size_t);
+extern void *__malloc_raw_valloc_r (struct _reent *, size_t);
+extern void *__malloc_raw_pvalloc_r (struct _reent *, size_t);
+
+struct malloc_counters __malloc_counters;
+malloc_event_hook_t __malloc_event_hook;
+void *__malloc_event_arg;
+unsigned long (*__malloc_lock_clock) (void);
+
+/* The counters are bumped without the malloc lock, so that calls which
+   do not otherwise take it, such as those served from the thread cache
+   of _MALLOC_TCACHE, do not serialize on it just to be counted.  */
+
+#ifdef __SINGLE_THREAD__
+#define bump(counter) ((counter)++)
+#define peek(counter) (counter)
+#else
+#define bump(counter) __atomic_fetch_add (&(counter), 1, __ATOMIC_RELAXED)
+#define peek(counter) __atomic_load_n (&(counter), __ATOMIC_RELAXED)
+#endif
+
+/* Count and report an event for the block MEM of SIZE usable bytes.  */
+
+static void
+note_event (int event,
+	void *mem,
+	size_t size)
+{
+  malloc_event_hook_t hook = __malloc_event_hook;
+  size_t n;
+  int class;
+
+  for (class = 0, n = size > 0 ? size - 1 : 0; n != 0; n >>= 1)
+    class++;
+  if (class >= MALLOC_HISTOGRAM_CLASSES)
+    class = MALLOC_HISTOGRAM_CLASSES - 1;
+
+  if (event == MALLOC_EVENT_ALLOC)
+    bump (__malloc_counters.allocs[class]);
+  else
+    bump (__malloc_counters.frees[class]);
+
+  if (hook != NULL)
+    (*hook) (event, mem, size, __malloc_event_arg);
+}
+
+/* Common part of the routines returning a new block.  */
+
+static void *
+new_block (struct _reent *ptr,
+	void *mem)
+{
+  if (mem != NULL)
+    note_event (MALLOC_EVENT_ALLOC, mem, _malloc_usable_size_r (ptr, mem));
+  return mem;
+}
+
+void *
+_malloc_r (struct _reent *ptr,
+	size_t bytes)
+{
+  return new_block (ptr, __malloc_raw_malloc_r (ptr, bytes));
+}
+
+void *
+_calloc_r (struct _reent *ptr,
+	size_t n,
+	size_t elem)
+{
+  return new_block (ptr, __malloc_raw_calloc_r (ptr, n, elem));
+}
+
+void *
+_memalign_r (struct _reent *ptr,
+	size_t align,
+	size_t bytes)
+{
+  return new_block (ptr, __malloc_raw_memalign_r (ptr, align, bytes));
+}
+
+void *
+_valloc_r (struct _reent *ptr,
+	size_t bytes)
+{
+  return new_block (ptr, __malloc_raw_valloc_r (ptr, bytes));
+}
+
+void *
+_pvalloc_r (struct _reent *ptr,
+	size_t bytes)
+{
+  return new_block (ptr, __malloc_raw_pvalloc_r (ptr, bytes));
+}
+
+void
+_free_r (struct _reent *ptr,
+	void *mem)
+{
+  size_t size;
+
+  if (mem == NULL)
+    return;
+
+  /* The block is still the caller's, so its size can be read before it
+     is freed without holding the lock.  */
+  size = _malloc_usable_size_r (ptr, mem);
+  __malloc_raw_free_r (ptr, mem);
+  note_event (MALLOC_EVENT_FREE, mem, size);
+}
+
+void *
+_realloc_r (struct _reent *ptr,
+	void *mem,
+	size_t bytes)
+{
+  size_t old_size = 0;
+  void *new_mem;
+
+  if (mem != NULL)
+    old_size = _malloc_usable_size_r (ptr, mem);
+  new_mem = __malloc_raw_realloc_r (ptr, mem, bytes);
+
+  /* The old block is gone if a new one was returned, or if it was
+     freed because BYTES is zero.  */
+  if (mem != NULL && (new_mem != NULL || bytes == 0))
+    note_event (MALLOC_EVENT_FREE, mem, old_size);
+  return new_block (ptr, new_mem);
+}
+
+void
+_malloc_counters_r (struct _reent *ptr,
+	struct malloc_counters *counters)
+{
+  int i;
+
+  /* The lock counters are only updated with the lock held.  */
+  __malloc_lock (ptr);
+  counters->lock_acquires = __malloc_counters.lock_acquires;
+  counters->lock_contended = __malloc_counters.lock_contended;
+  counters->lock_hold_total = __malloc_counters.lock_hold_total;
+  counters->lock_hold_max = __malloc_counters.lock_hold_max;
+  __malloc_unlock (ptr);
+
+  for (i = 0; i < MALLOC_HISTOGRAM_CLASSES; i++)
+    {
+      counters->allocs[i] = peek (__malloc_counters.allocs[i]);
+      counters->frees[i] = peek (__malloc_counters.frees[i]);
+    }
+}
+
+malloc_event_hook_t
+malloc_set_event_hook (malloc_event_hook_t hook,
+	void *arg)
+{
+  malloc_event_hook_t old;
+
+  __malloc_lock (_REENT);
+  old = __malloc_event_hook;
+  __malloc_event_hook = hook;
+  __malloc_event_arg = arg;
+  __malloc_unlock (_REENT);
+  return old;
+}
+
+void
+malloc_set_lock_clock (unsigned long (*clock) (void))
+{
+  __malloc_lock (_REENT);
+  __malloc_lock_clock = clock;
+  __malloc_unlock (_REENT);
+}
+
+#ifndef _REENT_ONLY
+
+void
+malloc_counters (struct malloc_counters *counters)
+{
+  _malloc_counters_r (_REENT, counters);
+}
+
+void
+malloc_dump_bins (void)
+{
+  _malloc_dump_bins_r (_REENT);
+}
+
+#endif /* !_REENT_ONLY */
+
+#endif /* _MALLOC_INSTRUMENT && !MALLOC_PROVIDED */
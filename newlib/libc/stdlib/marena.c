@@ -0,0 +1,278 @@
+/* VxWorks provides its own version of malloc, and we can't use this
+   one because VxWorks does not provide sbrk.  So we have a hook to
+   not compile this code.  */
+
+#ifdef MALLOC_PROVIDED
+
+int _dummy_marena = 1;
+
+#else
+
+/*
+FUNCTION
+<<marena_create>>, <<marena_alloc>>, <<marena_reset>>, <<marena_destroy>>---allocate memory from an arena
+
+INDEX
+	marena_create
+INDEX
+	marena_alloc
+INDEX
+	marena_reset
+INDEX
+	marena_destroy
+INDEX
+	marena_mallinfo
+INDEX
+	_marena_create_r
+INDEX
+	_marena_alloc_r
+INDEX
+	_marena_destroy_r
+
+SYNOPSIS
+	#include <malloc.h>
+	struct marena *marena_create(size_t <[blocksize]>);
+	void *marena_alloc(struct marena *<[arena]>, size_t <[nbytes]>);
+	void marena_reset(struct marena *<[arena]>);
+	void marena_destroy(struct marena *<[arena]>);
+	struct mallinfo marena_mallinfo(struct marena *<[arena]>);
+
+	struct marena *_marena_create_r(void *<[reent]>, size_t <[blocksize]>);
+	void *_marena_alloc_r(void *<[reent]>, struct marena *<[arena]>,
+		size_t <[nbytes]>);
+	void _marena_destroy_r(void *<[reent]>, struct marena *<[arena]>);
+
+DESCRIPTION
+An arena is a pool of memory from which many objects can be allocated
+cheaply and then released all at once.
+
+<<marena_create>> creates an empty arena.  The arena obtains memory
+from <<malloc>> in blocks of at least <[blocksize]> bytes; if
+<[blocksize]> is zero, a default size is used.
+
+<<marena_alloc>> returns a pointer to <[nbytes]> bytes of memory from
+<[arena]>, aligned suitably for any kind of object.  Most requests are
+served by advancing a pointer in the current block; a new block is
+only obtained when the current one is exhausted.  Memory returned by
+<<marena_alloc>> must not be passed to <<free>> or <<realloc>>.
+
+<<marena_reset>> releases all the memory allocated from <[arena]> in
+constant time.  The blocks are kept by the arena and reused by later
+calls to <<marena_alloc>>.
+
+<<marena_destroy>> releases all the memory allocated from <[arena]>
+and returns its blocks to <<malloc>>.  <[arena]> must not be used
+afterwards.
+
+<<marena_mallinfo>> describes <[arena]> in a <<struct mallinfo>>:
+<<arena>> is the total size of its blocks; <<ordblks>> is the number of
+blocks; <<uordblks>> is the space in use, including the bookkeeping of
+the arena; <<fordblks>> is the space not in use.  The blocks of every
+arena are also counted as allocated space by <<mallinfo>>.
+
+The alternate functions <<_marena_create_r>>, <<_marena_alloc_r>> and
+<<_marena_destroy_r>> are reentrant versions.  The extra argument
+<[reent]> is a pointer to a reentrancy structure.
+
+An arena is not locked; if several threads use the same arena they
+must serialize the calls themselves.
+
+RETURNS
+<<marena_create>> returns a pointer to the new arena, or <<NULL>> if
+not enough memory is available.
+
+<<marena_alloc>> returns a pointer to the allocated space, or <<NULL>>
+if not enough memory is available.
+
+PORTABILITY
+The arena functions are not portable.
+
+Supporting OS subroutines required: <<sbrk>>.
+*/
+
+#include <_ansi.h>
+#include <reent.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <malloc.h>
+#include <errno.h>
+
+/* Alignment of the memory handed out by an arena.  */
+struct _marena_align_test
+{
+  char c;
+  union { long long ll; long double ld; void *p; } u;
+};
+#define MARENA_ALIGN (offsetof (struct _marena_align_test, u))
+#define MARENA_ROUND(n) (((n) + MARENA_ALIGN - 1) & ~(MARENA_ALIGN - 1))
+
+#define MARENA_DEFAULT_BLOCKSIZE 4096
+
+struct _marena_block
+{
+  struct _marena_block *next;	/* next block of the arena */
+  size_t size;			/* size of the block, header included */
+};
+
+#define MARENA_BLOCK_HEADER MARENA_ROUND (sizeof (struct _marena_block))
+
+struct marena
+{
+  struct _marena_block *first;	/* block holding this structure */
+  struct _marena_block *cur;	/* block being allocated from */
+  char *ptr;			/* next free byte in cur */
+  char *end;			/* end of cur */
+  size_t blocksize;		/* minimal size of a block */
+  size_t nblocks;		/* number of blocks */
+  size_t total;			/* total size of the blocks */
+  size_t used;			/* space handed out since the last reset */
+};
+
+#define MARENA_HEADER \
+  (MARENA_BLOCK_HEADER + MARENA_ROUND (sizeof (struct marena)))
+
+struct marena *
+_marena_create_r (struct _reent *ptr,
+	size_t blocksize)
+{
+  struct _marena_block *b;
+  struct marena *a;
+
+  if (blocksize == 0)
+    blocksize = MARENA_DEFAULT_BLOCKSIZE;
+  if (blocksize > SIZE_MAX - MARENA_HEADER)
+    {
+      _REENT_ERRNO (ptr) = ENOMEM;
+      return NULL;
+    }
+  blocksize = MARENA_ROUND (blocksize);
+
+  b = (struct _marena_block *) _malloc_r (ptr, MARENA_HEADER + blocksize);
+  if (b == NULL)
+    return NULL;
+  b->next = NULL;
+  b->size = MARENA_HEADER + blocksize;
+
+  a = (struct marena *) ((char *) b + MARENA_BLOCK_HEADER);
+  a->first = a->cur = b;
+  a->ptr = (char *) b + MARENA_HEADER;
+  a->end = (char *) b + b->size;
+  a->blocksize = blocksize;
+  a->nblocks = 1;
+  a->total = b->size;
+  a->used = 0;
+  return a;
+}
+
+void *
+_marena_alloc_r (struct _reent *ptr,
+	struct marena *a,
+	size_t nbytes)
+{
+  struct _marena_block *b;
+  size_t size;
+  char *p;
+
+  if (nbytes > SIZE_MAX - MARENA_BLOCK_HEADER - MARENA_ALIGN)
+    {
+      _REENT_ERRNO (ptr) = ENOMEM;
+      return NULL;
+    }
+  nbytes = MARENA_ROUND (nbytes);
+
+  if (nbytes > (size_t) (a->end - a->ptr))
+    {
+      /* The current block is full.  Go on with the next one if it was
+	 kept by marena_reset and is big enough, otherwise insert a new
+	 block after the current one.  */
+      b = a->cur->next;
+      if (b == NULL || b->size - MARENA_BLOCK_HEADER < nbytes)
+	{
+	  size = MARENA_BLOCK_HEADER
+		 + (nbytes > a->blocksize ? nbytes : a->blocksize);
+	  b = (struct _marena_block *) _malloc_r (ptr, size);
+	  if (b == NULL)
+	    return NULL;
+	  b->next = a->cur->next;
+	  b->size = size;
+	  a->cur->next = b;
+	  a->nblocks++;
+	  a->total += size;
+	}
+      a->cur = b;
+      a->ptr = (char *) b + MARENA_BLOCK_HEADER;
+      a->end = (char *) b + b->size;
+    }
+
+  p = a->ptr;
+  a->ptr += nbytes;
+  a->used += nbytes;
+  return p;
+}
+
+void
+marena_reset (struct marena *a)
+{
+  a->cur = a->first;
+  a->ptr = (char *) a->first + MARENA_HEADER;
+  a->end = (char *) a->first + a->first->size;
+  a->used = 0;
+}
+
+void
+_marena_destroy_r (struct _reent *ptr,
+	struct marena *a)
+{
+  struct _marena_block *b, *next;
+
+  if (a == NULL)
+    return;
+
+  /* The first block holds the arena itself, so free it last.  */
+  for (b = a->first->next; b != NULL; b = next)
+    {
+      next = b->next;
+      _free_r (ptr, b);
+    }
+  _free_r (ptr, a->first);
+}
+
+struct mallinfo
+marena_mallinfo (struct marena *a)
+{
+  struct mallinfo mi = { 0 };
+  size_t overhead;
+
+  overhead = MARENA_HEADER + (a->nblocks - 1) * MARENA_BLOCK_HEADER;
+  mi.arena = a->total;
+  mi.ordblks = a->nblocks;
+  mi.uordblks = a->used + overhead;
+  mi.fordblks = a->total - mi.uordblks;
+  return mi;
+}
+
+#ifndef _REENT_ONLY
+
+struct marena *
+marena_create (size_t blocksize)
+{
+  return _marena_create_r (_REENT, blocksize);
+}
+
+void *
+marena_alloc (struct marena *a,
+	size_t nbytes)
+{
+  return _marena_alloc_r (_REENT, a, nbytes);
+}
+
+void
+marena_destroy (struct marena *a)
+{
+  _marena_destroy_r (_REENT, a);
+}
+
+#endif /* !_REENT_ONLY */
+
+#endif /* ! defined (MALLOC_PROVIDED) */
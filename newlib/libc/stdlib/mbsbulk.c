@@ -0,0 +1,301 @@
+/*
+ * ====================================================
+ * Permission to use, copy, modify, and distribute this
+ * software is freely granted, provided that this notice
+ * is preserved.
+ * ====================================================
+ */
+/* No user fns here. */
+
+#include <_ansi.h>
+#include <wchar.h>
+#include <string.h>
+#include "local.h"
+
+#ifdef _MB_BULK_CONVERSION
+
+/*
+ * Whole-string conversion kernels for mbstowcs, mbsnrtowcs, wcstombs,
+ * wcsnrtombs and the functions built on them.
+ *
+ * A kernel converts only characters it can be sure of, in the UTF-8 and
+ * single-byte charsets, from the initial conversion state.  It stops at
+ * the terminating null character and at anything else, such as invalid
+ * or truncated sequences, leaving that to the locale's per-character
+ * mbtowc or wctomb function, which handles it exactly as it always did.
+ * UTF-16 surrogates only stop the wide-to-multibyte kernel; the UTF-8
+ * decoder accepts ED A0..ED BF sequences as surrogates, exactly as
+ * __utf8_mbtowc does.
+ *
+ * Runs of ASCII characters, common in all kinds of text, are found a
+ * machine word at a time and widened without decoding.
+ */
+
+#define LBLOCKSIZE   (sizeof (long))
+#define UNALIGNED(X) ((long)X & (LBLOCKSIZE - 1))
+
+#define ONES	(~0UL / 0xff)
+#define HIGHS	(ONES << 7)
+
+/* Nonzero if X (an unsigned long) contains a null byte. */
+#define DETECTNULL(X) (((X) - ONES) & ~(X) & HIGHS)
+
+/* Charsets known to the kernels */
+#define BULK_NONE	0
+#define BULK_ASCII	1	/* Single-byte, the same as ASCII below 0x80 */
+#define BULK_LATIN1	2	/* Single-byte, the same as Unicode below 0x100 */
+#define BULK_UTF8	3
+
+static int
+mbs_form (struct __locale_t *loc)
+{
+  if (loc->mbtowc == __utf8_mbtowc)
+    return BULK_UTF8;
+  if (__locale_mb_cur_max_l (loc) != 1)
+    return BULK_NONE;
+#ifndef __CYGWIN__
+  if (loc->mbtowc == __ascii_mbtowc)
+    return BULK_LATIN1;
+#endif
+#ifdef _MB_EXTENDED_CHARSETS_ISO
+  if (loc->mbtowc == __iso_mbtowc (1))
+    return BULK_LATIN1;
+#endif
+  return BULK_ASCII;
+}
+
+static int
+wcs_form (struct __locale_t *loc)
+{
+  if (loc->wctomb == __utf8_wctomb)
+    return BULK_UTF8;
+  if (__locale_mb_cur_max_l (loc) != 1)
+    return BULK_NONE;
+#ifndef __CYGWIN__
+  if (loc->wctomb == __ascii_wctomb)
+    return BULK_LATIN1;
+#endif
+#ifdef _MB_EXTENDED_CHARSETS_ISO
+  if (loc->wctomb == __iso_wctomb (1))
+    return BULK_LATIN1;
+#endif
+  return BULK_ASCII;
+}
+
+#define CONT(c) (((c) & 0xc0) == 0x80)
+
+/*
+ * Decode the UTF-8 sequence of two to four bytes at S, with N bytes
+ * available.  Returns its length, or 0 if it is invalid or truncated,
+ * or needs more than one wchar_t.  The checks are those of
+ * __utf8_mbtowc.
+ */
+static __inline int
+utf8_decode (const unsigned char *s,
+	size_t n,
+	wchar_t *pwc)
+{
+  unsigned int c = s[0];
+
+  if (c >= 0xc2 && c <= 0xdf)
+    {
+      if (n < 2 || !CONT (s[1]))
+	return 0;
+      *pwc = (wchar_t)((c & 0x1f) << 6) | (wchar_t)(s[1] & 0x3f);
+      return 2;
+    }
+  if (c >= 0xe0 && c <= 0xef)
+    {
+      if (n < 3 || !CONT (s[1]) || (c == 0xe0 && s[1] < 0xa0)
+	  || !CONT (s[2]))
+	return 0;
+      *pwc = (wchar_t)((c & 0x0f) << 12) | (wchar_t)((s[1] & 0x3f) << 6)
+	|    (wchar_t)(s[2] & 0x3f);
+      return 3;
+    }
+  if (sizeof (wchar_t) == 4 && c >= 0xf0 && c <= 0xf4)
+    {
+      if (n < 4 || !CONT (s[1]) || (c == 0xf0 && s[1] < 0x90)
+	  || (c == 0xf4 && s[1] >= 0x90) || !CONT (s[2]) || !CONT (s[3]))
+	return 0;
+      *pwc = (wchar_t)((wint_t)(c & 0x07) << 18)
+	|    (wchar_t)((wint_t)(s[1] & 0x3f) << 12)
+	|    (wchar_t)((s[2] & 0x3f) << 6) | (wchar_t)(s[3] & 0x3f);
+      return 4;
+    }
+  return 0;
+}
+
+/*
+ * Convert characters of the multibyte string *SRC, at most NMS bytes of
+ * it, to at most LEN wide characters stored at DST, or just count them
+ * if DST is NULL.  *SRC is advanced past the characters converted, and
+ * their number returned.  The conversion state must be the initial one;
+ * it is left so.
+ */
+size_t
+__mbsbulk_r (struct _reent *r,
+	wchar_t *dst,
+	const char **src,
+	size_t nms,
+	size_t len,
+	struct __locale_t *loc)
+{
+  const unsigned char *s = (const unsigned char *) *src;
+  int form = mbs_form (loc);
+  unsigned long mask = form == BULK_LATIN1 ? 0 : HIGHS;
+  size_t n = 0;
+  size_t i;
+
+  if (form == BULK_NONE)
+    return 0;
+  while (n < len && nms > 0)
+    {
+      wchar_t wc;
+      int bytes;
+
+      if (!UNALIGNED (s) && nms >= LBLOCKSIZE && len - n >= LBLOCKSIZE)
+	{
+	  unsigned long w = *(const unsigned long *) s;
+
+	  if (!(DETECTNULL (w) | (w & mask)))
+	    {
+	      if (dst)
+		for (i = 0; i < LBLOCKSIZE; i++)
+		  dst[n + i] = s[i];
+	      s += LBLOCKSIZE;
+	      nms -= LBLOCKSIZE;
+	      n += LBLOCKSIZE;
+	      continue;
+	    }
+	}
+
+      if (*s == '\0')
+	break;
+      if (*s < 0x80 || form == BULK_LATIN1)
+	{
+	  wc = *s;
+	  bytes = 1;
+	}
+      else if (form == BULK_UTF8)
+	{
+	  bytes = utf8_decode (s, nms, &wc);
+	  if (bytes == 0)
+	    break;
+	}
+      else
+	{
+	  mbstate_t state;
+
+	  memset (&state, 0, sizeof (state));
+	  bytes = loc->mbtowc (r, &wc, (const char *) s, 1, &state);
+	  if (bytes != 1)
+	    break;
+	}
+      if (dst)
+	dst[n] = wc;
+      s += bytes;
+      nms -= bytes;
+      ++n;
+    }
+  *src = (const char *) s;
+  return n;
+}
+
+/*
+ * Convert at most NWC characters of the wide-character string *SRC to
+ * at most LEN bytes stored at DST, or just count the bytes if DST is
+ * NULL.  Only whole characters are stored.  *SRC is advanced past the
+ * characters converted, and the number of bytes returned.  The
+ * conversion state must be the initial one; it is left so.
+ */
+size_t
+__wcsbulk_r (struct _reent *r,
+	char *dst,
+	const wchar_t **src,
+	size_t nwc,
+	size_t len,
+	struct __locale_t *loc)
+{
+  const wchar_t *s = *src;
+  int form = wcs_form (loc);
+  size_t n = 0;
+
+  if (form == BULK_NONE)
+    return 0;
+  while (nwc > 0 && n < len)
+    {
+      wint_t wc = *s;
+      int bytes;
+
+      if (wc - 1 < 0x7f)
+	{
+	  if (dst)
+	    dst[n] = (char) wc;
+	  ++n;
+	  ++s;
+	  --nwc;
+	  continue;
+	}
+
+      if (wc == 0)
+	break;
+      if (form == BULK_UTF8)
+	{
+	  if (wc <= 0x7ff)
+	    bytes = 2;
+	  else if (wc <= 0xffff)
+	    bytes = (wc >= 0xd800 && wc <= 0xdfff) ? 0 : 3;
+	  else
+	    bytes = (wc <= 0x10ffff) ? 4 : 0;
+	  if (bytes == 0 || len - n < (size_t) bytes)
+	    break;
+	  if (dst)
+	    switch (bytes)
+	      {
+	      case 2:
+		dst[n]     = 0xc0 | ((wc & 0x7c0) >> 6);
+		dst[n + 1] = 0x80 |  (wc &  0x3f);
+		break;
+	      case 3:
+		dst[n]     = 0xe0 | ((wc & 0xf000) >> 12);
+		dst[n + 1] = 0x80 | ((wc &  0xfc0) >> 6);
+		dst[n + 2] = 0x80 |  (wc &   0x3f);
+		break;
+	      default:
+		dst[n]     = 0xf0 | ((wc & 0x1c0000) >> 18);
+		dst[n + 1] = 0x80 | ((wc &  0x3f000) >> 12);
+		dst[n + 2] = 0x80 | ((wc &    0xfc0) >> 6);
+		dst[n + 3] = 0x80 |  (wc &     0x3f);
+		break;
+	      }
+	}
+      else if (form == BULK_LATIN1)
+	{
+	  if (wc >= 0x100)
+	    break;
+	  bytes = 1;
+	  if (dst)
+	    dst[n] = (char) wc;
+	}
+      else
+	{
+	  mbstate_t state;
+	  char buf[8];
+
+	  memset (&state, 0, sizeof (state));
+	  bytes = loc->wctomb (r, buf, (wchar_t) wc, &state);
+	  if (bytes != 1)
+	    break;
+	  if (dst)
+	    dst[n] = buf[0];
+	}
+      n += bytes;
+      ++s;
+      --nwc;
+    }
+  *src = s;
+  return n;
+}
+
+#endif /* _MB_BULK_CONVERSION */
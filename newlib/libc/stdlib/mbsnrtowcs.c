@@ -69,6 +69,7 @@ PORTABILITY
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
+#include "local.h"
 
 #ifdef _REENT_THREAD_LOCAL
 _Thread_local _mbstate_t _tls_mbsrtowcs_state;
@@ -108,6 +109,20 @@ _mbsnrtowcs_r (struct _reent *r,
   max = len;
   while (len > 0)
     {
+#ifdef _MB_BULK_CONVERSION
+      if (ps->__count == 0)
+	{
+	  const char *start = *src;
+	  size_t n = __mbsbulk_r (r, ptr, src, nms, len,
+				  __get_current_locale ());
+	  nms -= *src - start;
+	  count += n;
+	  ptr = (dst == NULL) ? NULL : ptr + n;
+	  len -= n;
+	  if (len == 0)
+	    break;
+	}
+#endif
       bytes = _mbrtowc_r (r, ptr, *src, nms, ps);
       if (bytes > 0)
 	{
@@ -36,19 +36,60 @@ that it already holds.
 __LOCK_INIT_RECURSIVE(static, __malloc_recursive_mutex);
 #endif
 
+#ifdef _MALLOC_INSTRUMENT
+/* Lock statistics, see mallinstr.c.  Apart from __malloc_lock_owner,
+   which is peeked at before acquiring the lock, these are only touched
+   with the lock held.  */
+extern unsigned long (*__malloc_lock_clock) (void);
+static int __malloc_lock_depth;
+static struct _reent *volatile __malloc_lock_owner;
+static unsigned long (*__malloc_lock_timer) (void);
+static unsigned long __malloc_lock_start;
+#endif
+
 void
 __malloc_lock (ptr)
      struct _reent *ptr;
 {
+#ifdef _MALLOC_INSTRUMENT
+  struct _reent *owner = __malloc_lock_owner;
+#endif
 #ifndef __SINGLE_THREAD__
   __lock_acquire_recursive (__malloc_recursive_mutex);
 #endif
+#ifdef _MALLOC_INSTRUMENT
+  if (__malloc_lock_depth++ == 0)
+    {
+      __malloc_counters.lock_acquires++;
+      if (owner != NULL && owner != ptr)
+	__malloc_counters.lock_contended++;
+      __malloc_lock_owner = ptr;
+      __malloc_lock_timer = __malloc_lock_clock;
+      if (__malloc_lock_timer != NULL)
+	__malloc_lock_start = (*__malloc_lock_timer) ();
+    }
+#endif
 }
 
 void
 __malloc_unlock (ptr)
      struct _reent *ptr;
 {
+#ifdef _MALLOC_INSTRUMENT
+  unsigned long held;
+
+  if (--__malloc_lock_depth == 0)
+    {
+      __malloc_lock_owner = NULL;
+      if (__malloc_lock_timer != NULL)
+	{
+	  held = (*__malloc_lock_timer) () - __malloc_lock_start;
+	  __malloc_counters.lock_hold_total += held;
+	  if (held > __malloc_counters.lock_hold_max)
+	    __malloc_counters.lock_hold_max = held;
+	}
+    }
+#endif
 #ifndef __SINGLE_THREAD__
   __lock_release_recursive (__malloc_recursive_mutex);
 #endif
@@ -66,6 +66,17 @@
 
 #define RERRNO reent_ptr->_errno
 
+#ifdef _MALLOC_INSTRUMENT
+/* The public entry points are in mallinstr.c; they count and report
+   each call and call these.  */
+#define nano_malloc		__malloc_raw_malloc_r
+#define nano_free		__malloc_raw_free_r
+#define nano_realloc		__malloc_raw_realloc_r
+#define nano_memalign		__malloc_raw_memalign_r
+#define nano_valloc		__malloc_raw_valloc_r
+#define nano_pvalloc		__malloc_raw_pvalloc_r
+#define nano_calloc		__malloc_raw_calloc_r
+#else
 #define nano_malloc		_malloc_r
 #define nano_free		_free_r
 #define nano_realloc		_realloc_r
@@ -73,9 +84,11 @@
 #define nano_valloc		_valloc_r
 #define nano_pvalloc		_pvalloc_r
 #define nano_calloc		_calloc_r
+#endif
 #define nano_cfree		_cfree_r
 #define nano_malloc_usable_size _malloc_usable_size_r
 #define nano_malloc_stats	_malloc_stats_r
+#define nano_malloc_dump_bins	_malloc_dump_bins_r
 #define nano_mallinfo		_mallinfo_r
 #define nano_mallopt		_mallopt_r
 
@@ -99,12 +112,15 @@
 #define nano_cfree		cfree
 #define nano_malloc_usable_size malloc_usable_size
 #define nano_malloc_stats	malloc_stats
+#define nano_malloc_dump_bins	malloc_dump_bins
 #define nano_mallinfo		mallinfo
 #define nano_mallopt		mallopt
 #endif /* ! _LIBC */
 
 /* Redefine names to avoid conflict with user names */
-#define free_list __malloc_free_list
+#define free_bins __malloc_free_bins
+#define free_map __malloc_free_map
+#define heap_fence __malloc_heap_fence
 #define sbrk_start __malloc_sbrk_start
 #define current_mallinfo __malloc_current_mallinfo
 
@@ -118,9 +134,6 @@
 #define CHUNK_ALIGN (sizeof(void*))
 #define MALLOC_PADDING ((MAX(MALLOC_ALIGN, CHUNK_ALIGN)) - CHUNK_ALIGN)
 
-/* as well as the minimal allocation size
- * to hold a free pointer */
-#define MALLOC_MINSIZE (sizeof(void *))
 #define MALLOC_PAGE_ALIGN (0x1000)
 #define MAX_ALLOC_SIZE (0x80000000U)
 
@@ -129,7 +142,7 @@ typedef size_t malloc_size_t;
 typedef struct malloc_chunk
 {
     /*          --------------------------------------
-     *   chunk->| size                               |
+     *   chunk->| size                    | PREV_FREE|
      *          --------------------------------------
      *          | Padding for alignment              |
      *          | This includes padding inserted by  |
@@ -143,27 +156,58 @@ typedef struct malloc_chunk
      *          | offset to size.                    |
      *          --------------------------------------
      * mem_ptr->| When allocated: data               |
-     *          | When freed: pointer to next free   |
-     *          | chunk                              |
+     *          | When freed: pointers to next and   |
+     *          | previous free chunk of the same    |
+     *          | size class, ...                    |
+     *          --------------------------------------
+     *          | ... and a copy of size in the last |
+     *          | sizeof (size) bytes of the chunk   |
      *          --------------------------------------
      */
     /* size of the allocated payload area, including size before
-       CHUNK_OFFSET */
+       CHUNK_OFFSET.  Bit 0 is set if the chunk just below this one in
+       memory is free.  */
     long size;
 
-    /* since here, the memory is either the next free block, or data load */
+    /* since here, the memory is either the free list links, or data load */
     struct malloc_chunk * next;
+    struct malloc_chunk * prev;
 }chunk;
 
 
 #define CHUNK_OFFSET ((malloc_size_t)(&(((struct malloc_chunk *)0)->next)))
 
+#define PREV_FREE (1L)
+#define CHUNK_SIZE(c) ((malloc_size_t)((c)->size & ~PREV_FREE))
+#define NEXT_CHUNK(c) ((chunk *)((char *)(c) + CHUNK_SIZE(c)))
+#define PREV_SIZE(c) ((malloc_size_t)((long *)(c))[-1])
+
+/* as well as the minimal allocation size
+ * to hold the free list pointers and the trailing size */
+#define MALLOC_MINSIZE \
+    ALIGN_SIZE(sizeof(chunk) + sizeof(long) - CHUNK_OFFSET, CHUNK_ALIGN)
+
 /* size of smallest possible chunk. A memory piece smaller than this size
  * won't be able to create a chunk */
 #define MALLOC_MINCHUNK (CHUNK_OFFSET + MALLOC_PADDING + MALLOC_MINSIZE)
 
+/* Free chunks are kept on doubly linked lists segregated by size, with a
+ * bitmap recording which lists are not empty, so that malloc and free
+ * take constant time.  Sizes below BIN_SMALL_LIMIT are grouped into
+ * classes BIN_SMALL_STEP bytes wide, larger sizes into power of two
+ * classes; the last class also takes everything bigger.  */
+#define BIN_COUNT 32
+#define BIN_SMALL_STEP 16
+#define BIN_SMALL_COUNT 16
+#define BIN_SMALL_LIMIT (BIN_SMALL_STEP * BIN_SMALL_COUNT)
+#define BIN_SMALL_LIMIT_LOG2 8
+
+typedef uint32_t bin_map_t;
+
 /* Forward data declarations */
-extern chunk * free_list;
+extern chunk * free_bins[BIN_COUNT];
+extern bin_map_t free_map;
+extern chunk * heap_fence;
 extern char * sbrk_start;
 extern struct mallinfo current_mallinfo;
 
@@ -193,9 +237,67 @@ static inline chunk * get_chunk_from_ptr(void * ptr)
     return c;
 }
 
+#if defined(DEFINE_MALLOC) || defined(DEFINE_FREE)
+static inline int bin_index(malloc_size_t size)
+{
+    int idx;
+
+    if (size < BIN_SMALL_LIMIT)
+        return size / BIN_SMALL_STEP;
+
+    /* BIN_SMALL_COUNT for [BIN_SMALL_LIMIT, 2 * BIN_SMALL_LIMIT), ... */
+    idx = BIN_SMALL_COUNT - BIN_SMALL_LIMIT_LOG2 - 1
+          + (int)(sizeof(unsigned long) * 8) - __builtin_clzl(size);
+    return idx < BIN_COUNT ? idx : BIN_COUNT - 1;
+}
+
+/** Function bin_unlink
+  * Remove a free chunk from its size class list.
+  */
+static inline void bin_unlink(chunk * c)
+{
+    int idx = bin_index(CHUNK_SIZE(c));
+
+    if (c->prev != NULL)
+        c->prev->next = c->next;
+    else if ((free_bins[idx] = c->next) == NULL)
+        free_map &= ~((bin_map_t)1 << idx);
+    if (c->next != NULL)
+        c->next->prev = c->prev;
+}
+
+/** Function bin_insert
+  * Make c a free chunk of the given size: record the size at both ends,
+  * tell the next chunk that c is free and push c on its size class list.
+  * The chunk below c must not be free.
+  */
+static inline void bin_insert(chunk * c, malloc_size_t size)
+{
+    int idx = bin_index(size);
+
+    c->size = size;
+    ((long *)((char *)c + size))[-1] = size;
+    NEXT_CHUNK(c)->size |= PREV_FREE;
+
+    c->prev = NULL;
+    c->next = free_bins[idx];
+    if (c->next != NULL)
+        c->next->prev = c;
+    free_bins[idx] = c;
+    free_map |= (bin_map_t)1 << idx;
+}
+#endif /* DEFINE_MALLOC || DEFINE_FREE */
+
 #ifdef DEFINE_MALLOC
-/* List list header of free blocks */
-chunk * free_list = NULL;
+/* List headers of free blocks, by size class */
+chunk * free_bins[BIN_COUNT];
+
+/* Bit n is set if free_bins[n] is not empty */
+bin_map_t free_map;
+
+/* Zero sized, never free chunk closing the memory last obtained from
+ * the system */
+chunk * heap_fence = NULL;
 
 /* Starting point of memory allocated from system */
 char * sbrk_start = NULL;
@@ -230,18 +332,104 @@ static void* sbrk_aligned(RARG malloc_size_t s)
     return align_p;
 }
 
+/** Function bin_take
+  * Algorithm:
+  *   Use the first chunk of the size class of alloc_size if it is big
+  *   enough, otherwise the first chunk of the next non-empty, bigger
+  *   class.  In the last class, which has no upper bound, walk the list.
+  *   Return NULL if no free chunk is big enough.
+  */
+static chunk * bin_take(malloc_size_t alloc_size)
+{
+    int idx = bin_index(alloc_size);
+    chunk * r = free_bins[idx];
+    bin_map_t map;
+
+    if (r == NULL || CHUNK_SIZE(r) < alloc_size)
+    {
+        map = free_map & ~(bin_map_t)0 << idx << 1;
+        if (map != 0)
+            r = free_bins[__builtin_ctzl(map)];
+        else
+            while (r != NULL && CHUNK_SIZE(r) < alloc_size)
+                r = r->next;
+    }
+
+    if (r != NULL)
+        bin_unlink(r);
+    return r;
+}
+
+/** Function heap_extend
+  * Algorithm:
+  *   Use sbrk to obtain a chunk of at least alloc_size bytes, ended by a
+  *   new heap_fence.  If the new memory follows the current heap_fence,
+  *   it is merged with the old fence and with the last chunk before the
+  *   fence if that one is free, so that only the difference has to be
+  *   requested.  The returned chunk is not on any list.
+  */
+static chunk * heap_extend(RARG malloc_size_t alloc_size)
+{
+    chunk * r = NULL;
+    malloc_size_t size = 0;
+    char * heap_end;
+
+    if (heap_fence != NULL)
+    {
+        heap_end = (char *)heap_fence + CHUNK_OFFSET;
+        if (heap_end == _SBRK_R(RCALL 0))
+        {
+            r = heap_fence;
+            if (heap_fence->size & PREV_FREE)
+            {
+                size = PREV_SIZE(heap_fence);
+                r = (chunk *)((char *)heap_fence - size);
+            }
+            if (size < alloc_size)
+            {
+                if (sbrk_aligned(RCALL alloc_size - size) != heap_end)
+                    r = NULL;
+                else
+                    size = alloc_size;
+            }
+            if (r != NULL && r != heap_fence)
+                bin_unlink(r);
+        }
+    }
+
+    if (r == NULL)
+    {
+        /* Start a new region */
+        r = sbrk_aligned(RCALL alloc_size + CHUNK_OFFSET);
+
+        /* sbrk returns -1 if fail to allocate */
+        if (r == (void *)-1)
+            return NULL;
+        size = alloc_size;
+    }
+
+    if ((char *)r + size > (char *)heap_fence)
+    {
+        heap_fence = (chunk *)((char *)r + size);
+        heap_fence->size = 0;
+    }
+    r->size = size;
+    return r;
+}
+
 /** Function nano_malloc
   * Algorithm:
-  *   Walk through the free list to find the first match. If fails to find
-  *   one, call sbrk to allocate a new chunk.
+  *   Take the best fitting free chunk of the size class lists. If fails to
+  *   find one, call sbrk to allocate a new chunk. Split off and free the
+  *   rest of the chunk if it is big enough.
   */
 void * nano_malloc(RARG malloc_size_t s)
 {
-    chunk *p, *r;
+    chunk *r, *rest;
     char * ptr, * align_ptr;
     int offset;
 
-    malloc_size_t alloc_size;
+    malloc_size_t alloc_size, rem;
 
     alloc_size = ALIGN_SIZE(s, CHUNK_ALIGN); /* size of aligned data load */
     alloc_size += MALLOC_PADDING; /* padding */
@@ -256,106 +444,36 @@ void * nano_malloc(RARG malloc_size_t s)
 
     MALLOC_LOCK;
 
-    p = free_list;
-    r = p;
+    r = bin_take(alloc_size);
 
-    while (r)
+    /* Failed to find a appropriate chunk. Ask for more memory */
+    if (r == NULL)
     {
-        int rem = r->size - alloc_size;
-        if (rem >= 0)
+        r = heap_extend(RCALL alloc_size);
+        if (r == NULL)
         {
-            if (rem >= MALLOC_MINCHUNK)
-            {
-                if (p == r)
-                {
-                    /* First item in the list, break it into two chunks
-                    *  and return the first one */
-                    r->size = alloc_size;
-                    free_list = (chunk *)((char *)r + alloc_size);
-                    free_list->size = rem;
-                    free_list->next = r->next;
-                } else {
-                    /* Any other item in the list. Split and return
-                    * the first one */
-                    r->size = alloc_size;
-                    p->next = (chunk *)((char *)r + alloc_size);
-                    p->next->size = rem;
-                    p->next->next = r->next;
-                }
-            }
-            /* Find a chunk that is exactly the size or slightly bigger
-             * than requested size, just return this chunk */
-            else if (p == r)
-            {
-                /* Now it implies p==r==free_list. Move the free_list
-                 * to next chunk */
-                free_list = r->next;
-            }
-            else
-            {
-                /* Normal case. Remove it from free_list */
-                p->next = r->next;
-            }
-            break;
+            RERRNO = ENOMEM;
+            MALLOC_UNLOCK;
+            return NULL;
         }
-        p=r;
-        r=r->next;
     }
 
-    /* Failed to find a appropriate chunk. Ask for more memory */
-    if (r == NULL)
+    /* The chunk below a free chunk is never free, so r->size has no
+     * flag set here.  */
+    rem = r->size - alloc_size;
+    if (rem >= MALLOC_MINCHUNK)
     {
-        r = sbrk_aligned(RCALL alloc_size);
-
-        /* sbrk returns -1 if fail to allocate */
-        if (r == (void *)-1)
-        {
-            /* sbrk didn't have the requested amount. Let's check
-             * if the last item in the free list is adjacent to the
-             * current heap end (sbrk(0)). In that case, only ask
-             * for the difference in size and merge them */
-            p = free_list;
-            r = p;
-
-            while (r)
-            {
-                p=r;
-                r=r->next;
-            }
-
-            if (p != NULL && (char *)p + p->size == (char *)_SBRK_R(RCALL 0))
-            {
-               /* The last free item has the heap end as neighbour.
-                * Let's ask for a smaller amount and merge */
-               alloc_size -= p->size;
-               alloc_size = ALIGN_SIZE(alloc_size, CHUNK_ALIGN); /* size of aligned data load */
-               alloc_size += MALLOC_PADDING; /* padding */
-               alloc_size += CHUNK_OFFSET; /* size of chunk head */
-               alloc_size = MAX(alloc_size, MALLOC_MINCHUNK);
-
-               if (sbrk_aligned(RCALL alloc_size) != (void *)-1)
-               {
-                   p->size += alloc_size;
-                   r = p;
-               }
-               else
-               {
-                   RERRNO = ENOMEM;
-                   MALLOC_UNLOCK;
-                   return NULL;
-               }
-            }
-            else
-            {
-                RERRNO = ENOMEM;
-                MALLOC_UNLOCK;
-                return NULL;
-            }
-        }
-        else
-        {
-            r->size = alloc_size;
-        }
+        /* Split and return the first one */
+        r->size = alloc_size;
+        rest = NEXT_CHUNK(r);
+        rest->size = 0;
+        bin_insert(rest, rem);
+    }
+    else
+    {
+        /* Chunk is exactly the size or slightly bigger than requested
+         * size, just return this chunk */
+        NEXT_CHUNK(r)->size &= ~PREV_FREE;
     }
     MALLOC_UNLOCK;
 
@@ -393,76 +511,26 @@ void * nano_malloc(RARG malloc_size_t s)
 /** Function nano_free
   * Implementation of libc free.
   * Algorithm:
-  *  Maintain a global free chunk single link list, headed by global
-  *  variable free_list.
-  *  When free, insert the to-be-freed chunk into free list. The place to
-  *  insert should make sure all chunks are sorted by address from low to
-  *  high.  Then merge with neighbor chunks if adjacent.
+  *  Merge the chunk with the chunks just below and above it in memory if
+  *  those are free, taking them off their size class lists.  Then put the
+  *  result on the list for its size.
   */
 void nano_free (RARG void * free_p)
 {
     chunk * p_to_free;
     chunk * p, * q;
+    malloc_size_t size;
 
     if (free_p == NULL) return;
 
     p_to_free = get_chunk_from_ptr(free_p);
 
     MALLOC_LOCK;
-    if (free_list == NULL)
-    {
-        /* Set first free list element */
-        p_to_free->next = free_list;
-        free_list = p_to_free;
-        MALLOC_UNLOCK;
-        return;
-    }
+    size = CHUNK_SIZE(p_to_free);
+    q = NEXT_CHUNK(p_to_free);
 
-    if (p_to_free < free_list)
-    {
-        if ((char *)p_to_free + p_to_free->size == (char *)free_list)
-        {
-            /* Chunk to free is just before the first element of
-             * free list  */
-            p_to_free->size += free_list->size;
-            p_to_free->next = free_list->next;
-        }
-        else
-        {
-            /* Insert before current free_list */
-            p_to_free->next = free_list;
-        }
-        free_list = p_to_free;
-        MALLOC_UNLOCK;
-        return;
-    }
-
-    q = free_list;
-    /* Walk through the free list to find the place for insert. */
-    do
-    {
-        p = q;
-        q = q->next;
-    } while (q && q <= p_to_free);
-
-    /* Now p <= p_to_free and either q == NULL or q > p_to_free
-     * Try to merge with chunks immediately before/after it. */
-
-    if ((char *)p + p->size == (char *)p_to_free)
-    {
-        /* Chunk to be freed is adjacent
-         * to a free chunk before it */
-        p->size += p_to_free->size;
-        /* If the merged chunk is also adjacent
-         * to the chunk after it, merge again */
-        if ((char *)p + p->size == (char *) q)
-        {
-            p->size += q->size;
-            p->next = q->next;
-        }
-    }
 #ifdef MALLOC_CHECK_DOUBLE_FREE
-    else if ((char *)p + p->size > (char *)p_to_free)
+    if (q->size & PREV_FREE)
     {
         /* Report double free fault */
         RERRNO = ENOMEM;
@@ -470,21 +538,26 @@ void nano_free (RARG void * free_p)
         return;
     }
 #endif
-    else if ((char *)p_to_free + p_to_free->size == (char *) q)
+
+    if (p_to_free->size & PREV_FREE)
     {
         /* Chunk to be freed is adjacent
-         * to a free chunk after it */
-        p_to_free->size += q->size;
-        p_to_free->next = q->next;
-        p->next = p_to_free;
+         * to a free chunk before it */
+        p = (chunk *)((char *)p_to_free - PREV_SIZE(p_to_free));
+        bin_unlink(p);
+        size += CHUNK_SIZE(p);
+        p_to_free = p;
     }
-    else
+
+    if (q->size != 0 && (NEXT_CHUNK(q)->size & PREV_FREE))
     {
-        /* Not adjacent to any chunk. Just insert it. Resulting
-         * a fragment. */
-        p_to_free->next = q;
-        p->next = p_to_free;
+        /* Chunk to be freed is adjacent
+         * to a free chunk after it */
+        bin_unlink(q);
+        size += CHUNK_SIZE(q);
     }
+
+    bin_insert(p_to_free, size);
     MALLOC_UNLOCK;
 }
 #endif /* DEFINE_FREE */
@@ -492,7 +565,12 @@ void nano_free (RARG void * free_p)
 #ifdef DEFINE_CFREE
 void nano_cfree(RARG void * ptr)
 {
+#if defined(_LIBC) && defined(_MALLOC_INSTRUMENT)
+    /* Go through the public entry point, so that the free is counted.  */
+    _free_r(RCALL ptr);
+#else
     nano_free(RCALL ptr);
+#endif
 }
 #endif /* DEFINE_CFREE */
 
@@ -557,6 +635,7 @@ struct mallinfo nano_mallinfo(RONEARG)
     chunk * pf;
     size_t free_size = 0;
     size_t total_size;
+    int i;
 
     MALLOC_LOCK;
 
@@ -570,8 +649,9 @@ struct mallinfo nano_mallinfo(RONEARG)
             total_size = (size_t) (sbrk_now - sbrk_start);
     }
 
-    for (pf = free_list; pf; pf = pf->next)
-        free_size += pf->size;
+    for (i = 0; i < BIN_COUNT; i++)
+        for (pf = free_bins[i]; pf; pf = pf->next)
+            free_size += CHUNK_SIZE(pf);
 
     current_mallinfo.arena = total_size;
     current_mallinfo.fordblks = free_size;
@@ -593,6 +673,36 @@ void nano_malloc_stats(RONEARG)
     fiprintf(stderr, "in use bytes     = %10u\n",
              current_mallinfo.uordblks);
 }
+
+#ifdef _MALLOC_INSTRUMENT
+/* Function nano_malloc_dump_bins
+ * Print the number of chunks and of bytes in each non-empty size
+ * class list on stderr.  */
+void nano_malloc_dump_bins(RONEARG)
+{
+    int i;
+    chunk * pf;
+    unsigned long nchunks, nbytes;
+
+    /* Write the heading before taking the lock, so that any memory the
+     * stream needs is allocated before the lists are walked.  */
+    fiprintf(stderr, "bin     chunks      bytes\n");
+
+    MALLOC_LOCK;
+    for (i = 0; i < BIN_COUNT; i++)
+    {
+        nchunks = nbytes = 0;
+        for (pf = free_bins[i]; pf; pf = pf->next)
+        {
+            nchunks++;
+            nbytes += CHUNK_SIZE(pf);
+        }
+        if (nchunks != 0)
+            fiprintf(stderr, "%3d %10lu %10lu\n", i, nchunks, nbytes);
+    }
+    MALLOC_UNLOCK;
+}
+#endif /* _MALLOC_INSTRUMENT */
 #endif /* DEFINE_MALLOC_STATS */
 
 #ifdef DEFINE_MALLOC_USABLE_SIZE
@@ -605,9 +715,9 @@ malloc_size_t nano_malloc_usable_size(RARG void * ptr)
     {
         /* Padding is used. Excluding the padding size */
         c = (chunk *)((char *)c + c->size);
-        return c->size - CHUNK_OFFSET + size_or_offset;
+        return CHUNK_SIZE(c) - CHUNK_OFFSET + size_or_offset;
     }
-    return c->size - CHUNK_OFFSET;
+    return CHUNK_SIZE(c) - CHUNK_OFFSET;
 }
 #endif /* DEFINE_MALLOC_USABLE_SIZE */
 
@@ -667,8 +777,8 @@ void * nano_memalign(RARG size_t align, size_t s)
             /* Padding is too large, free it */
             chunk * front_chunk = chunk_p;
             chunk_p = (chunk *)((char *)chunk_p + offset);
-            chunk_p->size = front_chunk->size - offset;
-            front_chunk->size = offset;
+            chunk_p->size = CHUNK_SIZE(front_chunk) - offset;
+            front_chunk->size = offset | (front_chunk->size & PREV_FREE);
             nano_free(RCALL (char *)front_chunk + CHUNK_OFFSET);
         }
         else
@@ -680,15 +790,16 @@ void * nano_memalign(RARG size_t align, size_t s)
         }
     }
 
-    size_allocated = chunk_p->size;
+    size_allocated = CHUNK_SIZE(chunk_p);
     if ((char *)chunk_p + size_allocated >
          (aligned_p + ma_size + MALLOC_MINCHUNK))
     {
         /* allocated much more than what's required for padding, free
          * tail part */
         chunk * tail_chunk = (chunk *)(aligned_p + ma_size);
-        chunk_p->size = aligned_p + ma_size - (char *)chunk_p;
-        tail_chunk->size = size_allocated - chunk_p->size;
+        chunk_p->size = (aligned_p + ma_size - (char *)chunk_p)
+                        | (chunk_p->size & PREV_FREE);
+        tail_chunk->size = size_allocated - CHUNK_SIZE(chunk_p);
         nano_free(RCALL (char *)tail_chunk + CHUNK_OFFSET);
     }
     return aligned_p;
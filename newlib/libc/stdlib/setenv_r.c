@@ -76,6 +76,7 @@ _setenv_r (struct _reent *reent_ptr,
       if (strlen (C) >= l_value)
 	{			/* old larger; copy over */
 	  while ((*C++ = *value++) != 0);
+	  ENV_CHANGED;
           ENV_UNLOCK;
 	  return 0;
 	}
@@ -121,6 +122,7 @@ _setenv_r (struct _reent *reent_ptr,
   for (C = (*p_environ)[offset]; (*C = *name++) && *C != '='; ++C);
   for (*C++ = '='; (*C++ = *value++) != 0;);
 
+  ENV_CHANGED;
   ENV_UNLOCK;
 
   return 0;
@@ -151,6 +153,7 @@ _unsetenv_r (struct _reent *reent_ptr,
       for (P = &(*p_environ)[offset];; ++P)
         if (!(*P = *(P + 1)))
 	  break;
+      ENV_CHANGED;
     }
 
   ENV_UNLOCK;
@@ -101,11 +101,29 @@ _wcsnrtombs_l (struct _reent *r, char *dst, const wchar_t **src, size_t nwc,
   n = 0;
   pwcs = (wchar_t *)(*src);
 
-  while (n < len && nwc-- > 0)
+  while (n < len && nwc > 0)
     {
+#ifdef _MB_BULK_CONVERSION
+      if (ps->__count == 0)
+	{
+	  const wchar_t *start = pwcs;
+	  size_t done = __wcsbulk_r (r, ptr, (const wchar_t **) &pwcs, nwc,
+				     len - n, loc);
+	  nwc -= pwcs - start;
+	  n += done;
+	  if (dst)
+	    {
+	      ptr += done;
+	      *src = pwcs;
+	    }
+	  if (n == len || nwc == 0)
+	    break;
+	}
+#endif
       int count = ps->__count;
       wint_t wch = ps->__value.__wch;
       int bytes = loc->wctomb (r, buff, *pwcs, ps);
+      --nwc;
       if (bytes == -1)
 	{
 	  _REENT_ERRNO(r) = EILSEQ;
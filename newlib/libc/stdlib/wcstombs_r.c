@@ -19,6 +19,16 @@ _wcstombs_r (struct _reent *r,
       size_t num_bytes = 0;
       while (*pwcs != 0)
 	{
+#ifdef _MB_BULK_CONVERSION
+	  if (state->__count == 0)
+	    {
+	      num_bytes += __wcsbulk_r (r, NULL, (const wchar_t **) &pwcs,
+					(size_t) -1, (size_t) -1,
+					__get_current_locale ());
+	      if (*pwcs == 0)
+		break;
+	    }
+#endif
 	  bytes = __WCTOMB (r, buff, *pwcs++, state);
 	  if (bytes == -1)
 	    return -1;
@@ -30,6 +40,18 @@ _wcstombs_r (struct _reent *r,
     {
       while (n > 0)
         {
+#ifdef _MB_BULK_CONVERSION
+          if (state->__count == 0)
+            {
+              size_t count = __wcsbulk_r (r, ptr, (const wchar_t **) &pwcs,
+                                          (size_t) -1, n,
+                                          __get_current_locale ());
+              ptr += count;
+              n -= count;
+              if (n == 0)
+                break;
+            }
+#endif
           bytes = __WCTOMB (r, buff, *pwcs, state);
           if (bytes == -1)
             return -1;
@@ -0,0 +1,343 @@
+/* Wide-character substring search, using the Two-Way algorithm.
+ * Adapted from str-two-way.h, Copyright (C) 2008, 2010 Eric Blake
+ * Permission to use, copy, modify, and distribute this software
+ * is freely granted, provided that this notice is preserved.
+ */
+
+
+/* Before including this file, you need to include <wchar.h>, and define:
+     RETURN_TYPE		A macro that expands to the return type.
+     AVAILABLE(h, h_l, j, n_l)	A macro that returns nonzero if there are
+				at least N_L wide characters left starting
+				at H[J].  H is 'const wchar_t *', H_L, J,
+				and N_L are 'size_t'; H_L is an lvalue.
+				For NUL-terminated searches, H_L can be
+				modified each iteration to avoid having
+				to compute the end of H up front.
+
+  This file undefines the macros documented above, and defines
+  LONG_NEEDLE_THRESHOLD.
+
+  This is str-two-way.h with 'wchar_t' elements.  The bad character
+  shift table of the long needle search cannot have one entry for each
+  wchar_t value, so it is indexed by a hash of the character instead.
+  Characters that share an entry share the smallest of their shifts,
+  which keeps every shift safe; but an entry of 0 no longer proves
+  that the last character matches, so it is compared along with the
+  rest of the right half.  */
+
+#include <limits.h>
+#include <stdint.h>
+#include <_ansi.h>
+
+/* Point at which computing the shift table is likely to be worthwhile.
+   Preparing it costs SHIFT_TABLE_SIZE + NEEDLE_LEN operations, for a
+   speedup no greater than a factor of NEEDLE_LEN.  */
+#define LONG_NEEDLE_THRESHOLD 32U
+
+/* Number of entries in the shift table, and the hash indexing it.
+   Folding in the second byte keeps characters of one script, which
+   often share the low byte in part, from all landing on few entries.  */
+#define SHIFT_TABLE_SIZE 256U
+#define SHIFT_HASH(c) \
+  (((size_t) (c) ^ ((size_t) (c) >> 8)) & (SHIFT_TABLE_SIZE - 1))
+
+#define MAX(a, b) ((a < b) ? (b) : (a))
+
+/* Perform a critical factorization of NEEDLE, of length NEEDLE_LEN.
+   Return the index of the first character in the right half, and set
+   *PERIOD to the global period of the right half.  See str-two-way.h
+   for the description of the algorithm.  Any total order of the
+   alphabet will do, so the signedness of wchar_t does not matter.  */
+static size_t
+critical_factorization (const wchar_t *needle, size_t needle_len,
+			size_t *period)
+{
+  /* Index of last character of left half, or SIZE_MAX.  */
+  size_t max_suffix, max_suffix_rev;
+  size_t j; /* Index into NEEDLE for current candidate suffix.  */
+  size_t k; /* Offset into current period.  */
+  size_t p; /* Intermediate period.  */
+  wchar_t a, b; /* Current comparison characters.  */
+
+  /* Perform lexicographic search.  */
+  max_suffix = SIZE_MAX;
+  j = 0;
+  k = p = 1;
+  while (j + k < needle_len)
+    {
+      a = needle[j + k];
+      b = needle[(size_t)(max_suffix + k)];
+      if (a < b)
+	{
+	  /* Suffix is smaller, period is entire prefix so far.  */
+	  j += k;
+	  k = 1;
+	  p = j - max_suffix;
+	}
+      else if (a == b)
+	{
+	  /* Advance through repetition of the current period.  */
+	  if (k != p)
+	    ++k;
+	  else
+	    {
+	      j += p;
+	      k = 1;
+	    }
+	}
+      else /* b < a */
+	{
+	  /* Suffix is larger, start over from current location.  */
+	  max_suffix = j++;
+	  k = p = 1;
+	}
+    }
+  *period = p;
+
+  /* Perform reverse lexicographic search.  */
+  max_suffix_rev = SIZE_MAX;
+  j = 0;
+  k = p = 1;
+  while (j + k < needle_len)
+    {
+      a = needle[j + k];
+      b = needle[max_suffix_rev + k];
+      if (b < a)
+	{
+	  /* Suffix is smaller, period is entire prefix so far.  */
+	  j += k;
+	  k = 1;
+	  p = j - max_suffix_rev;
+	}
+      else if (a == b)
+	{
+	  /* Advance through repetition of the current period.  */
+	  if (k != p)
+	    ++k;
+	  else
+	    {
+	      j += p;
+	      k = 1;
+	    }
+	}
+      else /* a < b */
+	{
+	  /* Suffix is larger, start over from current location.  */
+	  max_suffix_rev = j++;
+	  k = p = 1;
+	}
+    }
+
+  /* Choose the longer suffix.  Return the first character of the right
+     half, rather than the last character of the left half.  */
+  if (max_suffix_rev + 1 < max_suffix + 1)
+    return max_suffix + 1;
+  *period = p;
+  return max_suffix_rev + 1;
+}
+
+/* Return the first location of non-empty NEEDLE within HAYSTACK, or
+   NULL.  HAYSTACK_LEN is the minimum known length of HAYSTACK.  This
+   method is optimized for NEEDLE_LEN < LONG_NEEDLE_THRESHOLD.
+   Performance is guaranteed to be linear, with an initialization cost
+   of 2 * NEEDLE_LEN comparisons.  */
+static RETURN_TYPE __attribute__ ((__used__))
+two_way_short_needle (const wchar_t *haystack, size_t haystack_len,
+		      const wchar_t *needle, size_t needle_len)
+{
+  size_t i; /* Index into current character of NEEDLE.  */
+  size_t j; /* Index into current window of HAYSTACK.  */
+  size_t period; /* The period of the right half of needle.  */
+  size_t suffix; /* The index of the right half of needle.  */
+
+  suffix = critical_factorization (needle, needle_len, &period);
+
+  /* Perform the search.  Each iteration compares the right half
+     first.  */
+  if (wmemcmp (needle, needle + period, suffix) == 0)
+    {
+      /* Entire needle is periodic; a mismatch can only advance by the
+	 period, so use memory to avoid rescanning known occurrences
+	 of the period.  */
+      size_t memory = 0;
+      j = 0;
+      while (AVAILABLE (haystack, haystack_len, j, needle_len))
+	{
+	  /* Scan for matches in right half.  */
+	  i = MAX (suffix, memory);
+	  while (i < needle_len && needle[i] == haystack[i + j])
+	    ++i;
+	  if (needle_len <= i)
+	    {
+	      /* Scan for matches in left half.  */
+	      i = suffix - 1;
+	      while (memory < i + 1 && needle[i] == haystack[i + j])
+		--i;
+	      if (i + 1 < memory + 1)
+		return (RETURN_TYPE) (haystack + j);
+	      /* No match, so remember how many repetitions of period
+		 on the right half were scanned.  */
+	      j += period;
+	      memory = needle_len - period;
+	    }
+	  else
+	    {
+	      j += i - suffix + 1;
+	      memory = 0;
+	    }
+	}
+    }
+  else
+    {
+      /* The two halves of needle are distinct; no extra memory is
+	 required, and any mismatch results in a maximal shift.  */
+      wchar_t first = needle[suffix];
+      period = MAX (suffix, needle_len - suffix) + 1;
+      j = 0;
+      while (AVAILABLE (haystack, haystack_len, j, needle_len))
+	{
+	  /* Most windows fail on the first character compared; skip
+	     over those in a tight loop.  */
+	  if (first != haystack[suffix + j])
+	    {
+	      ++j;
+	      continue;
+	    }
+	  /* Scan for matches in right half.  */
+	  i = suffix + 1;
+	  while (i < needle_len && needle[i] == haystack[i + j])
+	    ++i;
+	  if (needle_len <= i)
+	    {
+	      /* Scan for matches in left half.  */
+	      i = suffix - 1;
+	      while (i != SIZE_MAX && needle[i] == haystack[i + j])
+		--i;
+	      if (i == SIZE_MAX)
+		return (RETURN_TYPE) (haystack + j);
+	      j += period;
+	    }
+	  else
+	    j += i - suffix + 1;
+	}
+    }
+  return NULL;
+}
+
+/* Return the first location of non-empty NEEDLE within HAYSTACK, or
+   NULL.  HAYSTACK_LEN is the minimum known length of HAYSTACK.  This
+   method is optimized for LONG_NEEDLE_THRESHOLD <= NEEDLE_LEN.
+   Performance is guaranteed to be linear, with an initialization cost
+   of 3 * NEEDLE_LEN + SHIFT_TABLE_SIZE operations.  When AVAILABLE does
+   not modify HAYSTACK_LEN (as in wmemmem), sublinear performance
+   O(HAYSTACK_LEN / NEEDLE_LEN) is possible.  */
+_NOINLINE_STATIC RETURN_TYPE __attribute__ ((__used__))
+two_way_long_needle (const wchar_t *haystack, size_t haystack_len,
+		     const wchar_t *needle, size_t needle_len)
+{
+  size_t i; /* Index into current character of NEEDLE.  */
+  size_t j; /* Index into current window of HAYSTACK.  */
+  size_t period; /* The period of the right half of needle.  */
+  size_t suffix; /* The index of the right half of needle.  */
+  size_t shift; /* Bad character shift of the current window.  */
+  size_t shift_table[SHIFT_TABLE_SIZE]; /* See below.  */
+
+  suffix = critical_factorization (needle, needle_len, &period);
+
+  /* Populate shift_table.  For each hash value h, shift_table[h] is the
+     distance from the last occurrence of a character hashing to h to
+     the end of NEEDLE, or NEEDLE_LEN if there is none.  A window whose
+     last character hashes to a nonzero entry cannot match, nor can any
+     window ending before the next occurrence of that character.  */
+  for (i = 0; i < SHIFT_TABLE_SIZE; i++)
+    shift_table[i] = needle_len;
+  for (i = 0; i < needle_len; i++)
+    shift_table[SHIFT_HASH (needle[i])] = needle_len - i - 1;
+
+  /* Perform the search.  Each iteration compares the right half
+     first.  */
+  if (wmemcmp (needle, needle + period, suffix) == 0)
+    {
+      /* Entire needle is periodic; a mismatch can only advance by the
+	 period, so use memory to avoid rescanning known occurrences
+	 of the period.  */
+      size_t memory = 0;
+      j = 0;
+      while (AVAILABLE (haystack, haystack_len, j, needle_len))
+	{
+	  /* Check the last character first; if it cannot match, then
+	     shift to the next possible match location.  */
+	  shift = shift_table[SHIFT_HASH (haystack[j + needle_len - 1])];
+	  if (0 < shift)
+	    {
+	      memory = 0;
+	      j += shift;
+	      continue;
+	    }
+	  /* Scan for matches in right half.  */
+	  i = MAX (suffix, memory);
+	  while (i < needle_len && needle[i] == haystack[i + j])
+	    ++i;
+	  if (needle_len <= i)
+	    {
+	      /* Scan for matches in left half.  */
+	      i = suffix - 1;
+	      while (memory < i + 1 && needle[i] == haystack[i + j])
+		--i;
+	      if (i + 1 < memory + 1)
+		return (RETURN_TYPE) (haystack + j);
+	      /* No match, so remember how many repetitions of period
+		 on the right half were scanned.  */
+	      j += period;
+	      memory = needle_len - period;
+	    }
+	  else
+	    {
+	      j += i - suffix + 1;
+	      memory = 0;
+	    }
+	}
+    }
+  else
+    {
+      /* The two halves of needle are distinct; no extra memory is
+	 required, and any mismatch results in a maximal shift.  */
+      period = MAX (suffix, needle_len - suffix) + 1;
+      j = 0;
+      while (AVAILABLE (haystack, haystack_len, j, needle_len))
+	{
+	  /* Check the last character first; if it cannot match, then
+	     shift to the next possible match location.  */
+	  shift = shift_table[SHIFT_HASH (haystack[j + needle_len - 1])];
+	  if (0 < shift)
+	    {
+	      j += shift;
+	      continue;
+	    }
+	  /* Scan for matches in right half.  */
+	  i = suffix;
+	  while (i < needle_len && needle[i] == haystack[i + j])
+	    ++i;
+	  if (needle_len <= i)
+	    {
+	      /* Scan for matches in left half.  */
+	      i = suffix - 1;
+	      while (i != SIZE_MAX && needle[i] == haystack[i + j])
+		--i;
+	      if (i == SIZE_MAX)
+		return (RETURN_TYPE) (haystack + j);
+	      j += period;
+	    }
+	  else
+	    j += i - suffix + 1;
+	}
+    }
+  return NULL;
+}
+
+#undef AVAILABLE
+#undef MAX
+#undef RETURN_TYPE
+#undef SHIFT_HASH
+#undef SHIFT_TABLE_SIZE
@@ -60,6 +60,8 @@ PORTABILITY
 #include <stddef.h>
 #include <wchar.h>
 
+#if defined(PREFER_SIZE_OVER_SPEED) || defined(__OPTIMIZE_SIZE__)
+
 wchar_t *
 wcsstr (const wchar_t *__restrict big,
 	const wchar_t *__restrict little)
@@ -98,3 +100,37 @@ wcsstr (const wchar_t *__restrict big,
     }
   return NULL;
 }
+
+#else /* compilation for speed */
+
+# define RETURN_TYPE wchar_t *
+# define AVAILABLE(h, h_l, j, n_l) (((j) <= (h_l) - (n_l)) \
+   || ((h_l) += wcsnlen ((h) + (h_l), (n_l) | 512), ((j) <= (h_l) - (n_l))))
+# include "wcs-two-way.h"
+
+/* Linear-time wcsstr, using the Two-Way algorithm.  The end of BIG is
+   found as the search goes, in steps of at least 512 characters, so a
+   match near its start does not have to read all of it.  */
+wchar_t *
+wcsstr (const wchar_t *__restrict big,
+	const wchar_t *__restrict little)
+{
+  size_t ne_len, hs_len;
+
+  if (little[0] == L'\0')
+    return (wchar_t *) big;
+  if (little[1] == L'\0')
+    return wcschr (big, little[0]);
+
+  ne_len = wcslen (little);
+  hs_len = wcsnlen (big, ne_len | 512);
+
+  /* Ensure haystack length is >= needle length.  */
+  if (hs_len < ne_len)
+    return NULL;
+
+  if (ne_len < LONG_NEEDLE_THRESHOLD)
+    return two_way_short_needle (big, hs_len, little, ne_len);
+  return two_way_long_needle (big, hs_len, little, ne_len);
+}
+#endif /* compilation for speed */
@@ -95,7 +95,15 @@ PORTABILITY
 #endif
 #include "local.h"
 
-#ifdef _MB_CAPABLE
+#if defined (_MB_CAPABLE) && defined (_UNICODE_PAGE_TABLES)
+#include <stdint.h>
+/* two-stage table generated by ../ctype/mkpagetab from the tables below */
+#include "widthpages.t"
+
+#define WIDTH_COMBINING	1
+#define WIDTH_WIDE	2
+#define WIDTH_AMBIGUOUS	4
+#elif defined (_MB_CAPABLE)
 struct interval
 {
   int first;
@@ -124,7 +132,7 @@ bisearch(wint_t ucs, const struct interval *table, int max)
 
   return 0;
 }
-#endif /* _MB_CAPABLE */
+#endif /* _MB_CAPABLE && !_UNICODE_PAGE_TABLES */
 
 /* The following function defines the column width of an ISO 10646
  * character as follows:
@@ -167,6 +175,7 @@ int
 __wcwidth (const wint_t ucs)
 {
 #ifdef _MB_CAPABLE
+#ifndef _UNICODE_PAGE_TABLES
   /* sorted list of non-overlapping intervals of East Asian Ambiguous chars */
   static const struct interval ambiguous[] =
 #include "ambiguous.t"
@@ -180,6 +189,7 @@ __wcwidth (const wint_t ucs)
    */
   static const struct interval wide[] =
 #include "wide.t"
+#endif /* !_UNICODE_PAGE_TABLES */
 
   /* Test for NUL character */
   if (ucs == 0)
@@ -200,6 +210,22 @@ __wcwidth (const wint_t ucs)
   /* check CJK width mode (1: ambiguous-wide, 0: normal, -1: disabled) */
   int cjk_lang = __locale_cjk_lang ();
 
+#ifdef _UNICODE_PAGE_TABLES
+  int w = 0;
+
+  if (ucs < WIDTH_PAGE_LIMIT)
+    w = width_pages[width_page_index[ucs >> WIDTH_PAGE_SHIFT]]
+		   [ucs & ((1 << WIDTH_PAGE_SHIFT) - 1)];
+
+  /* same order of tests as with the binary searches below */
+  if (cjk_lang > 0 && (w & WIDTH_AMBIGUOUS))
+    return 2;
+  if (w & WIDTH_COMBINING)
+    return 0;
+  if (cjk_lang >= 0 && (w & WIDTH_WIDE))
+    return 2;
+  return 1;
+#else /* !_UNICODE_PAGE_TABLES */
   /* binary search in table of ambiguous characters */
   if (cjk_lang > 0
       && bisearch(ucs, ambiguous,
@@ -220,6 +246,7 @@ __wcwidth (const wint_t ucs)
     return 2;
   else
     return 1;
+#endif /* !_UNICODE_PAGE_TABLES */
 #else /* !_MB_CAPABLE */
   if (iswprint (ucs))
     return 1;
@@ -0,0 +1,85 @@
+/*
+FUNCTION
+	<<wmemmem>>---find wide-character memory segment
+
+INDEX
+	wmemmem
+
+SYNOPSIS
+	#define _GNU_SOURCE
+	#include <wchar.h>
+	wchar_t *wmemmem(const wchar_t *<[s1]>, size_t <[l1]>,
+			 const wchar_t *<[s2]>, size_t <[l2]>);
+
+DESCRIPTION
+	Locates the first occurrence in the array of <[l1]> wide characters
+	pointed to by <[s1]> of the sequence of <[l2]> wide characters
+	pointed to by <[s2]>.  Null wide characters are not treated
+	specially.  The search takes time linear in <[l1]> + <[l2]>.
+
+RETURNS
+	Returns a pointer to the located segment, or a null pointer if
+	<[s2]> is not found. If <[l2]> is 0, <[s1]> is returned.
+
+PORTABILITY
+<<wmemmem>> is a newlib extension.
+
+No supporting OS subroutines are required.
+*/
+
+#define _GNU_SOURCE
+#include <_ansi.h>
+#include <stddef.h>
+#include <wchar.h>
+
+#if defined(PREFER_SIZE_OVER_SPEED) || defined(__OPTIMIZE_SIZE__)
+
+/* Small and efficient wmemmem implementation (quadratic worst-case).  */
+wchar_t *
+wmemmem (const wchar_t *hs, size_t hs_len, const wchar_t *ne, size_t ne_len)
+{
+  const wchar_t *end;
+  size_t i;
+
+  if (ne_len == 0)
+    return (wchar_t *) hs;
+  if (hs_len < ne_len)
+    return NULL;
+
+  for (end = hs + hs_len - ne_len; hs <= end; hs++)
+    {
+      if (hs[0] != ne[0])
+	continue;
+      for (i = ne_len - 1; i != 0; i--)
+	if (hs[i] != ne[i])
+	  break;
+      if (i == 0)
+	return (wchar_t *) hs;
+    }
+
+  return NULL;
+}
+
+#else /* compilation for speed */
+
+# define RETURN_TYPE wchar_t *
+# define AVAILABLE(h, h_l, j, n_l) ((j) <= (h_l) - (n_l))
+# include "wcs-two-way.h"
+
+wchar_t *
+wmemmem (const wchar_t *hs, size_t hs_len, const wchar_t *ne, size_t ne_len)
+{
+  if (ne_len == 0)
+    return (wchar_t *) hs;
+  if (ne_len == 1)
+    return wmemchr (hs, ne[0], hs_len);
+
+  /* Ensure haystack length is >= needle length.  */
+  if (hs_len < ne_len)
+    return NULL;
+
+  if (ne_len < LONG_NEEDLE_THRESHOLD)
+    return two_way_short_needle (hs, hs_len, ne, ne_len);
+  return two_way_long_needle (hs, hs_len, ne, ne_len);
+}
+#endif /* compilation for speed */
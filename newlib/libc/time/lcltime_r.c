@@ -24,31 +24,62 @@ localtime_r (const time_t *__restrict tim_p,
   int year;
   __tzinfo_type *const tz = __gettzinfo ();
   const int *ip;
+  unsigned int seq;
+  int locked;
 
   res = gmtime_r (tim_p, res);
 
   year = res->tm_year + YEAR_BASE;
   ip = __month_lengths[isleap(year)];
 
-  TZ_LOCK;
-  _tzset_unlocked ();
-  if (_daylight)
+  /* Unless TZ may have changed, the DST limits are for another year or
+     the zone comes from a file, read the time zone without the lock, and
+     start again if that raced with a change.  */
+  for (locked = 0;; )
     {
-      if (year == tz->__tzyear || __tzcalc_limits (year))
-	res->tm_isdst = (tz->__tznorth
-	  ? (*tim_p >= tz->__tzrule[0].change
-	  && *tim_p < tz->__tzrule[1].change)
-	  : (*tim_p >= tz->__tzrule[0].change
-	  || *tim_p < tz->__tzrule[1].change));
+      seq = TZ_READ_BEGIN ();
+      if ((seq & 1) != 0 || __tz_stale ()
+#ifdef _WANT_TZFILE
+	  || __tzzone != NULL
+#endif
+	  || (_daylight && year != tz->__tzyear))
+	{
+	  TZ_LOCK;
+	  _tzset_unlocked ();
+	  locked = 1;
+	}
+#ifdef _WANT_TZFILE
+      if (locked && __tzfile_localtime (*tim_p, &offset, &res->tm_isdst))
+	;
       else
-	res->tm_isdst = -1;
-    }
-  else
-    res->tm_isdst = 0;
+#endif
+	{
+	  if (_daylight)
+	    {
+	      if (year == tz->__tzyear || (locked && __tzcalc_limits (year)))
+		res->tm_isdst = (tz->__tznorth
+		  ? (*tim_p >= tz->__tzrule[0].change
+		  && *tim_p < tz->__tzrule[1].change)
+		  : (*tim_p >= tz->__tzrule[0].change
+		  || *tim_p < tz->__tzrule[1].change));
+	      else
+		res->tm_isdst = -1;
+	    }
+	  else
+	    res->tm_isdst = 0;
 
-  offset = (res->tm_isdst == 1
-    ? tz->__tzrule[1].offset
-    : tz->__tzrule[0].offset);
+	  offset = (res->tm_isdst == 1
+	    ? tz->__tzrule[1].offset
+	    : tz->__tzrule[0].offset);
+	}
+      if (locked)
+	{
+	  TZ_UNLOCK;
+	  break;
+	}
+      if (!TZ_READ_RETRY (seq))
+	break;
+    }
 
   hours = (int) (offset / SECSPERHOUR);
   offset = offset % SECSPERHOUR;
@@ -120,7 +151,6 @@ localtime_r (const time_t *__restrict tim_p,
 	  res->tm_mday = ip[res->tm_mon];
 	}
     }
-  TZ_UNLOCK;
 
   return (res);
 }
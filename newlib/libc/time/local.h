@@ -1,5 +1,6 @@
 /* local header used by libc/time routines */
 #include <_ansi.h>
+#include <newlib.h>
 #include <time.h>
 #include <sys/_tz_structs.h>
 
@@ -27,13 +28,65 @@ extern const int __month_lengths[2][MONSPERYEAR];
 void _tzset_unlocked_r (struct _reent *);
 void _tzset_unlocked (void);
 
+#ifdef _WANT_TZFILE
+/* Time zone read from a TZif file by tzset */
+struct __tztype
+{
+  long offset;			/* seconds west of UTC */
+  unsigned char isdst;
+  unsigned char abbr;		/* index of the name in chars */
+};
+
+struct __tzzone
+{
+  struct __tzzone *next;
+  int timecnt, typecnt;
+  __int64_t *ats;		/* transition times, ascending */
+  unsigned char *idx;		/* type from each transition on */
+  struct __tztype *types;	/* types[0] is used before the first one */
+  char *chars;			/* type names */
+  char *rule;			/* TZ string for after the last one, or NULL */
+  char *name;
+};
+
+extern struct __tzzone *__tzzone;
+
+struct __tzzone *__tzfile_load (struct _reent *, const char *);
+void __tzfile_setnames (struct __tzzone *);
+int __tzfile_localtime (time_t, long *, int *);
+int __tzfile_mktime (time_t, int, time_t *, long *, int *);
+#endif
+
+int __tz_stale (void);
+
 /* locks for multi-threading */
 #ifdef __SINGLE_THREAD__
 #define TZ_LOCK
 #define TZ_UNLOCK
+#define TZ_READ_BEGIN()		1
+#define TZ_READ_RETRY(seq)	0
 #else
-#define TZ_LOCK __tz_lock()
-#define TZ_UNLOCK __tz_unlock()
+/* TZ_LOCK also makes the sequence count __tz_seq odd and TZ_UNLOCK makes
+   it even again, so that localtime can read the time zone variables
+   without the lock between TZ_READ_BEGIN and TZ_READ_RETRY, and retry if
+   the count was odd or has changed in between.  */
+extern unsigned int __tz_seq;
+
+#define TZ_LOCK \
+  do { \
+    __tz_lock (); \
+    __atomic_store_n (&__tz_seq, __tz_seq + 1, __ATOMIC_RELAXED); \
+    __atomic_thread_fence (__ATOMIC_RELEASE); \
+  } while (0)
+#define TZ_UNLOCK \
+  do { \
+    __atomic_store_n (&__tz_seq, __tz_seq + 1, __ATOMIC_RELEASE); \
+    __tz_unlock (); \
+  } while (0)
+#define TZ_READ_BEGIN()	__atomic_load_n (&__tz_seq, __ATOMIC_ACQUIRE)
+#define TZ_READ_RETRY(seq) \
+  (__atomic_thread_fence (__ATOMIC_ACQUIRE), \
+   __atomic_load_n (&__tz_seq, __ATOMIC_RELAXED) != (seq))
 #endif
 
 void __tz_lock (void);
@@ -194,6 +194,29 @@ mktime (struct tm *tim_p)
 
   _tzset_unlocked ();
 
+#ifdef _WANT_TZFILE
+  {
+    time_t utc;
+    long offset;
+
+    if (__tzfile_mktime (tim, tim_p->tm_isdst, &utc, &offset, &isdst))
+      {
+	TZ_UNLOCK;
+	/* if the local time does not exist or the given DST was wrong,
+	   normalize the structure to the local time of the result */
+	if (utc - offset != tim)
+	  {
+	    tim = utc - offset;
+	    gmtime_r (&tim, tim_p);
+	  }
+	else if ((tim_p->tm_wday = (days + 4) % 7) < 0)
+	  tim_p->tm_wday += 7;
+	tim_p->tm_isdst = isdst;
+	return utc;
+      }
+  }
+#endif
+
   if (_daylight)
     {
       int tm_isdst;
@@ -0,0 +1,384 @@
+/*
+ * tzfile.c
+ * Read time zone information files (TZif, RFC 8536) for tzset, and look
+ * up the local time type in effect at a given time.
+ *
+ * The transitions of a zone are kept in a sorted array, searched with
+ * a binary search by localtime_r and mktime.  Times after the last
+ * transition follow the POSIX TZ string at the end of version 2 and
+ * later files, which tzset hands to its usual parser.  The last few
+ * zones read are kept, so that switching back and forth between them
+ * does not read the files again.
+ */
+
+#include <newlib.h>
+
+#ifdef _WANT_TZFILE
+
+#include <_ansi.h>
+#include <reent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include "local.h"
+
+#ifndef _TZDIR
+#define _TZDIR		"/usr/share/zoneinfo"
+#endif
+
+#define TZFILE_CACHE	4	/* zones kept */
+#define TZFILE_MAX	(1L << 20)	/* larger files are not read */
+
+struct __tzzone *__tzzone;	/* current zone, or NULL for POSIX rules */
+
+static struct __tzzone *zones;	/* most recently used first */
+
+static __int32_t
+get32 (const unsigned char *p)
+{
+  return (__int32_t) ((__uint32_t) p[0] << 24 | (__uint32_t) p[1] << 16
+		      | (__uint32_t) p[2] << 8 | p[3]);
+}
+
+static __int64_t
+get64 (const unsigned char *p)
+{
+  return (__int64_t) ((__uint64_t) (__uint32_t) get32 (p) << 32
+		      | (__uint32_t) get32 (p + 4));
+}
+
+/* Read the file at path into a malloced buffer.  */
+static unsigned char *
+readfile (struct _reent *ptr,
+	const char *path,
+	long *lenp)
+{
+  unsigned char *buf = NULL, *nbuf;
+  long len = 0, size = 0;
+  _ssize_t n;
+  int fd;
+
+  if ((fd = _open_r (ptr, path, O_RDONLY, 0)) == -1)
+    return NULL;
+  for (;;)
+    {
+      if (len == size)
+	{
+	  size = size ? 2 * size : 4096;
+	  if (size > TZFILE_MAX
+	      || (nbuf = _realloc_r (ptr, buf, size)) == NULL)
+	    break;
+	  buf = nbuf;
+	}
+      if ((n = _read_r (ptr, fd, buf + len, size - len)) <= 0)
+	{
+	  if (n == 0)
+	    {
+	      _close_r (ptr, fd);
+	      *lenp = len;
+	      return buf;
+	    }
+	  break;
+	}
+      len += n;
+    }
+  _close_r (ptr, fd);
+  _free_r (ptr, buf);
+  return NULL;
+}
+
+/* Parse the TZif data in buf into a new zone called name.  */
+static struct __tzzone *
+parse (struct _reent *ptr,
+	const char *name,
+	const unsigned char *buf,
+	long len)
+{
+  const unsigned char *p, *end = buf + len, *rule = NULL;
+  long isutcnt, isstdcnt, leapcnt, timecnt, typecnt, charcnt, size;
+  int timesize = 4, rulelen = 0, i;
+  struct __tzzone *z;
+  char *s;
+
+  for (p = buf; ; p += size)
+    {
+      if (end - p < 44 || memcmp (p, "TZif", 4) != 0)
+	return NULL;
+      isutcnt = get32 (p + 20);
+      isstdcnt = get32 (p + 24);
+      leapcnt = get32 (p + 28);
+      timecnt = get32 (p + 32);
+      typecnt = get32 (p + 36);
+      charcnt = get32 (p + 40);
+      if (isutcnt < 0 || isstdcnt < 0 || leapcnt < 0 || timecnt < 0
+	  || typecnt <= 0 || typecnt > 256 || charcnt <= 0
+	  || timecnt > end - p || leapcnt > end - p || charcnt > end - p
+	  || isstdcnt > end - p || isutcnt > end - p)
+	return NULL;
+      size = 44 + timecnt * (timesize + 1) + typecnt * 6 + charcnt
+	+ leapcnt * (timesize + 4) + isstdcnt + isutcnt;
+      if (size > end - p)
+	return NULL;
+      /* Version 1 files only have 32-bit times; later versions follow
+	 them with the same data with 64-bit times and a TZ string.  */
+      if (p[4] == '\0' || timesize == 8)
+	break;
+      timesize = 8;
+    }
+  if (timesize == 8)
+    {
+      /* The TZ string, if any, is between newlines at the end.  */
+      rule = p + size;
+      if (rule < end && *rule++ == '\n')
+	for (; rule + rulelen < end && rule[rulelen] != '\n'; rulelen++)
+	  ;
+      if (rule + rulelen >= end || rulelen == 0)
+	rule = NULL;
+    }
+
+  /* Everything goes in one block, the times first as they need the
+     strictest alignment.  */
+  size = (sizeof (*z) + 7) & ~7;
+  if ((z = _malloc_r (ptr, size + timecnt * (sizeof (__int64_t) + 1)
+		      + typecnt * sizeof (z->types[0]) + charcnt + 1
+		      + rulelen + 1 + strlen (name) + 1)) == NULL)
+    return NULL;
+  z->timecnt = timecnt;
+  z->typecnt = typecnt;
+  z->ats = (__int64_t *) ((char *) z + size);
+  z->types = (struct __tztype *) (z->ats + timecnt);
+  z->idx = (unsigned char *) (z->types + typecnt);
+  z->chars = (char *) (z->idx + timecnt);
+
+  p += 44;
+  for (i = 0; i < timecnt; i++, p += timesize)
+    {
+      z->ats[i] = timesize == 8 ? get64 (p) : get32 (p);
+      if (i > 0 && z->ats[i] <= z->ats[i - 1])
+	goto bad;
+    }
+  for (i = 0; i < timecnt; i++)
+    if ((z->idx[i] = *p++) >= typecnt)
+      goto bad;
+  for (i = 0; i < typecnt; i++, p += 6)
+    {
+      /* Seconds west of UTC, as in __tzrule.  */
+      z->types[i].offset = -(long) get32 (p);
+      z->types[i].isdst = p[4] != 0;
+      if ((z->types[i].abbr = p[5]) >= charcnt)
+	goto bad;
+    }
+  memcpy (z->chars, p, charcnt);
+  z->chars[charcnt] = '\0';
+  s = z->chars + charcnt + 1;
+  z->rule = NULL;
+  if (rule != NULL)
+    {
+      z->rule = s;
+      memcpy (s, rule, rulelen);
+      s += rulelen;
+      *s++ = '\0';
+    }
+  z->name = strcpy (s, name);
+  return z;
+
+bad:
+  _free_r (ptr, z);
+  return NULL;
+}
+
+/* Return the zone for TZ value tzenv, from the cache or from its file, or
+   NULL if there is no such file.  */
+struct __tzzone *
+__tzfile_load (struct _reent *ptr,
+	const char *tzenv)
+{
+  struct __tzzone *z, **zp;
+  const char *dir;
+  unsigned char *buf;
+  char *path;
+  long len;
+  int n;
+
+  if (*tzenv == ':')
+    tzenv++;
+  if (*tzenv == '\0' || strstr (tzenv, "..") != NULL)
+    return NULL;
+
+  for (zp = &zones, n = 0; (z = *zp) != NULL; zp = &z->next, n++)
+    if (strcmp (z->name, tzenv) == 0)
+      {
+	*zp = z->next;
+	z->next = zones;
+	return zones = z;
+      }
+
+  if (*tzenv == '/')
+    buf = readfile (ptr, tzenv, &len);
+  else
+    {
+      if ((dir = _getenv_r (ptr, "TZDIR")) == NULL || *dir != '/')
+	dir = _TZDIR;
+      if ((path = _malloc_r (ptr, strlen (dir) + strlen (tzenv) + 2)) == NULL)
+	return NULL;
+      strcat (strcat (strcpy (path, dir), "/"), tzenv);
+      buf = readfile (ptr, path, &len);
+      _free_r (ptr, path);
+    }
+  if (buf == NULL)
+    return NULL;
+  z = parse (ptr, tzenv, buf, len);
+  _free_r (ptr, buf);
+  if (z == NULL)
+    return NULL;
+
+  /* Drop the least recently used zone if the cache is full.  The zone
+     in use is the first one, so it is never dropped.  */
+  if (n >= TZFILE_CACHE)
+    {
+      for (zp = &zones; (*zp)->next != NULL; zp = &(*zp)->next)
+	;
+      _free_r (ptr, *zp);
+      *zp = NULL;
+    }
+  z->next = zones;
+  return zones = z;
+}
+
+/* Set the names and offsets of tzset from the types of zone z, for files
+   without a TZ string.  */
+void
+__tzfile_setnames (struct __tzzone *z)
+{
+  __tzinfo_type *tz = __gettzinfo ();
+  int i;
+
+  _tzname[0] = _tzname[1] = z->chars + z->types[0].abbr;
+  tz->__tzrule[0].offset = tz->__tzrule[1].offset = z->types[0].offset;
+  _daylight = 0;
+  for (i = 0; i < z->typecnt; i++)
+    if (z->types[i].isdst)
+      {
+	_tzname[1] = z->chars + z->types[i].abbr;
+	tz->__tzrule[1].offset = z->types[i].offset;
+	_daylight = 1;
+      }
+    else
+      {
+	_tzname[0] = z->chars + z->types[i].abbr;
+	tz->__tzrule[0].offset = z->types[i].offset;
+      }
+  _timezone = tz->__tzrule[0].offset;
+}
+
+/* Return the index of the first transition of zone z after time t.  */
+static int
+search (const struct __tzzone *z,
+	__int64_t t)
+{
+  int lo = 0, hi = z->timecnt, mid;
+
+  while (lo < hi)
+    {
+      mid = lo + (hi - lo) / 2;
+      if (z->ats[mid] <= t)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* The type in effect before transition i.  */
+#define BEFORE(z, i)	((i) > 0 ? &(z)->types[(z)->idx[(i) - 1]] \
+			 : &(z)->types[0])
+
+/* Return the type in effect at time t in zone z, or NULL if t is after the
+   last transition and z has a TZ string for it.  */
+static const struct __tztype *
+lookup (const struct __tzzone *z,
+	__int64_t t)
+{
+  int i = search (z, t);
+
+  if (i == z->timecnt && z->rule != NULL)
+    return NULL;
+  return BEFORE (z, i);
+}
+
+/* If the current zone covers time t without its TZ string, set *offset
+   and *isdst for it and return 1.  */
+int
+__tzfile_localtime (time_t t,
+	long *offset,
+	int *isdst)
+{
+  const struct __tztype *type;
+
+  if (__tzzone == NULL || (type = lookup (__tzzone, t)) == NULL)
+    return 0;
+  *offset = type->offset;
+  *isdst = type->isdst;
+  return 1;
+}
+
+/* Convert local time tim to UTC in *utc for mktime, if the current zone
+   covers it without its TZ string.  Of the types that could give tim,
+   prefer one with DST as given by tm_isdst, or without DST if tm_isdst
+   is negative.  If there is none, tim is in a gap and the type before
+   the gap is used, unless tm_isdst asks for another type.  Return 1 and
+   the type in effect at *utc in *offset and *isdst; the local time they
+   give differs from tim if tim was in a gap or tm_isdst was wrong.  */
+int
+__tzfile_mktime (time_t tim,
+	int tm_isdst,
+	time_t *utc,
+	long *offset,
+	int *isdst)
+{
+  const struct __tzzone *z = __tzzone;
+  const struct __tztype *type, *cand[3], *best = NULL;
+  int want = tm_isdst > 0, i, lo, n = 0;
+
+  if (z == NULL)
+    return 0;
+
+  /* UTC offsets are less than a day, so the types in effect from a day
+     before to a day after tim include all that could give tim.  */
+  lo = search (z, (__int64_t) tim - 2 * SECSPERDAY);
+  cand[n++] = BEFORE (z, lo);
+  for (i = lo; i < z->timecnt && i < lo + 2
+       && z->ats[i] <= (__int64_t) tim + 2 * SECSPERDAY; i++)
+    cand[n++] = &z->types[z->idx[i]];
+
+  for (i = 0; i < n; i++)
+    {
+      if ((type = lookup (z, (__int64_t) tim + cand[i]->offset)) == NULL)
+	return 0;
+      if (type->offset == cand[i]->offset && type->isdst == cand[i]->isdst
+	  && (best == NULL || (best->isdst != want && type->isdst == want)))
+	best = cand[i];
+    }
+  if (tm_isdst >= 0 && (best == NULL || best->isdst != want))
+    {
+      /* Use the offset of the last type with the given DST before.  */
+      for (i = lo + n - 1; i >= 0; i--)
+	if (BEFORE (z, i)->isdst == want)
+	  {
+	    best = BEFORE (z, i);
+	    break;
+	  }
+    }
+  if (best == NULL)
+    best = cand[0];
+
+  *utc = tim + best->offset;
+  if ((type = lookup (z, *utc)) == NULL)
+    return 0;
+  *offset = type->offset;
+  *isdst = type->isdst;
+  return 1;
+}
+
+#endif /* _WANT_TZFILE */
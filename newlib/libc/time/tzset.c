@@ -92,6 +92,21 @@ Note that there is no white-space padding between fields. Also note that
 if <[TZ]> is null, the default is Universal Time which has no daylight saving
 time. If <[TZ]> is empty, the default EST5EDT is used.
 
+If newlib is configured with <<--enable-newlib-tzfile>>, <[TZ]> may also
+name a time zone information (TZif) file, optionally preceded by ':'.
+A relative name is looked up in the directory given by the <[TZDIR]>
+environment variable, or else in the directory chosen at configuration
+time, /usr/share/zoneinfo by default.  The transitions in the file are
+then used by <<localtime>> and <<mktime>>, and the POSIX string at the
+end of the file, if any, for later times and for the variables above.
+If there is no such file, <[TZ]> is parsed as above.
+
+<<localtime>>, <<mktime>> and <<strftime>> call <<tzset>> themselves,
+but look up <[TZ]> again only after a call to <<setenv>>, <<putenv>> or
+<<unsetenv>>, or after <<environ>> has been replaced.  A program that
+changes <[TZ]> by editing the <<environ>> array in place must call
+<<tzset>> itself.
+
 The function <<_tzset_r>> is identical to <<tzset>> only it is reentrant
 and is used for applications that use multiple threads.
 
@@ -107,18 +122,51 @@ Supporting OS subroutine required: None
 #include <_ansi.h>
 #include <reent.h>
 #include <time.h>
+#include "envlock.h"
 #include "local.h"
 
+extern char **environ;
+
+#ifndef __SINGLE_THREAD__
+unsigned int __tz_seq;
+#endif
+
+/* The environment generation and environ when TZ was last read.  */
+static unsigned int tz_env_gen;
+static char **tz_environ;
+static int tz_env_valid;
+
+/* Return nonzero if TZ may have changed since it was last read, which
+   is when setenv, putenv or unsetenv have been called or environ has
+   been replaced.  */
+int
+__tz_stale (void)
+{
+  return !tz_env_valid
+    || __atomic_load_n (&__env_gen, __ATOMIC_ACQUIRE) != tz_env_gen
+    || environ != tz_environ;
+}
+
+static void
+tzset_env (void)
+{
+  tz_env_gen = __atomic_load_n (&__env_gen, __ATOMIC_ACQUIRE);
+  tz_environ = environ;
+  _tzset_unlocked_r (_REENT);
+  tz_env_valid = 1;
+}
+
 void
 _tzset_unlocked (void)
 {
-  _tzset_unlocked_r (_REENT);
+  if (__tz_stale ())
+    tzset_env ();
 }
 
 void
 tzset (void)
 {
   TZ_LOCK;
-  _tzset_unlocked_r (_REENT);
+  tzset_env ();
   TZ_UNLOCK;
 }
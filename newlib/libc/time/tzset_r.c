@@ -37,6 +37,9 @@ _tzset_unlocked_r (struct _reent *reent_ptr)
 	tz->__tzrule[1] = default_tzrule;
 	free(prev_tzenv);
 	prev_tzenv = NULL;
+#ifdef _WANT_TZFILE
+	__tzzone = NULL;
+#endif
 	return;
       }
 
@@ -56,6 +59,19 @@ _tzset_unlocked_r (struct _reent *reent_ptr)
   tz->__tzrule[0] = default_tzrule;
   tz->__tzrule[1] = default_tzrule;
 
+#ifdef _WANT_TZFILE
+  /* a zone file, whose TZ string if any gives the current rules */
+  if ((__tzzone = __tzfile_load (reent_ptr, tzenv)) != NULL)
+    {
+      if (__tzzone->rule == NULL)
+	{
+	  __tzfile_setnames (__tzzone);
+	  return;
+	}
+      tzenv = __tzzone->rule;
+    }
+#endif
+
   /* ignore implementation-specific format specifier */
   if (*tzenv == ':')
     ++tzenv;  
@@ -0,0 +1,56 @@
+/* Vector exp, the code of exp.c on V_ND lanes.  Arguments whose result
+   may overflow or underflow, and tiny ones, go to the scalar function.
+   Include v_math.h first.  */
+
+#if EXP_POLY_ORDER != 5 || EXP_USE_TOINT_NARROW
+# error "v_exp.h does not match the configuration of exp.c"
+#endif
+
+#define N (1 << EXP_TABLE_BITS)
+
+V_SPECIAL_F64 (exp)
+
+static inline v_f64_t
+v_exp (v_f64_t x)
+{
+  v_u64_t abstop = ((v_u64_t) x >> 52) & 0x7ff, ki, idx, sbits;
+  v_s64_t special;
+  v_f64_t kd, z, r, r2, scale, tail, tmp, y;
+
+  special = abstop - (asuint64 (0x1p-54) >> 52)
+	    >= (asuint64 (512.0) >> 52) - (asuint64 (0x1p-54) >> 52);
+
+  /* exp(x) = 2^(k/N) * exp(r), with exp(r) in [2^(-1/2N),2^(1/2N)].  */
+  /* x = ln2/N*k + r, with int k and r in [-ln2/2N, ln2/2N].  */
+  z = __exp_data.invln2N * x;
+#if TOINT_INTRINSICS
+  kd = v_roundtoint (z);
+  ki = (v_u64_t) V_CONVERT (kd, v_s64_t);
+#else
+  kd = z + __exp_data.shift;
+  ki = (v_u64_t) kd;
+  kd -= __exp_data.shift;
+#endif
+  r = x + kd * __exp_data.negln2hiN + kd * __exp_data.negln2loN;
+  /* 2^(k/N) ~= scale * (1 + tail).  */
+  idx = 2 * (ki % N);
+#define TAIL(j) __exp_data.tab[idx[j]]
+#define SBITS(j) __exp_data.tab[idx[j] + 1]
+  tail = (v_f64_t) (v_u64_t) V_LANES (V_ND, TAIL);
+  sbits = (v_u64_t) V_LANES (V_ND, SBITS);
+#undef TAIL
+#undef SBITS
+  sbits += ki << (52 - EXP_TABLE_BITS);
+  r2 = r * r;
+  tmp = tail + r + r2 * (__exp_data.poly[5 - EXP_POLY_ORDER]
+			 + r * __exp_data.poly[6 - EXP_POLY_ORDER])
+	+ r2 * r2 * (__exp_data.poly[7 - EXP_POLY_ORDER]
+		     + r * __exp_data.poly[8 - EXP_POLY_ORDER]);
+  scale = (v_f64_t) sbits;
+  y = scale + scale * tmp;
+  if (__builtin_expect (v_any64 (special), 0))
+    return exp_special (special, x, y);
+  return y;
+}
+
+#undef N
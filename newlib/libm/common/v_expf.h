@@ -0,0 +1,77 @@
+/* Vector expf and exp2f, the code of sf_exp.c and sf_exp2.c on V_NF lanes.
+   Include v_math.h first.  */
+
+#define N (1 << EXP2F_TABLE_BITS)
+#define T __exp2f_data.tab
+
+/* 2^(k/N) * (1 + the polynomial C in R) for ki = k, in double.  */
+static inline v_f64w_t
+v_exp2f_tail (v_f64w_t r, v_u64w_t ki, const double *C)
+{
+#define TAB(j) T[ki[j] % N]
+  v_u64w_t t = V_LANES (V_NF, TAB);
+#undef TAB
+  v_f64w_t z, r2, y, s;
+
+  t += ki << (52 - EXP2F_TABLE_BITS);
+  s = (v_f64w_t) t;
+  z = C[0] * r + C[1];
+  r2 = r * r;
+  y = C[2] * r + 1;
+  y = z * r2 + y;
+  return y * s;
+}
+
+V_SPECIAL_F32 (expf)
+
+static inline v_f32_t
+v_expf (v_f32_t x)
+{
+  v_u32_t abstop = ((v_u32_t) x >> 20) & 0x7ff;
+  v_s32_t special = abstop >= (asuint (88.0f) >> 20);
+  v_f64w_t xd, z, kd;
+  v_u64w_t ki;
+  v_f32_t y;
+
+  /* x*N/Ln2 = k + r with r in [-1/2, 1/2] and int k.  */
+  xd = V_CONVERT (x, v_f64w_t);
+  z = __exp2f_data.invln2_scaled * xd;
+#if TOINT_INTRINSICS
+  kd = v_roundtoint_w (z);
+  ki = (v_u64w_t) V_CONVERT (kd, v_s64w_t);
+#else
+  kd = z + __exp2f_data.shift;
+  ki = (v_u64w_t) kd;
+  kd -= __exp2f_data.shift;
+#endif
+  y = V_CONVERT (v_exp2f_tail (z - kd, ki, __exp2f_data.poly_scaled),
+		 v_f32_t);
+  if (__builtin_expect (v_any32 (special), 0))
+    return expf_special (special, x, y);
+  return y;
+}
+
+V_SPECIAL_F32 (exp2f)
+
+static inline v_f32_t
+v_exp2f (v_f32_t x)
+{
+  v_u32_t abstop = ((v_u32_t) x >> 20) & 0x7ff;
+  v_s32_t special = abstop >= (asuint (128.0f) >> 20);
+  v_f64w_t xd, kd;
+  v_u64w_t ki;
+  v_f32_t y;
+
+  /* x = k/N + r with r in [-1/(2N), 1/(2N)] and int k.  */
+  xd = V_CONVERT (x, v_f64w_t);
+  kd = xd + __exp2f_data.shift_scaled;
+  ki = (v_u64w_t) kd;
+  kd -= __exp2f_data.shift_scaled;
+  y = V_CONVERT (v_exp2f_tail (xd - kd, ki, __exp2f_data.poly), v_f32_t);
+  if (__builtin_expect (v_any32 (special), 0))
+    return exp2f_special (special, x, y);
+  return y;
+}
+
+#undef N
+#undef T
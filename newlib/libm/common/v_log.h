@@ -0,0 +1,103 @@
+/* Vector log, the code of log.c on V_ND lanes.  Zero, negative, subnormal
+   and non-finite arguments go to the scalar function.  Include v_math.h
+   first.  */
+
+#if LOG_POLY_ORDER != 6 || LOG_POLY1_ORDER != 12 || LOG_TABLE_BITS <= 6
+# error "v_log.h does not match the configuration of log.c"
+#endif
+
+#define B __log_data.poly1
+#define A __log_data.poly
+#define N (1 << LOG_TABLE_BITS)
+#define OFF 0x3fe6000000000000
+#define LO asuint64 (1.0 - 0x1p-4)
+#define HI asuint64 (1.0 + 0x1.09p-4)
+
+V_SPECIAL_F64 (log)
+
+static inline v_f64_t
+v_log (v_f64_t x)
+{
+  v_u64_t ix = (v_u64_t) x, top = ix >> 48, tmp, iz, i;
+  v_s64_t special, near1;
+  v_f64_t w, z, r, r2, r3, y, y1, invc, logc, kd, hi, lo, rhi, rlo;
+
+  special = top - 0x0010 >= 0x7ff0 - 0x0010;
+  near1 = ix - LO < HI - LO;
+
+  /* x = 2^k z; where z is in range [OFF,2*OFF) and exact.
+     The range is split into N subintervals.
+     The ith subinterval contains z and c is near its center.  */
+  tmp = ix - OFF;
+  i = (tmp >> (52 - LOG_TABLE_BITS)) % N;
+  iz = ix - (tmp & 0xfffULL << 52);
+#define INVC(j) __log_data.tab[i[j]].invc
+#define LOGC(j) __log_data.tab[i[j]].logc
+  invc = (v_f64_t) V_LANES (V_ND, INVC);
+  logc = (v_f64_t) V_LANES (V_ND, LOGC);
+#if !HAVE_FAST_FMA
+# define CHI(j) __log_data.tab2[i[j]].chi
+# define CLO(j) __log_data.tab2[i[j]].clo
+  w = (v_f64_t) V_LANES (V_ND, CHI);
+  lo = (v_f64_t) V_LANES (V_ND, CLO);
+# undef CHI
+# undef CLO
+#endif
+#undef INVC
+#undef LOGC
+  z = (v_f64_t) iz;
+
+  /* log(x) = log1p(z/c-1) + log(c) + k*Ln2.  */
+  /* r ~= z/c - 1, |r| < 1/(2*N).  */
+#if HAVE_FAST_FMA
+  r = v_fma (z, invc, (v_f64_t) {} - 1.0);
+#else
+  r = (z - w - lo) * invc;
+#endif
+  kd = V_CONVERT ((v_s64_t) tmp >> 52, v_f64_t);
+
+  /* hi + lo = r + log(c) + k*Ln2.  */
+  w = kd * __log_data.ln2hi + logc;
+  hi = w + r;
+  lo = w - hi + r + kd * __log_data.ln2lo;
+
+  /* log(x) = lo + (log1p(r) - r) + hi.  */
+  r2 = r * r;
+  y = lo + r2 * A[0] + r * r2 * (A[1] + r * A[2] + r2 * (A[3] + r * A[4]))
+      + hi;
+
+  if (__builtin_expect (v_any64 (near1), 0))
+    {
+      /* Close to 1.0, log(x) = log1p(x-1) directly.  */
+      r = x - 1.0;
+      r2 = r * r;
+      r3 = r * r2;
+      y1 = r3 * (B[1] + r * B[2] + r2 * B[3]
+		 + r3 * (B[4] + r * B[5] + r2 * B[6]
+			 + r3 * (B[7] + r * B[8] + r2 * B[9] + r3 * B[10])));
+      w = r * 0x1p27;
+      rhi = r + w - w;
+      rlo = r - rhi;
+      w = rhi * rhi * B[0]; /* B[0] == -0.5.  */
+      hi = r + w;
+      lo = r - hi + w;
+      lo += B[0] * rlo * (rhi + r);
+      y1 += lo;
+      y1 += hi;
+      y = v_sel_f64 (near1, y1, y);
+    }
+#if WANT_ROUNDING
+  /* Fix sign of zero with downward rounding when x==1.  */
+  y = v_sel_f64 (ix == asuint64 (1.0), (v_f64_t) {}, y);
+#endif
+  if (__builtin_expect (v_any64 (special), 0))
+    return log_special (special, x, y);
+  return y;
+}
+
+#undef A
+#undef B
+#undef N
+#undef OFF
+#undef LO
+#undef HI
@@ -0,0 +1,49 @@
+/* Vector logf, the code of sf_log.c on V_NF lanes.  Include v_math.h
+   first.  */
+
+#define N (1 << LOGF_TABLE_BITS)
+#define OFF 0x3f330000
+
+V_SPECIAL_F32 (logf)
+
+static inline v_f32_t
+v_logf (v_f32_t x)
+{
+  v_u32_t ix = (v_u32_t) x, tmp, iz, i;
+  v_s32_t special = ix - 0x00800000 >= 0x7f800000 - 0x00800000;
+  v_f64w_t z, r, r2, y, y0, invc, logc;
+  v_f32_t res;
+
+  /* x = 2^k z; where z is in range [OFF,2*OFF] and exact.  */
+  tmp = ix - OFF;
+  i = (tmp >> (23 - LOGF_TABLE_BITS)) % N;
+  iz = ix - (tmp & 0x1ffu << 23);
+#define INVC(j) __logf_data.tab[i[j]].invc
+#define LOGC(j) __logf_data.tab[i[j]].logc
+  invc = (v_f64w_t) V_LANES (V_NF, INVC);
+  logc = (v_f64w_t) V_LANES (V_NF, LOGC);
+#undef INVC
+#undef LOGC
+  z = V_CONVERT ((v_f32_t) iz, v_f64w_t);
+
+  /* log(x) = log1p(z/c-1) + log(c) + k*Ln2 */
+  r = z * invc - 1;
+  y0 = logc + V_CONVERT ((v_s32_t) tmp >> 23, v_f64w_t) * __logf_data.ln2;
+
+  /* Pipelined polynomial evaluation to approximate log1p(r).  */
+  r2 = r * r;
+  y = __logf_data.poly[1] * r + __logf_data.poly[2];
+  y = __logf_data.poly[0] * r2 + y;
+  y = y * r2 + (y0 + r);
+  res = V_CONVERT (y, v_f32_t);
+#if WANT_ROUNDING
+  /* Fix sign of zero with downward rounding when x==1.  */
+  res = v_sel_f32 (ix == 0x3f800000, (v_f32_t) {}, res);
+#endif
+  if (__builtin_expect (v_any32 (special), 0))
+    return logf_special (special, x, res);
+  return res;
+}
+
+#undef N
+#undef OFF
@@ -0,0 +1,200 @@
+/* Generic vector code for the vector variants of math functions.
+
+   Before including this file define V_NF, the number of lanes of the
+   float functions (2 or 4), and V_ND, that of the double functions.
+   The float functions compute in double, so V_NF is best the number
+   of doubles in a vector register; v_lo, v_hi and v_join let a
+   variant of twice as many float lanes do them in two halves.  Then
+   include the v_*.h files of the functions wanted; each defines a
+   static inline function, such as v_expf, that the target code wraps
+   under the name its vector function ABI gives the variant.
+
+   The vector code is the scalar code done on all lanes at once, using
+   the GCC vector extensions, with the tables of the scalar code looked
+   up lane by lane.  Results are the same as those of the scalar
+   functions, and so are the ULP error bounds.  Lanes that the scalar
+   code would handle in a special case (overflow, underflow, NaN, zero,
+   large arguments to sinf and cosf, and the like) are recomputed by
+   calling the scalar function, which also sets errno.  */
+
+#ifndef _V_MATH_H
+#define _V_MATH_H
+
+#include <math.h>
+#include <stdint.h>
+#include "math_config.h"
+
+#define V_VEC(t, lanes) __attribute__ ((__vector_size__ ((lanes) * sizeof (t))))
+
+/* Float lanes; the same lanes widened to 64 bits; and double lanes.  */
+typedef float v_f32_t V_VEC (float, V_NF);
+typedef uint32_t v_u32_t V_VEC (uint32_t, V_NF);
+typedef int32_t v_s32_t V_VEC (int32_t, V_NF);
+typedef double v_f64w_t V_VEC (double, V_NF);
+typedef uint64_t v_u64w_t V_VEC (uint64_t, V_NF);
+typedef int64_t v_s64w_t V_VEC (int64_t, V_NF);
+typedef double v_f64_t V_VEC (double, V_ND);
+typedef uint64_t v_u64_t V_VEC (uint64_t, V_ND);
+typedef int64_t v_s64_t V_VEC (int64_t, V_ND);
+/* Twice as many float lanes, for variants that do two halves.  */
+#if V_NF == 2
+# define V_NF2 4
+#elif V_NF == 4
+# define V_NF2 8
+#else
+# error "unsupported V_NF"
+#endif
+typedef float v_f32x2_t V_VEC (float, V_NF2);
+
+#define V_CONVERT(x, t) __builtin_convertvector (x, t)
+
+/* The initializer of a vector of N lanes, lane J of which is E (J).
+   Table lookups are written this way rather than as loops over the
+   lanes, which GCC may vectorize in part and then store and reload
+   through the stack.  */
+#define V_LANES(n, e) V_LANES_ (n, e)
+#define V_LANES_(n, e) V_LANES_##n (e)
+#define V_LANES_2(e) { e (0), e (1) }
+#define V_LANES_4(e) { e (0), e (1), e (2), e (3) }
+#define V_LANES_8(e) { e (0), e (1), e (2), e (3), e (4), e (5), e (6), e (7) }
+
+/* Nonzero if any lane of mask M is set.  */
+static inline int
+v_any32 (v_s32_t m)
+{
+  int32_t r = 0;
+  int i;
+
+  for (i = 0; i < V_NF; i++)
+    r |= m[i];
+  return r != 0;
+}
+
+static inline int
+v_any64 (v_s64_t m)
+{
+  int64_t r = 0;
+  int i;
+
+  for (i = 0; i < V_ND; i++)
+    r |= m[i];
+  return r != 0;
+}
+
+/* The lanes of X where mask M is set, and those of Y elsewhere.  */
+static inline v_f32_t
+v_sel_f32 (v_s32_t m, v_f32_t x, v_f32_t y)
+{
+  return (v_f32_t) (((v_s32_t) x & m) | ((v_s32_t) y & ~m));
+}
+
+static inline v_f64_t
+v_sel_f64 (v_s64_t m, v_f64_t x, v_f64_t y)
+{
+  return (v_f64_t) (((v_s64_t) x & m) | ((v_s64_t) y & ~m));
+}
+
+static inline v_f64w_t
+v_sel_f64w (v_s64w_t m, v_f64w_t x, v_f64w_t y)
+{
+  return (v_f64w_t) (((v_s64w_t) x & m) | ((v_s64w_t) y & ~m));
+}
+
+/* The low and high halves of X, and the vector of halves L and H.  */
+#define V_LO(j) x[j]
+#define V_HI(j) x[V_NF + (j)]
+#define V_JOIN(j) ((j) < V_NF ? l[(j) % V_NF] : h[(j) % V_NF])
+
+static inline v_f32_t
+v_lo (v_f32x2_t x)
+{
+  return (v_f32_t) V_LANES (V_NF, V_LO);
+}
+
+static inline v_f32_t
+v_hi (v_f32x2_t x)
+{
+  return (v_f32_t) V_LANES (V_NF, V_HI);
+}
+
+static inline v_f32x2_t
+v_join (v_f32_t l, v_f32_t h)
+{
+  return (v_f32x2_t) V_LANES (V_NF2, V_JOIN);
+}
+
+#undef V_LO
+#undef V_HI
+#undef V_JOIN
+
+#if TOINT_INTRINSICS
+/* Vector versions of roundtoint and converttoint.  */
+static inline v_f64w_t
+v_roundtoint_w (v_f64w_t x)
+{
+  int i;
+
+  for (i = 0; i < V_NF; i++)
+    x[i] = roundtoint (x[i]);
+  return x;
+}
+
+static inline v_f64_t
+v_roundtoint (v_f64_t x)
+{
+  int i;
+
+  for (i = 0; i < V_ND; i++)
+    x[i] = roundtoint (x[i]);
+  return x;
+}
+#endif
+
+#if HAVE_FAST_FMA
+static inline v_f64_t
+v_fma (v_f64_t x, v_f64_t y, v_f64_t z)
+{
+  int i;
+
+  for (i = 0; i < V_ND; i++)
+    x[i] = __builtin_fma (x[i], y[i], z[i]);
+  return x;
+}
+#endif
+
+/* Define F_special, which recomputes the lanes of Y where SPECIAL is
+   set with the scalar function F of the lanes of X (and Z).  */
+#define V_SPECIAL_F32(f) \
+  static NOINLINE v_f32_t \
+  f##_special (v_s32_t special, v_f32_t x, v_f32_t y) \
+  { \
+    int i; \
+    for (i = 0; i < V_NF; i++) \
+      if (special[i]) \
+	y[i] = f (x[i]); \
+    return y; \
+  }
+
+#define V_SPECIAL_F32_2(f) \
+  static NOINLINE v_f32_t \
+  f##_special (v_s32_t special, v_f32_t x, v_f32_t z, v_f32_t y) \
+  { \
+    int i; \
+    for (i = 0; i < V_NF; i++) \
+      if (special[i]) \
+	y[i] = f (x[i], z[i]); \
+    return y; \
+  }
+
+#define V_SPECIAL_F64(f) \
+  static NOINLINE v_f64_t \
+  f##_special (v_s64_t special, v_f64_t x, v_f64_t y) \
+  { \
+    int i; \
+    for (i = 0; i < V_ND; i++) \
+      if (special[i]) \
+	y[i] = f (x[i]); \
+    return y; \
+  }
+
+#endif /* _V_MATH_H */
@@ -0,0 +1,74 @@
+/* Vector powf, the code of sf_pow.c on V_NF lanes.  Only positive normal
+   x and y other than zero, infinity and NaN are handled in the vector
+   code; include v_math.h and v_expf.h first.  */
+
+#define N (1 << POWF_LOG2_TABLE_BITS)
+#define OFF 0x3f330000
+
+V_SPECIAL_F32_2 (powf)
+
+static inline v_f32_t
+v_powf (v_f32_t x, v_f32_t y)
+{
+  v_u32_t ix = (v_u32_t) x, iy = (v_u32_t) y, tmp, top, iz, i;
+  v_s32_t special;
+  v_f64w_t z, r, r2, r4, p, q, l, l0, invc, logc, ylogx, kd;
+  v_u64w_t ki;
+  v_f32_t res;
+
+  /* x < 0x1p-126 or inf or nan, or y is 0 or inf or nan.  */
+  special = (ix - 0x00800000 >= 0x7f800000 - 0x00800000)
+	    | (2 * iy - 1 >= 2u * 0x7f800000 - 1);
+
+  /* log2(x), scaled by POWF_SCALE: x = 2^k z; where z is in range
+     [OFF,2*OFF] and exact.  */
+  tmp = ix - OFF;
+  i = (tmp >> (23 - POWF_LOG2_TABLE_BITS)) % N;
+  top = tmp & 0xff800000;
+  iz = ix - top;
+#define INVC(j) __powf_log2_data.tab[i[j]].invc
+#define LOGC(j) __powf_log2_data.tab[i[j]].logc
+  invc = (v_f64w_t) V_LANES (V_NF, INVC);
+  logc = (v_f64w_t) V_LANES (V_NF, LOGC);
+#undef INVC
+#undef LOGC
+  z = V_CONVERT ((v_f32_t) iz, v_f64w_t);
+
+  /* log2(x) = log1p(z/c-1)/ln2 + log2(c) + k */
+  r = z * invc - 1;
+  l0 = logc + V_CONVERT ((v_s32_t) top >> (23 - POWF_SCALE_BITS), v_f64w_t);
+
+  /* Pipelined polynomial evaluation to approximate log1p(r)/ln2.  */
+  r2 = r * r;
+  l = __powf_log2_data.poly[0] * r + __powf_log2_data.poly[1];
+  p = __powf_log2_data.poly[2] * r + __powf_log2_data.poly[3];
+  r4 = r2 * r2;
+  q = __powf_log2_data.poly[4] * r + l0;
+  q = p * r2 + q;
+  l = l * r4 + q;
+
+  /* |y*log(x)| >= 126 overflows or underflows, or may.  */
+  ylogx = V_CONVERT (y, v_f64w_t) * l;
+  special |= V_CONVERT (((v_u64w_t) ylogx >> 47 & 0xffff)
+			>= asuint64 (126.0 * POWF_SCALE) >> 47, v_s32_t);
+
+  /* exp2(ylogx), where N*x = k + r with r in [-1/2, 1/2], or
+     x = k/N + r with r in [-1/(2N), 1/(2N)].  */
+#if TOINT_INTRINSICS
+  kd = v_roundtoint_w (ylogx);
+  ki = (v_u64w_t) V_CONVERT (kd, v_s64w_t);
+  res = V_CONVERT (v_exp2f_tail (ylogx - kd, ki, __exp2f_data.poly_scaled),
+		   v_f32_t);
+#else
+  kd = ylogx + __exp2f_data.shift_scaled;
+  ki = (v_u64w_t) kd;
+  kd -= __exp2f_data.shift_scaled;
+  res = V_CONVERT (v_exp2f_tail (ylogx - kd, ki, __exp2f_data.poly), v_f32_t);
+#endif
+  if (__builtin_expect (v_any32 (special), 0))
+    return powf_special (special, x, y, res);
+  return res;
+}
+
+#undef N
+#undef OFF
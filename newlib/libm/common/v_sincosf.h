@@ -0,0 +1,90 @@
+/* Vector sinf and cosf, the code of sinf.c and cosf.c on V_NF lanes.
+   Arguments of magnitude 120 or more go to the scalar functions.
+   Include v_math.h first.  */
+
+#include "sincosf.h"
+
+/* Reduce X, with |X| < 120, to R in [-PI/4, PI/4] and the quadrant N
+   as reduce_fast does, and compute the polynomials of sinf_poly for
+   both the sine and cosine of R.  The second entry of __sincosf_table,
+   used when N & 2, negates the cosine polynomial; this is done on the
+   result instead, which is exact.  */
+static inline void
+v_sincosf_poly (v_f32_t y, v_f64w_t *sinp, v_f64w_t *cosp, v_s32_t *np)
+{
+  const sincos_t *p = &__sincosf_table[0];
+  v_f64w_t x = V_CONVERT (y, v_f64w_t), x2, x3, x4, x6, x7, s, c, c1, c2, s1;
+  v_s64w_t n;
+  v_u64w_t neg;
+
+#if TOINT_INTRINSICS
+  v_f64w_t r = v_roundtoint_w (x * p->hpi_inv);
+  n = V_CONVERT (r, v_s64w_t);
+  x = x - r * p->hpi;
+#else
+  v_f64w_t r = x * p->hpi_inv;
+  n = V_CONVERT ((V_CONVERT (r, v_s32_t) + 0x800000) >> 24, v_s64w_t);
+  x = x - V_CONVERT (n, v_f64w_t) * p->hpi;
+#endif
+  x2 = x * x;
+
+  /* The sine is negated in quadrants 1 and 2 (sign[n & 3]).  */
+  neg = (v_u64w_t) ((n ^ (n >> 1)) & 1) << 63;
+  x = (v_f64w_t) ((v_u64w_t) x ^ neg);
+  x3 = x * x2;
+  s1 = p->s2 + x2 * p->s3;
+  x7 = x3 * x2;
+  s = x + x3 * p->s1;
+  *sinp = s + x7 * s1;
+
+  x4 = x2 * x2;
+  c2 = p->c3 + x2 * p->c4;
+  c1 = p->c0 + x2 * p->c1;
+  x6 = x4 * x2;
+  c = c1 + x4 * p->c2;
+  neg = (v_u64w_t) (n & 2) << 62;
+  *cosp = (v_f64w_t) ((v_u64w_t) (c + x6 * c2) ^ neg);
+  *np = V_CONVERT (n, v_s32_t);
+}
+
+V_SPECIAL_F32 (sinf)
+
+static inline v_f32_t
+v_sinf (v_f32_t y)
+{
+  v_u32_t abstop = ((v_u32_t) y >> 20) & 0x7ff;
+  v_s32_t special = abstop >= abstop12 (120.0f), n;
+  v_f64w_t s, c;
+  v_f32_t res;
+
+  v_sincosf_poly (y, &s, &c, &n);
+  /* In odd quadrants the cosine polynomial is used.  */
+  res = V_CONVERT (v_sel_f64w (V_CONVERT ((n & 1) != 0, v_s64w_t), c, s),
+		   v_f32_t);
+  /* sin(y) = y for tiny y.  */
+  res = v_sel_f32 (abstop < abstop12 (0x1p-12f), y, res);
+  if (__builtin_expect (v_any32 (special), 0))
+    return sinf_special (special, y, res);
+  return res;
+}
+
+V_SPECIAL_F32 (cosf)
+
+static inline v_f32_t
+v_cosf (v_f32_t y)
+{
+  v_u32_t abstop = ((v_u32_t) y >> 20) & 0x7ff;
+  v_s32_t special = abstop >= abstop12 (120.0f), n;
+  v_f64w_t s, c;
+  v_f32_t res;
+
+  v_sincosf_poly (y, &s, &c, &n);
+  /* In odd quadrants the sine polynomial is used.  */
+  res = V_CONVERT (v_sel_f64w (V_CONVERT ((n & 1) != 0, v_s64w_t), s, c),
+		   v_f32_t);
+  /* cos(y) = 1 for tiny y.  */
+  res = v_sel_f32 (abstop < abstop12 (0x1p-12f), (v_f32_t) {} + 1.0f, res);
+  if (__builtin_expect (v_any32 (special), 0))
+    return cosf_special (special, y, res);
+  return res;
+}
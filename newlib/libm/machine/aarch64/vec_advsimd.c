@@ -0,0 +1,50 @@
+/* Vector variants of expf, exp2f, logf, powf, sinf, cosf, exp and log
+   for Advanced SIMD, named _ZGVnN4v_expf, _ZGVnN2v_expf, _ZGVnN2v_exp
+   and so on.  GCC calls these functions from loops it vectorizes when
+   math.h declares the scalar functions with the simd attribute.  The
+   float functions compute in double, so the four lane variants do two
+   halves of two lanes.  */
+
+#include "fdlibm.h"
+#if !__OBSOLETE_MATH && defined (__aarch64__)
+
+#define V_NF 2
+#define V_ND 2
+#include "v_math.h"
+#include "v_expf.h"
+#include "v_logf.h"
+#include "v_powf.h"
+#include "v_sincosf.h"
+#include "v_exp.h"
+#include "v_log.h"
+
+/* The vector function ABI passes vectors in all of v0-v7 and keeps
+   more registers across calls for these functions.  */
+#define VPCS __attribute__ ((aarch64_vector_pcs))
+
+#define V_F32(f) \
+  VPCS v_f32_t _ZGVnN2v_##f (v_f32_t); \
+  VPCS v_f32x2_t _ZGVnN4v_##f (v_f32x2_t); \
+  VPCS v_f32_t _ZGVnN2v_##f (v_f32_t x) { return v_##f (x); } \
+  VPCS v_f32x2_t _ZGVnN4v_##f (v_f32x2_t x) \
+  { return v_join (v_##f (v_lo (x)), v_##f (v_hi (x))); }
+#define V_F32_2(f) \
+  VPCS v_f32_t _ZGVnN2vv_##f (v_f32_t, v_f32_t); \
+  VPCS v_f32x2_t _ZGVnN4vv_##f (v_f32x2_t, v_f32x2_t); \
+  VPCS v_f32_t _ZGVnN2vv_##f (v_f32_t x, v_f32_t y) { return v_##f (x, y); } \
+  VPCS v_f32x2_t _ZGVnN4vv_##f (v_f32x2_t x, v_f32x2_t y) \
+  { return v_join (v_##f (v_lo (x), v_lo (y)), v_##f (v_hi (x), v_hi (y))); }
+#define V_F64(f) \
+  VPCS v_f64_t _ZGVnN2v_##f (v_f64_t); \
+  VPCS v_f64_t _ZGVnN2v_##f (v_f64_t x) { return v_##f (x); }
+
+V_F32 (expf)
+V_F32 (exp2f)
+V_F32 (logf)
+V_F32_2 (powf)
+V_F32 (sinf)
+V_F32 (cosf)
+V_F64 (exp)
+V_F64 (log)
+
+#endif /* !__OBSOLETE_MATH && __aarch64__ */
@@ -0,0 +1,6 @@
+/* Vector variants of expf, exp2f, logf, powf, sinf, cosf, exp and log
+   for AVX, named _ZGVcN8v_expf and so on.  */
+
+#define V_ISA c
+#define V_ND 4
+#include "vec_variants.h"
@@ -0,0 +1,6 @@
+/* Vector variants of expf, exp2f, logf, powf, sinf, cosf, exp and log
+   for AVX2, named _ZGVdN8v_expf and so on.  */
+
+#define V_ISA d
+#define V_ND 4
+#include "vec_variants.h"
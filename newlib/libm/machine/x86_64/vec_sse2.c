@@ -0,0 +1,6 @@
+/* Vector variants of expf, exp2f, logf, powf, sinf, cosf, exp and log
+   for SSE2, named _ZGVbN4v_expf and so on.  */
+
+#define V_ISA b
+#define V_ND 2
+#include "vec_variants.h"
@@ -0,0 +1,50 @@
+/* Vector variants of math functions for x86_64.
+
+   Before including this file define V_ISA to the letter of the vector
+   function ABI for the instruction set the file is compiled for (b for
+   SSE2, c for AVX, d for AVX2) and V_ND to the number of double lanes
+   of its vectors, which hold twice as many float lanes.  GCC calls these
+   functions from loops it vectorizes when math.h declares the scalar
+   functions with the simd attribute.
+
+   The float functions compute in double, so each variant does its
+   vector in two halves of V_ND lanes, which widened to double fill a
+   vector register.  */
+
+#include "fdlibm.h"
+#if !__OBSOLETE_MATH && defined (__x86_64__) && !defined (__ILP32__)
+
+#define V_NF V_ND
+#include "v_math.h"
+#include "v_expf.h"
+#include "v_logf.h"
+#include "v_powf.h"
+#include "v_sincosf.h"
+#include "v_exp.h"
+#include "v_log.h"
+
+#define V_NAME2(isa, lanes, args, f) _ZGV##isa##N##lanes##args##_##f
+#define V_NAME(isa, lanes, args, f) V_NAME2 (isa, lanes, args, f)
+
+#define V_F32(f) \
+  v_f32x2_t V_NAME (V_ISA, V_NF2, v, f) (v_f32x2_t); \
+  v_f32x2_t V_NAME (V_ISA, V_NF2, v, f) (v_f32x2_t x) \
+  { return v_join (v_##f (v_lo (x)), v_##f (v_hi (x))); }
+#define V_F32_2(f) \
+  v_f32x2_t V_NAME (V_ISA, V_NF2, vv, f) (v_f32x2_t, v_f32x2_t); \
+  v_f32x2_t V_NAME (V_ISA, V_NF2, vv, f) (v_f32x2_t x, v_f32x2_t y) \
+  { return v_join (v_##f (v_lo (x), v_lo (y)), v_##f (v_hi (x), v_hi (y))); }
+#define V_F64(f) \
+  v_f64_t V_NAME (V_ISA, V_ND, v, f) (v_f64_t); \
+  v_f64_t V_NAME (V_ISA, V_ND, v, f) (v_f64_t x) { return v_##f (x); }
+
+V_F32 (expf)
+V_F32 (exp2f)
+V_F32 (logf)
+V_F32_2 (powf)
+V_F32 (sinf)
+V_F32 (cosf)
+V_F64 (exp)
+V_F64 (log)
+
+#endif /* !__OBSOLETE_MATH && __x86_64__ && !__ILP32__ */
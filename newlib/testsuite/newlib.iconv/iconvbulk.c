@@ -0,0 +1,189 @@
+/*
+ * Test conversions between UTF-8, UTF-16, UCS-2, UCS-4 and ISO-8859-1 on
+ * text long enough to go through the whole-buffer kernels, with small
+ * output buffers and with invalid input in the middle of ASCII runs.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iconv.h>
+#include <errno.h>
+#include <newlib.h>
+#include "check.h"
+
+#if defined (_ICONV_ENABLED) \
+ && defined (_ICONV_FROM_ENCODING_UTF_8) \
+ && defined (_ICONV_TO_ENCODING_UTF_8) \
+ && defined (_ICONV_FROM_ENCODING_UCS_4BE) \
+ && defined (_ICONV_TO_ENCODING_UCS_4BE) \
+ && defined (_ICONV_TO_ENCODING_UTF_16LE) \
+ && defined (_ICONV_FROM_ENCODING_UTF_16LE) \
+ && defined (_ICONV_TO_ENCODING_UCS_2BE) \
+ && defined (_ICONV_TO_ENCODING_ISO_8859_1)
+
+#define MAXCHARS 400
+
+static unsigned long text[MAXCHARS];
+static int ntext;
+
+static size_t
+put_utf8 (unsigned char *p, unsigned long c)
+{
+  if (c < 0x80)
+    {
+      p[0] = c;
+      return 1;
+    }
+  if (c < 0x800)
+    {
+      p[0] = 0xC0 | c >> 6;
+      p[1] = 0x80 | (c & 0x3F);
+      return 2;
+    }
+  if (c < 0x10000)
+    {
+      p[0] = 0xE0 | c >> 12;
+      p[1] = 0x80 | (c >> 6 & 0x3F);
+      p[2] = 0x80 | (c & 0x3F);
+      return 3;
+    }
+  p[0] = 0xF0 | c >> 18;
+  p[1] = 0x80 | (c >> 12 & 0x3F);
+  p[2] = 0x80 | (c >> 6 & 0x3F);
+  p[3] = 0x80 | (c & 0x3F);
+  return 4;
+}
+
+/* Convert LEN bytes at IN from FROM to TO, giving iconv at most STEP
+   bytes of output at a time.  Returns the length of the output, or -1
+   with errno set and *STOP the number of bytes of input converted.  */
+static long
+convert (const char *to, const char *from, const void *in, size_t len,
+	 void *out, size_t size, size_t step, size_t *stop)
+{
+  iconv_t cd = iconv_open (to, from);
+  char *inp = (char *) in, *outp = (char *) out;
+  size_t inleft = len, outleft, r;
+  int err = 0;
+
+  CHECK (cd != (iconv_t) -1);
+  while (inleft > 0)
+    {
+      outleft = step;
+      if (outleft > size - (outp - (char *) out))
+	outleft = size - (outp - (char *) out);
+      r = iconv (cd, &inp, &inleft, &outp, &outleft);
+      if (r == (size_t) -1 && errno != E2BIG)
+	{
+	  err = errno;
+	  break;
+	}
+      CHECK (r != (size_t) -1 || outleft < 6);
+    }
+  iconv_close (cd);
+  *stop = inp - (char *) in;
+  errno = err;
+  return err ? -1 : outp - (char *) out;
+}
+
+int
+main (void)
+{
+  static unsigned char utf8[MAXCHARS * 4], buf[MAXCHARS * 4 + 4];
+  static unsigned char buf2[MAXCHARS * 4];
+  static const unsigned long samples[] = {
+    0xE9, 0x416, 0x4E2D, 0x1F600, 0x7F, 0x80, 0x7FF, 0x800, 0xFFFD,
+    0x10000, 0x10FFFF
+  };
+  static const size_t steps[] = { 1000000, 4, 5, 7 };
+  size_t n8, stop, k;
+  long n;
+  int i;
+
+  /* ASCII runs of varying length with other characters in between */
+  for (i = 0; ntext < MAXCHARS - 1; i++)
+    {
+      int run = (i * 7) % 40;
+
+      for (; run > 0 && ntext < MAXCHARS - 1; run--, ntext++)
+	text[ntext] = 'a' + ntext % 26;
+      text[ntext++] = samples[i % (sizeof (samples) / sizeof (samples[0]))];
+    }
+  for (i = 0, n8 = 0; i < ntext; i++)
+    n8 += put_utf8 (utf8 + n8, text[i]);
+
+  for (k = 0; k < sizeof (steps) / sizeof (steps[0]); k++)
+    {
+      /* UTF-8 -> UCS-4BE */
+      n = convert ("UCS-4BE", "UTF-8", utf8, n8, buf, sizeof (buf),
+		   steps[k], &stop);
+      CHECK (n == ntext * 4);
+      for (i = 0; i < ntext; i++)
+	CHECK (((unsigned long) buf[i * 4] << 24 | buf[i * 4 + 1] << 16
+		| buf[i * 4 + 2] << 8 | buf[i * 4 + 3]) == text[i]);
+
+      /* UCS-4BE -> UTF-8 */
+      n = convert ("UTF-8", "UCS-4BE", buf, ntext * 4, buf2, sizeof (buf2),
+		   steps[k], &stop);
+      CHECK (n == (long) n8 && memcmp (buf2, utf8, n8) == 0);
+
+      /* UTF-8 -> UTF-16LE -> UTF-8 */
+      n = convert ("UTF-16LE", "UTF-8", utf8, n8, buf, sizeof (buf),
+		   steps[k], &stop);
+      CHECK (n > 0);
+      for (i = 0, stop = 0; i < ntext; i++)
+	{
+	  unsigned long c = buf[stop] | buf[stop + 1] << 8;
+
+	  if (c >= 0xD800 && c < 0xDC00)
+	    {
+	      c = (((c & 0x3FF) << 10) | ((buf[stop + 2]
+					    | buf[stop + 3] << 8) & 0x3FF))
+		  + 0x10000;
+	      stop += 2;
+	    }
+	  stop += 2;
+	  CHECK (c == text[i]);
+	}
+      CHECK ((long) stop == n);
+      n = convert ("UTF-8", "UTF-16LE", buf, n, buf2, sizeof (buf2),
+		   steps[k], &stop);
+      CHECK (n == (long) n8 && memcmp (buf2, utf8, n8) == 0);
+    }
+
+  /* Characters that UCS-2 or ISO-8859-1 lack become '?' */
+  n = convert ("UCS-2BE", "UTF-8", utf8, n8, buf, sizeof (buf), 5, &stop);
+  CHECK (n == ntext * 2);
+  for (i = 0; i < ntext; i++)
+    CHECK ((buf[i * 2] << 8 | buf[i * 2 + 1])
+	   == (text[i] < 0x10000 ? text[i] : '?'));
+  n = convert ("ISO-8859-1", "UTF-8", utf8, n8, buf, sizeof (buf), 5, &stop);
+  CHECK (n == ntext);
+  for (i = 0; i < ntext; i++)
+    CHECK (buf[i] == (text[i] < 0x100 ? text[i] : '?'));
+
+  /* A bad byte, and a truncated sequence, after an ASCII run */
+  memset (buf, 'x', 100);
+  buf[70] = 0xFF;
+  n = convert ("UTF-16LE", "UTF-8", buf, 100, buf2, sizeof (buf2), 1000000,
+	       &stop);
+  CHECK (n == -1 && errno == EILSEQ && stop == 70);
+  buf[70] = 0xE4;
+  buf[71] = 0xB8;
+  n = convert ("UCS-4BE", "UTF-8", buf, 72, buf2, sizeof (buf2), 1000000,
+	       &stop);
+  CHECK (n == -1 && errno == EINVAL && stop == 70);
+  CHECK (buf2[4 * 69 + 3] == 'x');
+
+  exit (0);
+}
+
+#else
+
+int
+main (void)
+{
+  exit (0);
+}
+
+#endif
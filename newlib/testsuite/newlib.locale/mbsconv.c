@@ -0,0 +1,267 @@
+/*
+ * Check mbstowcs, mbsnrtowcs, wcstombs and wcsnrtombs against
+ * conversions done one character at a time with mbrtowc and wcrtomb, in
+ * the C and UTF-8 locales and some single-byte ones, on strings long
+ * enough for the whole-string fast paths, with invalid and truncated
+ * sequences among ASCII runs and every limit on the lengths.
+ *
+ * Without _MB_CAPABLE, mbstowcs and wcstombs just copy bytes to wide
+ * characters and back, so there is nothing to check.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include <locale.h>
+#include <wchar.h>
+#include "check.h"
+
+#ifdef _MB_CAPABLE
+
+#define MAXLEN 200
+
+static unsigned long seed = 1;
+
+static unsigned int
+rnd (unsigned int n)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % n;
+}
+
+static char mbs[MAXLEN + 8 + 1];
+static wchar_t wcs[MAXLEN + 1];
+
+static const char *pieces[] = {
+  "\xc3\xa9", "\xd0\x96", "\xe2\x82\xac", "\xe0\xa0\x80", "\xed\xa0\x80",
+  "\xef\xbf\xbf", "\xf0\x9f\x98\x80", "\xf4\x8f\xbf\xbf",
+  "\x80", "\xc1\xbf", "\xe0\x9f\xbf", "\xf4\x90\x80\x80", "\xff", "\xc3",
+  "\xe2\x82"
+};
+
+/* Fill mbs at an offset of up to 7 bytes with ASCII runs and other
+   sequences, valid or not.  */
+static char *
+make_mbs (int bad)
+{
+  char *s = mbs + rnd (8);
+  size_t n = 0;
+  int npieces = bad ? sizeof (pieces) / sizeof (pieces[0]) : 8;
+
+  while (n + 40 + 4 < MAXLEN)
+    {
+      int run = rnd (3) == 0 ? rnd (40) : rnd (4);
+      const char *p = pieces[rnd (npieces)];
+
+      while (run-- > 0)
+	s[n++] = ' ' + rnd (0x5f);
+      memcpy (s + n, p, strlen (p));
+      n += strlen (p);
+    }
+  s[n] = '\0';
+  return s;
+}
+
+static void
+make_wcs (int bad)
+{
+  size_t n = 0;
+
+  while (n < MAXLEN)
+    {
+      unsigned int r = rnd (20);
+
+      if (r < 12)
+	wcs[n] = ' ' + rnd (0x5f);
+      else if (r < 15)
+	wcs[n] = 0x80 + rnd (0x80);
+      else if (r < 17)
+	wcs[n] = 0x100 + rnd (0xd700);
+      else if (r < 18)
+	wcs[n] = 0xe000 + rnd (0x2000);
+      else if (r < 19 && sizeof (wchar_t) == 4)
+	wcs[n] = 0x10000 + rnd (0x100000);
+      else
+	wcs[n] = bad ? 0xd800 + rnd (0x800) : 'x';
+      n++;
+    }
+  wcs[n] = L'\0';
+}
+
+static size_t
+ref_mbsnrtowcs (wchar_t *dst, const char **src, size_t nms, size_t len)
+{
+  mbstate_t ps;
+  size_t count = 0;
+  size_t bytes;
+
+  memset (&ps, 0, sizeof (ps));
+  while (len > 0)
+    {
+      bytes = mbrtowc (dst, *src, nms, &ps);
+      if (bytes == (size_t) -2)
+	{
+	  *src += nms;
+	  return count;
+	}
+      if (bytes == (size_t) -1)
+	return (size_t) -1;
+      if (bytes == 0)
+	{
+	  *src = NULL;
+	  return count;
+	}
+      *src += bytes;
+      nms -= bytes;
+      ++count;
+      ++dst;
+      --len;
+    }
+  return count;
+}
+
+static size_t
+ref_wcsnrtombs (char *dst, const wchar_t **src, size_t nwc, size_t len)
+{
+  mbstate_t ps, save;
+  char buf[MB_LEN_MAX];
+  size_t n = 0;
+  size_t bytes;
+
+  memset (&ps, 0, sizeof (ps));
+  while (n < len && nwc-- > 0)
+    {
+      save = ps;
+      bytes = wcrtomb (buf, **src, &ps);
+      if (bytes == (size_t) -1)
+	return (size_t) -1;
+      if (n + bytes > len)
+	{
+	  ps = save;
+	  break;
+	}
+      memcpy (dst + n, buf, bytes);
+      n += bytes;
+      if (*(*src)++ == L'\0')
+	{
+	  *src = NULL;
+	  return n - 1;
+	}
+    }
+  return n;
+}
+
+static void
+check_mbs (const char *s)
+{
+  static wchar_t out[MAXLEN + 1], ref[MAXLEN + 1];
+  const char *src, *ref_src;
+  size_t len, nms, ret, ref_ret, n;
+  mbstate_t ps;
+
+  ref_src = s;
+  CHECK (mbstowcs (NULL, s, 0)
+	 == ref_mbsnrtowcs (ref, &ref_src, (size_t) -1, MAXLEN + 1));
+  for (len = 0; len <= MAXLEN + 1; len += 1 + rnd (9))
+    {
+      wmemset (out, L'?', MAXLEN + 1);
+      wmemset (ref, L'?', MAXLEN + 1);
+      ref_src = s;
+      ref_ret = ref_mbsnrtowcs (ref, &ref_src, (size_t) -1, len);
+      ret = mbstowcs (out, s, len);
+      CHECK (ret == ref_ret);
+      n = ret == (size_t) -1 ? 0 : ret < len ? ret + 1 : len;
+      CHECK (wmemcmp (out, ref, n) == 0);
+
+      nms = rnd (strlen (s) + 2);
+      ref_src = src = s;
+      ref_ret = ref_mbsnrtowcs (ref, &ref_src, nms, len);
+      memset (&ps, 0, sizeof (ps));
+      ret = mbsnrtowcs (out, &src, nms, len, &ps);
+      CHECK (ret == ref_ret);
+      if (ret != (size_t) -1)
+	{
+	  CHECK (src == ref_src);
+	  CHECK (wmemcmp (out, ref, ret) == 0);
+	}
+
+      ref_src = src = s;
+      ref_ret = ref_mbsnrtowcs (ref, &ref_src, nms, MAXLEN + 1);
+      memset (&ps, 0, sizeof (ps));
+      CHECK (mbsnrtowcs (NULL, &src, nms, 0, &ps) == ref_ret);
+      CHECK (src == s);
+    }
+}
+
+static void
+check_wcs (void)
+{
+  static char out[MB_LEN_MAX * (MAXLEN + 1)], ref[MB_LEN_MAX * (MAXLEN + 1)];
+  const wchar_t *src, *ref_src;
+  size_t len, nwc, ret, ref_ret, full;
+  mbstate_t ps;
+
+  ref_src = wcs;
+  full = ref_wcsnrtombs (ref, &ref_src, (size_t) -1, sizeof (ref));
+  CHECK (wcstombs (NULL, wcs, 0) == full);
+  for (len = 0; len <= MB_LEN_MAX * MAXLEN / 2; len += 1 + rnd (17))
+    {
+      memset (out, '?', sizeof (out));
+      ret = wcstombs (out, wcs, len);
+      if (full == (size_t) -1)
+	{
+	  CHECK (ret == (size_t) -1 || ret == len);
+	}
+      else
+	{
+	  CHECK (ret == (len > full ? full : len));
+	  CHECK (memcmp (out, ref, len > full ? full + 1 : len) == 0);
+	}
+
+      nwc = rnd (MAXLEN + 2);
+      ref_src = src = wcs;
+      ref_ret = ref_wcsnrtombs (ref, &ref_src, nwc, len);
+      memset (&ps, 0, sizeof (ps));
+      ret = wcsnrtombs (out, &src, nwc, len, &ps);
+      CHECK (ret == ref_ret);
+      if (ret != (size_t) -1)
+	{
+	  CHECK (src == ref_src);
+	  CHECK (memcmp (out, ref, ret) == 0);
+	}
+
+      ref_src = src = wcs;
+      ref_ret = ref_wcsnrtombs (ref, &ref_src, nwc, sizeof (ref));
+      memset (&ps, 0, sizeof (ps));
+      CHECK (wcsnrtombs (NULL, &src, nwc, 0, &ps) == ref_ret);
+      CHECK (src == wcs);
+    }
+}
+
+#endif /* _MB_CAPABLE */
+
+int
+main (void)
+{
+#ifdef _MB_CAPABLE
+  static const char *locales[] = {
+    "C", "C.UTF-8", "C.ISO-8859-1", "C.ISO-8859-5", "C.CP1251"
+  };
+  size_t i;
+  int j;
+
+  for (i = 0; i < sizeof (locales) / sizeof (locales[0]); i++)
+    {
+      if (setlocale (LC_CTYPE, locales[i]) == NULL)
+	continue;
+      for (j = 0; j < 200; j++)
+	{
+	  check_mbs (make_mbs (j & 1));
+	  make_wcs (j & 1);
+	  check_wcs ();
+	}
+    }
+#endif
+  exit (0);
+}
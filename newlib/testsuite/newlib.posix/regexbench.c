@@ -0,0 +1,122 @@
+/*
+ * Test and benchmark for regexec() on grep-style searches.
+ *
+ * Generates a set of log lines and matches each of several typical
+ * patterns against all of them, once asking for the extent of the match
+ * and once with REG_NOSUB, checking that both agree and that the number
+ * of matching lines is the expected one.  The rate of each run in lines
+ * per second is printed, so that the literal prescreening and the DFA
+ * used by regexec() can be compared with the plain matcher.
+ */
+
+#include <regex.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define	TEST(e)	((e) ? (void)0 : testfail(__FILE__, __LINE__, #e))
+
+#define	NLINES	24000	/* a multiple of 120 */
+#define	NPASSES	5
+
+static void
+testfail(const char *file, unsigned long line, const char *expression)
+{
+
+	printf("%s:%lu: failed assertion `%s'\n", file, line, expression);
+	exit(1);
+}
+
+static const char *levels[] = { "INFO", "INFO", "INFO", "WARN", "ERROR" };
+static const char *users[] = { "alice", "bob", "carol", "dave" };
+static const char *events[] = {
+	"request served",
+	"connection refused",
+	"login failed",
+	"timeout waiting for backend",
+	"cache hit",
+	"cache miss",
+};
+
+static const struct bench {
+	const char *re;
+	int cflags;
+	int nmatch;		/* lines matched out of every 120 */
+} benches[] = {
+	{ "ERROR", 0, 24 },
+	{ "^[0-9-]+ [0-9:]+ WARN", REG_EXTENDED, 24 },
+	{ "^2024-03-1", REG_EXTENDED, 0 },
+	{ "timeout|refused", REG_EXTENDED, 40 },
+	{ "user=carol .*failed", REG_EXTENDED, 10 },
+	{ "from 10\\.0\\.[0-9]+\\.[0-9]+ ", REG_EXTENDED, 120 },
+	{ "cache (hit|miss)$", REG_EXTENDED, 40 },
+	{ "LOGIN", REG_ICASE, 20 },
+	{ "no such text", REG_NOSPEC, 0 },
+};
+
+static char *lines[NLINES];
+
+static void
+mklines(void)
+{
+	char buf[128];
+	int i;
+
+	for (i = 0; i < NLINES; i++) {
+		snprintf(buf, sizeof(buf),
+		    "2024-02-%02d %02d:%02d:%02d %s server[%d]: from 10.0.%d.%d "
+		    "user=%s %s", 1 + i % 28, i % 24, i % 60, (i * 7) % 60,
+		    levels[i % 5], 1000 + i % 97, i % 256, (i * 13) % 256,
+		    users[i % 4], events[i % 6]);
+		lines[i] = strdup(buf);
+		TEST(lines[i] != NULL);
+	}
+}
+
+static int
+run(const regex_t *re, int nosub)
+{
+	regmatch_t pm[1];
+	int i, n = 0, r;
+
+	for (i = 0; i < NLINES; i++) {
+		r = nosub ? regexec(re, lines[i], 0, NULL, 0) :
+		    regexec(re, lines[i], 1, pm, 0);
+		TEST(r == 0 || r == REG_NOMATCH);
+		n += r == 0;
+	}
+	return n;
+}
+
+int
+main(void)
+{
+	const struct bench *b;
+	regex_t re, nsre;
+	clock_t t;
+	double secs;
+	int i, pass, n;
+
+	mklines();
+	for (i = 0; i < (int)(sizeof(benches) / sizeof(benches[0])); i++) {
+		b = &benches[i];
+		TEST(regcomp(&re, b->re, b->cflags) == 0);
+		TEST(regcomp(&nsre, b->re, b->cflags|REG_NOSUB) == 0);
+		t = clock();
+		for (pass = 0; pass < NPASSES; pass++) {
+			n = run(&re, 0);
+			TEST(n == NLINES / 120 * b->nmatch);
+			TEST(run(&nsre, 1) == n);
+		}
+		t = clock() - t;
+		secs = (double)t / CLOCKS_PER_SEC;
+		printf("%-32s %8d matches %12.0f lines/s\n", b->re, n,
+		    secs > 0 ? 2.0 * NPASSES * NLINES / secs : 0.0);
+		regfree(&nsre);
+		regfree(&re);
+	}
+	for (i = 0; i < NLINES; i++)
+		free(lines[i]);
+	return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * Test for regexec().
+ *
+ * Runs each RE over a set of strings several times, as the DFA cache
+ * used by regexec() is filled in by the first runs and used by the later
+ * ones, and checks the result and the extent of the match.  The last REs
+ * need more DFA states than are cached, or use the large state set
+ * representation.  Some REs start with a literal prefix, anchored or not,
+ * which regexec() searches for before running the matcher.
+ */
+
+#include <regex.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define	TEST(e)	((e) ? (void)0 : testfail(__FILE__, __LINE__, #e))
+
+static void
+testfail(const char *file, unsigned long line, const char *expression)
+{
+
+	printf("%s:%lu: failed assertion `%s'\n", file, line, expression);
+	exit(1);
+}
+
+static const struct test {
+	const char *re;
+	int cflags;
+	const char *string;
+	int eflags;
+	int so, eo;		/* -1 for no match */
+} tests[] = {
+	{ "abc", 0, "xxabcxx", 0, 2, 5 },
+	{ "abc", 0, "xxabxcx", 0, -1, -1 },
+	{ "a*b", 0, "caaab", 0, 1, 5 },
+	{ "^ab", REG_EXTENDED, "ab", 0, 0, 2 },
+	{ "^ab", REG_EXTENDED, "ab", REG_NOTBOL, -1, -1 },
+	{ "^ab", REG_EXTENDED, "x\nab", 0, -1, -1 },
+	{ "^ab", REG_EXTENDED|REG_NEWLINE, "x\nab", 0, 2, 4 },
+	{ "^ab", REG_EXTENDED|REG_NEWLINE, "x\nab", REG_NOTBOL, 2, 4 },
+	{ "ab$", REG_EXTENDED, "abab", 0, 2, 4 },
+	{ "ab$", REG_EXTENDED, "abab", REG_NOTEOL, -1, -1 },
+	{ "ab$", REG_EXTENDED|REG_NEWLINE, "ab\ncd", 0, 0, 2 },
+	{ "^$", REG_EXTENDED|REG_NEWLINE, "a\n\nb", 0, 2, 2 },
+	{ "(foo|bar)+baz", REG_EXTENDED, "xfoobarbaz", 0, 1, 10 },
+	{ "(foo|bar)+baz", REG_EXTENDED, "xfoobarba", 0, -1, -1 },
+	{ "[0-9]+ (WARN|INFO) [a-z]+", REG_EXTENDED, "12 INFO ok", 0, 0, 10 },
+	{ "(ab)c", REG_EXTENDED, "xabxabc", 0, 4, 7 },
+	{ "ab+c", REG_EXTENDED, "aabbc", 0, 1, 5 },
+	{ "ab.*cde", REG_EXTENDED, "xab ab cde", 0, 1, 10 },
+	{ "^*ab", 0, "*ab", 0, 0, 3 },
+	{ "^(ab)", REG_EXTENDED, "xab", 0, -1, -1 },
+	{ "x[^a]*y", REG_EXTENDED, "xay xby", 0, 4, 7 },
+	{ "x.y", REG_EXTENDED, "x\xe9y", 0, 0, 3 },
+	{ "ABC", REG_ICASE, "xabcx", 0, 1, 4 },
+	{ "a?", REG_EXTENDED, "b", 0, 0, 0 },
+	{ "(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)", REG_EXTENDED,
+	  "abbabaabbbababbaabababbbabaabbabbaabbab", 0, 0, 38 },
+	{ "(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)", REG_EXTENDED,
+	  "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbabbbbbb", 0, -1, -1 },
+	{ "(ab|cd|ef|gh|ij|kl|mn|op|qr|st|uv|wx|yz)+(12|34|56|78|90)+end",
+	  REG_EXTENDED, "--abcdklyz123490end--", 0, 2, 19 },
+};
+
+int
+main(void)
+{
+	const struct test *t;
+	regex_t re;
+	regmatch_t pm[1];
+	int i, pass, r;
+
+	for (i = 0; i < (int)(sizeof(tests) / sizeof(tests[0])); i++) {
+		t = &tests[i];
+		TEST(regcomp(&re, t->re, t->cflags) == 0);
+		for (pass = 0; pass < 3; pass++) {
+			r = regexec(&re, t->string, 1, pm, t->eflags);
+			if (t->so < 0) {
+				TEST(r == REG_NOMATCH);
+				continue;
+			}
+			TEST(r == 0);
+			TEST(pm[0].rm_so == t->so && pm[0].rm_eo == t->eo);
+			TEST(regexec(&re, t->string, 0, NULL, t->eflags) == 0);
+		}
+		regfree(&re);
+	}
+	return 0;
+}
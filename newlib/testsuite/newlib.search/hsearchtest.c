@@ -31,6 +31,10 @@
 
 /*
  * Test program for hsearch() et al.
+ *
+ * The second part fills a table created for a handful of entries with
+ * many more, so that it has to grow, deletes some of them and measures
+ * the throughput of insertions, lookups and deletions.
  */
 
 #include <sys/cdefs.h>
@@ -46,6 +50,8 @@ __COPYRIGHT(
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
+#include <errno.h>
 
 #define	TEST(e)	((e) ? (void)0 : testfail(__FILE__, __LINE__, #e))
 
@@ -58,6 +64,83 @@ testfail(const char *file, unsigned long line, const char *expression)
 	exit(1);
 }
 
+#define NKEYS 100000
+
+static char keys[NKEYS][12];
+
+static double
+ms(clock_t t)
+{
+	return (double)t * 1000 / CLOCKS_PER_SEC;
+}
+
+static void
+bench(void)
+{
+	struct hsearch_data htab;
+	ENTRY e, *ep;
+	clock_t t, tenter, tfind, tdelete;
+	int i;
+
+	for (i = 0; i < NKEYS; i++)
+		sprintf(keys[i], "key%d", i);
+
+	memset(&htab, 0, sizeof htab);
+	TEST(hcreate_r(4, &htab));
+
+	t = clock();
+	for (i = 0; i < NKEYS; i++) {
+		e.key = keys[i];
+		e.data = (void *)(long)i;
+		TEST(hsearch_r(e, ENTER, &ep, &htab));
+		TEST(ep->key == keys[i] && (long)ep->data == i);
+	}
+	tenter = clock() - t;
+
+	/* Entries must not move when the table grows. */
+	e.key = keys[0];
+	TEST(hsearch_r(e, FIND, &ep, &htab));
+	ep->data = (void *)(long)-1;
+
+	t = clock();
+	for (i = 0; i < NKEYS; i++) {
+		e.key = keys[i];
+		TEST(hsearch_r(e, FIND, &ep, &htab));
+		TEST((long)ep->data == (i == 0 ? -1 : i));
+	}
+	tfind = clock() - t;
+
+	t = clock();
+	for (i = 0; i < NKEYS; i += 2)
+		TEST(hdelete_r(keys[i], &htab));
+	tdelete = clock() - t;
+	TEST(!hdelete_r(keys[0], &htab) && errno == ESRCH);
+
+	for (i = 0; i < NKEYS; i++) {
+		e.key = keys[i];
+		TEST(hsearch_r(e, FIND, &ep, &htab) == (i % 2));
+	}
+
+	/* Deleted slots are reused and cleaned up by later insertions. */
+	for (i = 0; i < NKEYS; i += 2) {
+		e.key = keys[i];
+		e.data = (void *)(long)i;
+		TEST(hsearch_r(e, ENTER, &ep, &htab));
+		TEST(hdelete_r(keys[i], &htab));
+		TEST(hsearch_r(e, ENTER, &ep, &htab));
+	}
+	for (i = 0; i < NKEYS; i++) {
+		e.key = keys[i];
+		TEST(hsearch_r(e, FIND, &ep, &htab));
+		TEST((long)ep->data == i);
+	}
+
+	hdestroy_r(&htab);
+
+	printf("%d keys: enter %.3f ms, find %.3f ms, delete %d %.3f ms\n",
+	    NKEYS, ms(tenter), ms(tfind), NKEYS / 2, ms(tdelete));
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -119,7 +202,18 @@ main(int argc, char *argv[])
 	TEST(ep2 != NULL);
 	TEST(strcmp(ep2->key, "b") == 0 && (long)ep2->data == 1);
 
+	/* Delete one and check the others are still there. */
+	TEST(hdelete("c"));
+	TEST(!hdelete("c"));
+	ch[0] = 'c';
+	TEST(hsearch(e, FIND) == NULL);
+	ch[0] = 'd';
+	ep = hsearch(e, FIND);
+	TEST(ep != NULL && (long)ep->data == 3);
+
 	hdestroy();
 
+	bench();
+
 	exit(0);
 }
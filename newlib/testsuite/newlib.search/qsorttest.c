@@ -0,0 +1,168 @@
+/*
+ * Test and benchmark for qsort().
+ *
+ * Sorts arrays of several element sizes and input patterns, checks the
+ * result and that the number of comparisons stays within a multiple of
+ * n log2 n.  The "adversary" pattern is McIlroy's "A Killer Adversary
+ * for Quicksort", which makes plain quicksorts go quadratic.  The time
+ * taken by each pattern is printed so that implementations can be
+ * compared.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#define	TEST(e)	((e) ? (void)0 : testfail(__FILE__, __LINE__, #e))
+
+static void
+testfail(const char *file, unsigned long line, const char *expression)
+{
+
+	printf("%s:%lu: failed assertion `%s'\n", file, line, expression);
+	exit(1);
+}
+
+#define NMAX 20000
+
+static unsigned long ncmp;
+static size_t esize;
+static unsigned char *array;
+
+/* Keys live in the first 4 bytes of each element, the rest is padding. */
+static uint32_t
+key(const void *p)
+{
+	uint32_t k;
+
+	memcpy(&k, p, sizeof(k));
+	return k;
+}
+
+static void
+setkey(size_t i, uint32_t k)
+{
+	memset(array + i * esize, (int)(k & 0xff), esize);
+	memcpy(array + i * esize, &k, sizeof(k));
+}
+
+static int
+cmp(const void *a, const void *b)
+{
+	uint32_t ka = key(a), kb = key(b);
+
+	ncmp++;
+	return ka < kb ? -1 : ka > kb;
+}
+
+/* McIlroy's adversary: values are only fixed when compared. */
+static uint32_t *gas_val, gas_nsolid, gas_candidate, gas_value;
+
+static int
+gas_cmp(const void *a, const void *b)
+{
+	uint32_t x = key(a), y = key(b);
+
+	ncmp++;
+	if (gas_val[x] == gas_value && gas_val[y] == gas_value) {
+		if (x == gas_candidate)
+			gas_val[x] = gas_nsolid++;
+		else
+			gas_val[y] = gas_nsolid++;
+	}
+	if (gas_val[x] == gas_value)
+		gas_candidate = x;
+	else if (gas_val[y] == gas_value)
+		gas_candidate = y;
+	return gas_val[x] < gas_val[y] ? -1 : gas_val[x] > gas_val[y];
+}
+
+enum { RANDOM, SORTED, REVERSED, ORGAN, EQUAL, FEW, ADVERSARY, NPATTERNS };
+static const char *const names[NPATTERNS] = {
+	"random", "sorted", "reversed", "organ-pipe", "equal", "few-unique",
+	"adversary"
+};
+
+static void
+fill(int pattern, size_t n)
+{
+	size_t i;
+
+	srand(1);
+	for (i = 0; i < n; i++) {
+		switch (pattern) {
+		case RANDOM:	setkey(i, (uint32_t)rand()); break;
+		case SORTED:	setkey(i, i); break;
+		case REVERSED:	setkey(i, n - i); break;
+		case ORGAN:	setkey(i, i < n / 2 ? i : n - i); break;
+		case EQUAL:	setkey(i, 42); break;
+		case FEW:	setkey(i, rand() % 8); break;
+		case ADVERSARY:	setkey(i, i); break;
+		}
+	}
+}
+
+static void
+run(int pattern, size_t n)
+{
+	size_t i, j, log2n;
+	clock_t t;
+
+	fill(pattern, n);
+	ncmp = 0;
+	t = clock();
+	if (pattern == ADVERSARY) {
+		gas_value = n;
+		gas_nsolid = gas_candidate = 0;
+		for (i = 0; i < n; i++)
+			gas_val[i] = gas_value;
+		qsort(array, n, esize, gas_cmp);
+		/* Check the order the adversary fixed. */
+		for (i = 0; i < n; i++)
+			setkey(i, gas_val[key(array + i * esize)]);
+	} else
+		qsort(array, n, esize, cmp);
+	t = clock() - t;
+
+	for (i = 1; i < n; i++)
+		TEST(key(array + (i - 1) * esize) <= key(array + i * esize));
+	/* Elements must have been moved whole. */
+	if (pattern != ADVERSARY)
+		for (i = 0; i < n; i++)
+			for (j = sizeof(uint32_t); j < esize; j++)
+				TEST(array[i * esize + j]
+				     == (key(array + i * esize) & 0xff));
+
+	for (log2n = 1; ((size_t)1 << log2n) < n; log2n++)
+		;
+	TEST(ncmp <= 4 * n * log2n + n);
+
+	printf("size %2lu %-10s n %6lu: %8lu compares %8.3f ms\n",
+	       (unsigned long)esize, names[pattern], (unsigned long)n,
+	       ncmp, (double)t * 1000 / CLOCKS_PER_SEC);
+}
+
+int
+main(void)
+{
+	static const size_t sizes[] = { 4, 6, 8, 12, 16, 24 };
+	static const size_t counts[] = { 0, 1, 2, 6, 7, 40, 41, 1000, NMAX };
+	size_t s, c;
+	int pattern;
+
+	array = malloc(NMAX * 24);
+	gas_val = malloc(NMAX * sizeof(*gas_val));
+	TEST(array != NULL && gas_val != NULL);
+
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		esize = sizes[s];
+		for (pattern = 0; pattern < NPATTERNS; pattern++)
+			for (c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+				run(pattern, counts[c]);
+	}
+	free(array);
+	free(gas_val);
+	return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * Test for tsearch(), tfind(), tdelete(), twalk() and tdestroy().
+ *
+ * Inserts keys in sorted order, which used to build a degenerate tree,
+ * checks with twalk() that the tree stays shallow and in order, then
+ * deletes half of the keys and destroys the rest.
+ */
+
+#include <search.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define	TEST(e)	((e) ? (void)0 : testfail(__FILE__, __LINE__, #e))
+
+static void
+testfail(const char *file, unsigned long line, const char *expression)
+{
+
+	printf("%s:%lu: failed assertion `%s'\n", file, line, expression);
+	exit(1);
+}
+
+#define N 10000
+
+static int keys[N];
+static int nvisited, maxlevel, last;
+static int nfreed;
+
+static int
+cmp(const void *a, const void *b)
+{
+	int x = *(const int *)a, y = *(const int *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static void
+walk(const void *node, VISIT visit, int level)
+{
+	int k = **(int *const *)node;
+
+	if (level > maxlevel)
+		maxlevel = level;
+	if (visit == postorder || visit == leaf) {
+		TEST(k > last);
+		last = k;
+		nvisited++;
+	}
+}
+
+static void
+freekey(void *key)
+{
+	TEST(*(int *)key % 2 == 1);
+	nfreed++;
+}
+
+static void
+check(void *root, int n)
+{
+	int log2n;
+
+	nvisited = maxlevel = 0;
+	last = -1;
+	twalk(root, walk);
+	TEST(nvisited == n);
+	/* An AVL tree is less than 1.45 log2(n + 2) deep. */
+	for (log2n = 1; (1 << log2n) < n + 2; log2n++)
+		;
+	TEST(maxlevel < log2n * 3 / 2);
+}
+
+int
+main(void)
+{
+	void *root = NULL;
+	int i;
+
+	for (i = 0; i < N; i++) {
+		keys[i] = i;
+		TEST(**(int **)tsearch(&keys[i], &root, cmp) == i);
+	}
+	TEST(*(int **)tsearch(&keys[5], &root, cmp) == &keys[5]);
+	check(root, N);
+
+	for (i = 0; i < N; i += 2)
+		TEST(tdelete(&keys[i], &root, cmp) != NULL);
+	TEST(tdelete(&keys[0], &root, cmp) == NULL);
+	check(root, N / 2);
+
+	for (i = 0; i < N; i++)
+		TEST((tfind(&keys[i], &root, cmp) != NULL) == (i % 2 == 1));
+
+	tdestroy(root, freekey);
+	TEST(nfreed == N / 2);
+	return 0;
+}
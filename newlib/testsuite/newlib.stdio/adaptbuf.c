@@ -0,0 +1,96 @@
+/*
+ * Read and write a file through streams whose buffer may change size,
+ * checking the data and the file position around seeks, ungetc() and
+ * flushes.  In configurations with _STDIO_ADAPTIVE_BUF, also check that
+ * the buffer grows for sequential transfers, shrinks back after a seek,
+ * at end of file and after a partial flush, and keeps a size given to
+ * setvbuf().
+ */
+
+#include <stdio.h>
+#include <stdio_ext.h>
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+
+#define NBYTES (1L << 20)
+#define BYTE(i) ((unsigned char) ((i) * 7 + ((i) >> 11)))
+
+static void
+read_seq (FILE *fp, long from, long to)
+{
+  long i;
+
+  for (i = from; i < to; i++)
+    CHECK (getc (fp) == BYTE (i));
+}
+
+int
+main (void)
+{
+  FILE *fp;
+  size_t size;
+  long i;
+
+  fp = tmpfile ();
+  CHECK (fp != NULL);
+  for (i = 0; i < NBYTES; i++)
+    CHECK (putc (BYTE (i), fp) == BYTE (i));
+  CHECK (fflush (fp) == 0);
+  rewind (fp);
+  size = __fbufsize (fp);
+  CHECK (size > 0);
+
+  read_seq (fp, 0, NBYTES / 2);
+#ifdef _STDIO_ADAPTIVE_BUF
+  CHECK (__fbufsize (fp) > size);
+#endif
+  CHECK (fseek (fp, 100, SEEK_SET) == 0);
+#ifdef _STDIO_ADAPTIVE_BUF
+  CHECK (__fbufsize (fp) == size);
+#endif
+  read_seq (fp, 100, 200);
+  CHECK (ungetc ('x', fp) == 'x');
+  CHECK (getc (fp) == 'x');
+  CHECK (ftell (fp) == 200);
+  read_seq (fp, 200, NBYTES);
+  CHECK (getc (fp) == EOF && feof (fp));
+#ifdef _STDIO_ADAPTIVE_BUF
+  CHECK (__fbufsize (fp) == size);
+#endif
+
+  /* Overwrite the middle, then check it reads back.  */
+  CHECK (fseek (fp, NBYTES / 4, SEEK_SET) == 0);
+  for (i = NBYTES / 4; i < NBYTES / 2; i++)
+    CHECK (putc (BYTE (i) ^ 0xff, fp) == (BYTE (i) ^ 0xff));
+  CHECK (putc ('y', fp) == 'y');
+#ifdef _STDIO_ADAPTIVE_BUF
+  CHECK (__fbufsize (fp) > size);
+  CHECK (fflush (fp) == 0);
+  CHECK (__fbufsize (fp) == size);
+#endif
+  CHECK (ftell (fp) == NBYTES / 2 + 1);
+  CHECK (fseek (fp, NBYTES / 4 - 1, SEEK_SET) == 0);
+  CHECK (getc (fp) == BYTE (NBYTES / 4 - 1));
+  for (i = NBYTES / 4; i < NBYTES / 2; i++)
+    CHECK (getc (fp) == (BYTE (i) ^ 0xff));
+  CHECK (getc (fp) == 'y');
+  read_seq (fp, NBYTES / 2 + 1, NBYTES);
+
+  /* A buffer size given to setvbuf is kept.  */
+  CHECK (setvbuf (fp, NULL, _IOFBF, 512) == 0);
+  rewind (fp);
+  read_seq (fp, 0, NBYTES / 4);
+  CHECK (__fbufsize (fp) == 512);
+
+#ifdef _STDIO_ADAPTIVE_BUF
+  /* Limit the growth.  */
+  CHECK (setvbuf (fp, NULL, _IOFBF, 0) == 0);
+  __fsetbufmax (2 * size);
+  rewind (fp);
+  read_seq (fp, 0, NBYTES / 4);
+  CHECK (__fbufsize (fp) == 2 * size);
+#endif
+  CHECK (fclose (fp) == 0);
+  exit (0);
+}
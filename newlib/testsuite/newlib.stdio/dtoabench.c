@@ -0,0 +1,97 @@
+/*
+ * Test and benchmark for the conversion of doubles to decimal.
+ *
+ * Formats a set of doubles of all magnitudes with several printf
+ * formats, checking that %.17g reads back as the same number, and
+ * converts them to their shortest digits with _dtoa_r() mode 0.  The
+ * rate of each run in conversions per second is printed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <reent.h>
+#include "check.h"
+
+#define NVALUES 20000
+#define NPASSES 5
+
+extern char *_dtoa_r (struct _reent *, double, int, int, int *, int *,
+		      char **);
+
+static double values[NVALUES];
+
+static void
+mkvalues (void)
+{
+  unsigned long x = 1;
+  double d;
+  int i, e;
+
+  for (i = 0; i < NVALUES; i++)
+    {
+      x = x * 1103515245 + 12345;
+      d = (double) (x >> 8 & 0xffffff) / 0x1000000 + 1.0;
+      e = (int) (x >> 16 & 0x7f) - 64;
+      while (e > 0)
+	d *= 10, e--;
+      while (e < 0)
+	d /= 10, e++;
+      values[i] = i % 4 == 0 ? d : i % 4 == 1 ? (double) (long) d
+	: i % 4 == 2 ? 1 / d : -d;
+    }
+}
+
+static void
+report (const char *name, clock_t t)
+{
+  double secs = (double) t / CLOCKS_PER_SEC;
+
+  printf ("%-12s %12.0f conversions/s\n", name,
+	  secs > 0 ? (double) NPASSES * NVALUES / secs : 0.0);
+}
+
+static void
+run (const char *fmt)
+{
+  char buf[400];
+  clock_t t = clock ();
+  int i, pass;
+
+  for (pass = 0; pass < NPASSES; pass++)
+    for (i = 0; i < NVALUES; i++)
+      CHECK (snprintf (buf, sizeof (buf), fmt, values[i]) > 0);
+  report (fmt, clock () - t);
+}
+
+int
+main (void)
+{
+  char buf[40], *s, *se;
+  clock_t t;
+  int i, pass, decpt, sign;
+
+  mkvalues ();
+  for (i = 0; i < NVALUES; i++)
+    {
+      sprintf (buf, "%.17g", values[i]);
+      CHECK (strtod (buf, NULL) == values[i]);
+    }
+
+  run ("%g");
+  run ("%.17g");
+  run ("%e");
+  run ("%f");
+  run ("%.3f");
+
+  t = clock ();
+  for (pass = 0; pass < NPASSES; pass++)
+    for (i = 0; i < NVALUES; i++)
+      {
+	s = _dtoa_r (_REENT, values[i], 0, 0, &decpt, &sign, &se);
+	CHECK (se > s && se - s <= 17);
+      }
+  report ("shortest", clock () - t);
+  exit (0);
+}
@@ -0,0 +1,66 @@
+/*
+ * Open many streams, close some and open more, checking that FILEs
+ * are never handed out twice and that closed ones get reused.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "check.h"
+
+#define NFILES 200
+#define CHAR(i) ('a' + (i) % 26)
+
+static FILE *fps[NFILES];
+
+static void
+check_distinct (void)
+{
+  int i, j;
+
+  for (i = 0; i < NFILES; i++)
+    for (j = i + 1; j < NFILES; j++)
+      CHECK (fps[i] == NULL || fps[i] != fps[j]);
+}
+
+int
+main (void)
+{
+  FILE *closed[NFILES / 2];
+  int i, j, reused = 0;
+
+  for (i = 0; i < NFILES; i++)
+    {
+      fps[i] = fmemopen (NULL, 16, "w+");
+      CHECK (fps[i] != NULL);
+      CHECK (fputc (CHAR (i), fps[i]) != EOF);
+    }
+  check_distinct ();
+
+  for (i = 1; i < NFILES; i += 2)
+    {
+      closed[i / 2] = fps[i];
+      CHECK (fclose (fps[i]) == 0);
+      fps[i] = NULL;
+    }
+  for (i = 1; i < NFILES; i += 2)
+    {
+      fps[i] = fmemopen (NULL, 16, "w+");
+      CHECK (fps[i] != NULL);
+      for (j = 0; j < NFILES / 2; j++)
+	if (fps[i] == closed[j])
+	  reused++;
+    }
+  check_distinct ();
+  /* Spare FILEs from the last block allocated may be used first.  */
+  CHECK (reused >= NFILES / 2 - 4);
+
+  /* Streams left open still work.  */
+  for (i = 0; i < NFILES; i += 2)
+    {
+      rewind (fps[i]);
+      CHECK (fgetc (fps[i]) == CHAR (i));
+    }
+  for (i = 0; i < NFILES; i++)
+    CHECK (fclose (fps[i]) == 0);
+  exit (0);
+}
@@ -0,0 +1,93 @@
+/*
+ * Read a file opened with mode "rm", which may be mapped into memory,
+ * with getc(), fgets(), fread() and ungetc(), checking the data and the
+ * file position around seeks, reading on after the file has grown, and
+ * switching to an ordinary buffer with setvbuf().  On the systems with
+ * mmap, check that the file is mapped.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+
+/* The systems for which configure.host defines HAVE_MMAP.  */
+#if (defined (__rtems__) || defined (__CYGWIN__)) \
+    && !defined (__OPTIMIZE_SIZE__)
+#define MAPPED(fp) (((fp)->_flags2 & __SMAP) != 0)
+#else
+#define MAPPED(fp) 1
+#endif
+
+#define NBYTES 100000L
+#define MORE 5000L
+#define BYTE(i) ((i) % 61 == 60 ? '\n' : 'a' + ((i) * 7 + ((i) >> 9)) % 26)
+
+static char data[NBYTES + MORE], buf[NBYTES + MORE];
+
+int
+main (void)
+{
+  const char *name = "fopenmap.tmp";
+  char line[256];
+  FILE *fp, *wp;
+  long i, pos;
+
+  for (i = 0; i < NBYTES + MORE; i++)
+    data[i] = BYTE (i);
+  wp = fopen (name, "w");
+  CHECK (wp != NULL);
+  CHECK (fwrite (data, 1, NBYTES, wp) == NBYTES);
+  CHECK (fclose (wp) == 0);
+
+  fp = fopen (name, "rm");
+  CHECK (fp != NULL);
+  CHECK (MAPPED (fp));
+  for (i = 0; i < 1000; i++)
+    CHECK (getc (fp) == data[i]);
+  CHECK (fgets (line, sizeof (line), fp) != NULL);
+  CHECK (memcmp (line, data + 1000, strlen (line)) == 0);
+  pos = 1000 + strlen (line);
+  CHECK (ftell (fp) == pos);
+  CHECK (fread (buf, 1, 5000, fp) == 5000);
+  CHECK (memcmp (buf, data + pos, 5000) == 0);
+  pos += 5000;
+  CHECK (getc (fp) == data[pos]);
+  CHECK (ungetc ('Z', fp) == 'Z');
+  CHECK (getc (fp) == 'Z');
+  CHECK (ftell (fp) == pos + 1);
+
+  CHECK (fseek (fp, 100, SEEK_SET) == 0);
+  CHECK (getc (fp) == data[100]);
+  CHECK (fseek (fp, -50, SEEK_END) == 0);
+  CHECK (fread (buf, 1, 100, fp) == 50 && feof (fp));
+  CHECK (memcmp (buf, data + NBYTES - 50, 50) == 0);
+
+  /* Data appended to the file is read after what was there before.  */
+  wp = fopen (name, "a");
+  CHECK (wp != NULL);
+  CHECK (fwrite (data + NBYTES, 1, MORE, wp) == MORE);
+  CHECK (fclose (wp) == 0);
+  clearerr (fp);
+  CHECK (fread (buf, 1, MORE + 1, fp) == MORE);
+  CHECK (memcmp (buf, data + NBYTES, MORE) == 0);
+  CHECK (ftell (fp) == NBYTES + MORE);
+  rewind (fp);
+  CHECK (fread (buf, 1, NBYTES + MORE, fp) == NBYTES + MORE);
+  CHECK (memcmp (buf, data, NBYTES + MORE) == 0);
+  CHECK (fclose (fp) == 0);
+
+  fp = fopen (name, "rm");
+  CHECK (fp != NULL);
+  CHECK (MAPPED (fp));
+  for (i = 0; i < 777; i++)
+    CHECK (getc (fp) == data[i]);
+  CHECK (setvbuf (fp, NULL, _IOFBF, 512) == 0);
+  CHECK (ftell (fp) == 777);
+  CHECK (fread (buf, 1, NBYTES + MORE, fp) == NBYTES + MORE - 777);
+  CHECK (memcmp (buf, data + 777, NBYTES + MORE - 777) == 0);
+  CHECK (fclose (fp) == 0);
+
+  CHECK (remove (name) == 0);
+  exit (0);
+}
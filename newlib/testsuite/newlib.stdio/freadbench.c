@@ -0,0 +1,127 @@
+/*
+ * Test and benchmark for large fread and fwrite calls.
+ *
+ * Writes a file of NBYTES with fwrite() in chunks of several sizes,
+ * through fully and line buffered streams, and reads it back with
+ * fread() likewise, checking the contents, the file position, and that
+ * ungetc() and a short seek back still work around large reads.  The
+ * throughput for each chunk size is printed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "check.h"
+
+#define NBYTES (4L << 20)
+#define PASSES 16		/* timed passes over the file */
+
+static unsigned char *data, *buf;
+static const size_t chunks[] = { 100, BUFSIZ, 65536, NBYTES };
+
+static void
+report (const char *what, size_t chunk, clock_t t)
+{
+  double secs = (double) t / CLOCKS_PER_SEC;
+
+  printf ("%-8s %8lu bytes: %10.1f MB/s\n", what, (unsigned long) chunk,
+	  secs > 0 ? (double) NBYTES * PASSES / secs / 1e6 : 0.0);
+}
+
+static void
+write_file (FILE *fp, int mode, size_t chunk)
+{
+  clock_t t;
+  long i;
+  size_t n;
+  int pass;
+
+  CHECK (setvbuf (fp, NULL, mode, BUFSIZ) == 0);
+  t = clock ();
+  for (pass = 0; pass < PASSES; pass++)
+    {
+      rewind (fp);
+      for (i = 0; i < NBYTES; i += n)
+	{
+	  n = NBYTES - i < chunk ? NBYTES - i : chunk;
+	  CHECK (fwrite (data + i, 1, n, fp) == n);
+	}
+      CHECK (fflush (fp) == 0);
+    }
+  report (mode == _IOLBF ? "fwrite/l" : "fwrite", chunk, clock () - t);
+}
+
+static void
+read_file (FILE *fp, size_t chunk)
+{
+  clock_t t;
+  long i;
+  size_t n;
+  int pass;
+
+  t = clock ();
+  for (pass = 0; pass < PASSES; pass++)
+    {
+      memset (buf, 0, NBYTES);
+      rewind (fp);
+      for (i = 0; i < NBYTES; i += n)
+	{
+	  n = NBYTES - i < chunk ? NBYTES - i : chunk;
+	  CHECK (fread (buf + i, 1, n, fp) == n);
+	}
+      CHECK (memcmp (buf, data, NBYTES) == 0);
+      CHECK (ftell (fp) == NBYTES);
+      CHECK (fread (buf, 1, 1, fp) == 0 && feof (fp));
+    }
+  t = clock () - t;
+  report ("fread", chunk, t);
+}
+
+int
+main (void)
+{
+  FILE *fp;
+  long i;
+  int c;
+
+  data = malloc (NBYTES);
+  buf = malloc (NBYTES);
+  CHECK (data != NULL && buf != NULL);
+  for (i = 0; i < NBYTES; i++)
+    data[i] = (i * 7 + (i >> 13)) & 0xff;
+
+  for (i = 0; i < sizeof (chunks) / sizeof (chunks[0]); i++)
+    {
+      fp = tmpfile ();
+      CHECK (fp != NULL);
+      write_file (fp, i & 1 ? _IOLBF : _IOFBF, chunks[i]);
+      read_file (fp, chunks[i]);
+      CHECK (fclose (fp) == 0);
+    }
+
+  /* A large read after a small one and after ungetc, then seeking back
+     into data read past the buffer.  */
+  fp = tmpfile ();
+  CHECK (fp != NULL);
+  CHECK (fwrite (data, 1, NBYTES, fp) == NBYTES);
+  rewind (fp);
+  CHECK (fread (buf, 1, 10, fp) == 10);
+  c = getc (fp);
+  CHECK (c == data[10]);
+  CHECK (ungetc (c ^ 1, fp) == (c ^ 1));
+  CHECK (fread (buf, 1, 3 * BUFSIZ + 5, fp) == 3 * BUFSIZ + 5);
+  CHECK (buf[0] == (c ^ 1));
+  CHECK (memcmp (buf + 1, data + 11, 3 * BUFSIZ + 4) == 0);
+  CHECK (ftell (fp) == 15 + 3 * BUFSIZ);
+  CHECK (fseek (fp, -20, SEEK_CUR) == 0);
+  CHECK (fread (buf, 1, 20, fp) == 20);
+  CHECK (memcmp (buf, data + 15 + 3 * BUFSIZ - 20, 20) == 0);
+  CHECK (fread (buf, 1, NBYTES, fp) == NBYTES - 15 - 3 * BUFSIZ);
+  CHECK (memcmp (buf, data + 15 + 3 * BUFSIZ, NBYTES - 15 - 3 * BUFSIZ) == 0);
+  CHECK (fclose (fp) == 0);
+
+  free (data);
+  free (buf);
+  exit (0);
+}
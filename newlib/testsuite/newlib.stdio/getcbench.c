@@ -0,0 +1,72 @@
+/*
+ * Test and benchmark for the stream locking done by getc() and putc().
+ *
+ * Writes a file with putc(), then reads it back with getc_unlocked(),
+ * getc() and, in configurations with _STDIO_BIASED_LOCK, with getc()
+ * again once the stream's bias has been revoked so that the real lock
+ * is taken.  The time taken by each pass is printed so that the cost
+ * of locking can be compared.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <newlib.h>
+#include "check.h"
+
+#define NBYTES 1000000
+
+#if defined (_STDIO_BIASED_LOCK) && !defined (__SINGLE_THREAD__)
+extern void __sflock_revoke (FILE *);
+#endif
+
+static unsigned long
+sum (FILE *fp, int locked)
+{
+  unsigned long s = 0;
+  int c;
+
+  rewind (fp);
+  if (locked)
+    while ((c = getc (fp)) != EOF)
+      s += c;
+  else
+    while ((c = getc_unlocked (fp)) != EOF)
+      s += c;
+  return s;
+}
+
+static void
+run (FILE *fp, const char *name, int locked, unsigned long expect)
+{
+  clock_t t = clock ();
+
+  CHECK (sum (fp, locked) == expect);
+  t = clock () - t;
+  printf ("%-16s %8.3f ms\n", name, (double) t * 1000 / CLOCKS_PER_SEC);
+}
+
+int
+main (void)
+{
+  unsigned long expect = 0;
+  FILE *fp;
+  long i;
+
+  fp = tmpfile ();
+  CHECK (fp != NULL);
+  for (i = 0; i < NBYTES; i++)
+    {
+      CHECK (putc ((int) (i % 251), fp) != EOF);
+      expect += i % 251;
+    }
+
+  run (fp, "getc_unlocked", 0, expect);
+  run (fp, "getc", 1, expect);
+#if defined (_STDIO_BIASED_LOCK) && !defined (__SINGLE_THREAD__)
+  __sflock_revoke (fp);
+  run (fp, "getc (revoked)", 1, expect);
+#endif
+  CHECK (fclose (fp) == 0);
+  exit (0);
+}
@@ -0,0 +1,54 @@
+/*
+ * fprintf to an unbuffered stream formats into a temporary FILE on the
+ * stack.  Check that it works when that stack space held other data
+ * before, and that the output reaches the file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+
+static void
+dirty_stack (void)
+{
+  volatile unsigned char junk[4 * BUFSIZ + 1024];
+  size_t i;
+
+  for (i = 0; i < sizeof (junk); i++)
+    junk[i] = 0x5a;
+}
+
+int
+main (void)
+{
+  const char *name = "unbufprintf.tmp";
+  char line[64];
+  FILE *fp;
+  int i;
+
+  fp = fopen (name, "w");
+  CHECK (fp != NULL);
+  CHECK (setvbuf (fp, NULL, _IONBF, 0) == 0);
+  for (i = 0; i < 3; i++)
+    {
+      dirty_stack ();
+      CHECK (fprintf (fp, "line %d %s\n", i, "of text") > 0);
+    }
+  CHECK (fclose (fp) == 0);
+
+  fp = fopen (name, "r");
+  CHECK (fp != NULL);
+  for (i = 0; i < 3; i++)
+    {
+      char want[64];
+
+      sprintf (want, "line %d of text\n", i);
+      CHECK (fgets (line, sizeof (line), fp) != NULL);
+      CHECK (strcmp (line, want) == 0);
+    }
+  CHECK (fgets (line, sizeof (line), fp) == NULL);
+  CHECK (fclose (fp) == 0);
+  CHECK (remove (name) == 0);
+  exit (0);
+}
@@ -0,0 +1,112 @@
+/*
+ * Check _dtoa_r() on floats, which are few enough to be tried one by
+ * one: build with -DSTRIDE=1 to check all of them rather than every
+ * STRIDE-th one.  The fixed precision modes 2 and 3, which are tried
+ * with Grisu before the exact algorithm, must give the same digits as
+ * modes 6 and 7, which always use the exact algorithm.  Mode 0 must give
+ * the shortest digits that read back as the same number, and the same
+ * ones as mode 6 does for that many digits.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <reent.h>
+
+#ifndef STRIDE
+#define STRIDE 65521
+#endif
+
+extern char *_dtoa_r (struct _reent *, double, int, int, int *, int *,
+		      char **);
+
+static char *
+dtoa (double d, int mode, int ndigits, int *decpt)
+{
+  static char buf[2][400];
+  static int n;
+  char *s, *se;
+  int sign;
+
+  s = _dtoa_r (_REENT, d, mode, ndigits, decpt, &sign, &se);
+  if (sign || se != s + strlen (s) || se - s >= 400)
+    abort ();
+  /* The exact algorithm can leave trailing zeros when rounding small
+     integers.  */
+  while (se > s + 1 && se[-1] == '0')
+    se--;
+  n ^= 1;
+  memcpy (buf[n], s, se - s);
+  buf[n][se - s] = '\0';
+  return buf[n];
+}
+
+/* Whether digits s, with the decimal point at decpt, read back as d.  */
+static int
+reads_as (double d, const char *s, int decpt)
+{
+  char buf[420];
+
+  sprintf (buf, ".%se%d", s, decpt);
+  return strtod (buf, NULL) == d;
+}
+
+static void
+fail (double d, int mode, int ndigits, const char *s, const char *t)
+{
+  printf ("%a mode %d, %d digits: %s, expected %s\n", d, mode, ndigits,
+	  s, t);
+  abort ();
+}
+
+static void
+check (double d)
+{
+  static const int prec[] = { 0, 1, 2, 6, 9, 12, 17, 30 };
+  char *s, *t;
+  int i, n, decpt, decpt2;
+
+  for (i = 0; i < (int) (sizeof (prec) / sizeof (prec[0])); i++)
+    {
+      s = dtoa (d, 2, prec[i], &decpt);
+      t = dtoa (d, 6, prec[i], &decpt2);
+      if (strcmp (s, t) || decpt != decpt2)
+	fail (d, 2, prec[i], s, t);
+      s = dtoa (d, 3, prec[i] - 5, &decpt);
+      t = dtoa (d, 7, prec[i] - 5, &decpt2);
+      if (strcmp (s, t) || (decpt != decpt2 && *s))
+	fail (d, 3, prec[i] - 5, s, t);
+    }
+
+  s = dtoa (d, 0, 0, &decpt);
+  n = strlen (s);
+  if (!reads_as (d, s, decpt))
+    fail (d, 0, 0, s, "a shorter string");
+  t = dtoa (d, 6, n - 1, &decpt2);
+  if (n > 1 && reads_as (d, t, decpt2))
+    fail (d, 0, 0, s, t);
+  t = dtoa (d, 6, n, &decpt2);
+  if (reads_as (d, t, decpt2) && (strcmp (s, t) || decpt != decpt2))
+    fail (d, 0, 0, s, t);
+}
+
+int
+main (void)
+{
+  uint32_t u;
+  float f;
+
+  for (u = 1; u < 0x7f800000; u += STRIDE)
+    {
+      memcpy (&f, &u, sizeof (f));
+      check (f);
+    }
+  /* The smallest and largest, and some exact decimal values.  */
+  check (5e-324);
+  check (1.7976931348623157e308);
+  check (0.5);
+  check (1e23);
+  check (123456789012345680.0);
+  exit (0);
+}
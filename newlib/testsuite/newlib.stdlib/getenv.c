@@ -0,0 +1,85 @@
+/*
+ * Check that getenv sees every change setenv, putenv and unsetenv make,
+ * and a replaced environ, with enough variables to fill a hash index
+ * several times over.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+
+#define NVARS 300
+
+extern char **environ;
+
+static char *env_a[] = { "A=1", "DUP=first", "NOEQUALS", "DUP=second",
+			 "=empty", NULL };
+static char *env_b[] = { "B=2", NULL };
+
+int
+main (void)
+{
+  char name[16], value[16];
+  int i;
+
+  environ = env_a;
+  CHECK (strcmp (getenv ("A"), "1") == 0);
+  CHECK (strcmp (getenv ("DUP"), "first") == 0);
+  CHECK (getenv ("NOEQUALS") == NULL);
+  CHECK (strcmp (getenv (""), "empty") == 0);
+  CHECK (getenv ("A=1") == NULL);
+  CHECK (getenv ("B") == NULL);
+
+  environ = env_b;
+  CHECK (getenv ("A") == NULL);
+  CHECK (strcmp (getenv ("B"), "2") == 0);
+
+  for (i = 0; i < NVARS; i++)
+    {
+      sprintf (name, "VAR%d", i);
+      sprintf (value, "%d", i * 7);
+      CHECK (setenv (name, value, 0) == 0);
+      CHECK (strcmp (getenv (name), value) == 0);
+    }
+  CHECK (strcmp (getenv ("B"), "2") == 0);
+  for (i = 0; i < NVARS; i++)
+    {
+      sprintf (name, "VAR%d", i);
+      sprintf (value, "%d", i * 7);
+      CHECK (strcmp (getenv (name), value) == 0);
+    }
+
+  CHECK (setenv ("VAR1", "x", 0) == 0);
+  CHECK (strcmp (getenv ("VAR1"), "7") == 0);
+  CHECK (setenv ("VAR1", "y", 1) == 0);
+  CHECK (strcmp (getenv ("VAR1"), "y") == 0);
+  CHECK (setenv ("VAR1", "a longer value", 1) == 0);
+  CHECK (strcmp (getenv ("VAR1"), "a longer value") == 0);
+  CHECK (putenv ("VAR2=put") == 0);
+  CHECK (strcmp (getenv ("VAR2"), "put") == 0);
+  CHECK (putenv ("NEW=put") == 0);
+  CHECK (strcmp (getenv ("NEW"), "put") == 0);
+  CHECK (getenv ("VAR") == NULL && getenv ("VAR10x") == NULL);
+
+  for (i = 0; i < NVARS; i += 2)
+    {
+      sprintf (name, "VAR%d", i);
+      CHECK (unsetenv (name) == 0);
+      CHECK (getenv (name) == NULL);
+    }
+  for (i = 3; i < NVARS; i += 2)
+    {
+      sprintf (name, "VAR%d", i);
+      sprintf (value, "%d", i * 7);
+      CHECK (strcmp (getenv (name), value) == 0);
+    }
+  CHECK (strcmp (getenv ("NEW"), "put") == 0);
+
+  environ = env_a;
+  CHECK (strcmp (getenv ("DUP"), "first") == 0);
+  CHECK (getenv ("NEW") == NULL);
+  CHECK (unsetenv ("DUP") == 0);
+  CHECK (getenv ("DUP") == NULL);
+  exit (0);
+}
@@ -0,0 +1,43 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+
+int main () {
+  struct marena *a;
+  struct mallinfo mi;
+  char *first, *p;
+  int i;
+
+  a = marena_create (256);
+  if (a == NULL)
+    abort ();
+
+  first = marena_alloc (a, 1);
+  if (first == NULL || (uintptr_t) first % sizeof (double) != 0)
+    abort ();
+
+  /* Fill several blocks, including one bigger than the block size.  */
+  for (i = 0; i < 100; i++)
+    {
+      p = marena_alloc (a, i == 50 ? 1000 : 24);
+      if (p == NULL || (uintptr_t) p % sizeof (double) != 0)
+	abort ();
+      memset (p, i, i == 50 ? 1000 : 24);
+    }
+
+  mi = marena_mallinfo (a);
+  if (mi.ordblks < 2 || mi.uordblks + mi.fordblks != mi.arena)
+    abort ();
+
+  /* After a reset the same memory is handed out again.  */
+  marena_reset (a);
+  if (marena_alloc (a, 1) != first)
+    abort ();
+  if (marena_mallinfo (a).arena != mi.arena)
+    abort ();
+
+  marena_destroy (a);
+  return 0;
+}
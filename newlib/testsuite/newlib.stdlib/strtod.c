@@ -0,0 +1,67 @@
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Inputs around halfway points, the subnormal and overflow boundaries,
+   and with more digits than fit in 64 bits, which strtod converts
+   either on its fast path or with the exact algorithm.  */
+static const struct {
+  const char *s;
+  double d;
+} tests[] = {
+  { "0.1", 0x1.999999999999ap-4 },
+  { "3.14159265358979323846", 0x1.921fb54442d18p+1 },
+  { "6.02214076e23", 0x1.fe185ca57c517p+78 },
+  { "1e23", 0x1.52d02c7e14af6p+76 },
+  { "1e-300", 0x1.56e1fc2f8f359p-997 },
+  { ".000123456789012345678", 0x1.02e85be180b74p-13 },
+  { "9007199254740993", 0x1p+53 },
+  { "9007199254740995", 0x1.0000000000002p+53 },
+  { "9007199254740993.0000000000000000001", 0x1.0000000000001p+53 },
+  { "72057594037927945", 0x1.0000000000001p+56 },
+  { "1.00000000000000011102230246251565404236316680908203125", 1.0 },
+  { "1.00000000000000011102230246251565404236316680908203126",
+    0x1.0000000000001p+0 },
+  { "123456789012345678901234567890", 0x1.8ee90ff6c373ep+96 },
+  { "1.7976931348623157e308", DBL_MAX },
+  { "2.2250738585072014e-308", 0x1p-1022 },
+  { "2.2250738585072011e-308", 0x0.fffffffffffffp-1022 },
+  { "4.9406564584124654e-324", 0x0.0000000000001p-1022 },
+};
+
+int main ()
+{
+  char buf[64], *end;
+  double d, x;
+  int i;
+
+  for (i = 0; i < (int) (sizeof (tests) / sizeof (tests[0])); i++)
+    {
+      d = strtod (tests[i].s, &end);
+      if (d != tests[i].d || *end != '\0')
+	{
+	  printf ("strtod (\"%s\") = %a, expected %a\n", tests[i].s, d,
+		  tests[i].d);
+	  abort ();
+	}
+      sprintf (buf, "-%s", tests[i].s);
+      if (strtod (buf, NULL) != -d)
+	abort ();
+    }
+
+  /* 17 significant digits identify a double.  */
+  for (i = 0, x = 1.0; i < 2000; i++, x = x * 1.37 + 1e-3)
+    {
+      d = i & 1 ? x : 1 / x;
+      sprintf (buf, "%.17g", d);
+      if (strtod (buf, NULL) != d)
+	{
+	  printf ("strtod (\"%s\") != %a\n", buf, d);
+	  abort ();
+	}
+      if (x > 1e300)
+	x = 1.0 + i;
+    }
+  exit (0);
+}
@@ -0,0 +1,187 @@
+/*
+ * Test and benchmark for the string and memory functions.
+ *
+ * Runs each function over buffers of several lengths, both the version
+ * in the library, which may come from the machine directory (such as the
+ * SSE2 and AVX2 ones of x86_64), and the generic C of libc/string, which
+ * is compiled in here under other names.  The results of the two are
+ * checked to agree, and the rate of each in bytes per second is printed.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "check.h"
+
+/* The generic C versions.  */
+#define strlen generic_strlen
+#include "../../libc/string/strlen.c"
+#undef strlen
+#define strnlen generic_strnlen
+#include "../../libc/string/strnlen.c"
+#undef strnlen
+#undef UNALIGNED
+#undef LBLOCKSIZE
+#undef DETECTNULL
+#define memchr generic_memchr
+#include "../../libc/string/memchr.c"
+#undef memchr
+#undef UNALIGNED
+#undef LBLOCKSIZE
+#undef TOO_SMALL
+#undef DETECTNULL
+#undef DETECTCHAR
+#define memrchr generic_memrchr
+#include "../../libc/string/memrchr.c"
+#undef memrchr
+#undef UNALIGNED
+#undef LBLOCKSIZE
+#undef TOO_SMALL
+#undef DETECTNULL
+#undef DETECTCHAR
+#define rawmemchr generic_rawmemchr
+#include "../../libc/string/rawmemchr.c"
+#undef rawmemchr
+#undef UNALIGNED
+#undef LBLOCKSIZE
+#undef TOO_SMALL
+#undef DETECTNULL
+#undef DETECTCHAR
+#define strchr generic_strchr
+#include "../../libc/string/strchr.c"
+#undef strchr
+#undef UNALIGNED
+#undef LBLOCKSIZE
+#undef DETECTNULL
+#undef DETECTCHAR
+#define strrchr generic_strrchr
+#include "../../libc/string/strrchr.c"
+#undef strrchr
+#define strcmp generic_strcmp
+#include "../../libc/string/strcmp.c"
+#undef strcmp
+#undef UNALIGNED
+#undef DETECTNULL
+#define strncmp generic_strncmp
+#include "../../libc/string/strncmp.c"
+#undef strncmp
+#undef UNALIGNED
+#undef DETECTNULL
+#define memcmp generic_memcmp
+#include "../../libc/string/memcmp.c"
+#undef memcmp
+#undef UNALIGNED
+#undef LBLOCKSIZE
+#undef TOO_SMALL
+#define memmove generic_memmove
+#include "../../libc/string/memmove.c"
+#undef memmove
+#undef UNALIGNED
+#undef TOO_SMALL
+#define stpcpy generic_stpcpy
+#include "../../libc/string/stpcpy.c"
+#undef stpcpy
+
+#define MAXLEN	4096
+#define NBYTES	(1L << 24)	/* bytes processed per run */
+
+static char buf1[MAXLEN + 64], buf2[MAXLEN + 64], dst[MAXLEN + 64];
+static const size_t lengths[] = { 15, 64, 256, MAXLEN };
+
+enum { STRLEN, STRNLEN, MEMCHR, MEMRCHR, RAWMEMCHR, STRCHR, STRRCHR, STRCMP,
+       STRNCMP, MEMCMP, MEMMOVE, STPCPY, NFUNCS };
+
+static const char *const names[NFUNCS] = {
+  "strlen", "strnlen", "memchr", "memrchr", "rawmemchr", "strchr",
+  "strrchr", "strcmp", "strncmp", "memcmp", "memmove", "stpcpy"
+};
+
+/* The offset of P from S, or -1 if P is null.  */
+static long
+offset (const void *p, const char *s)
+{
+  return p ? (const char *) p - s : -1;
+}
+
+/* Run function F of the library, or its generic version, on strings of
+   LEN bytes at S and T, and return a value that depends on the result.  */
+static long
+run (int f, int generic, const char *s, const char *t, size_t len)
+{
+  switch (f)
+    {
+    case STRLEN:
+      return generic ? generic_strlen (s) : strlen (s);
+    case STRNLEN:
+      return generic ? generic_strnlen (s, len + 1) : strnlen (s, len + 1);
+    case MEMCHR:
+      return offset (generic ? generic_memchr (s, 'z', len)
+		     : memchr (s, 'z', len), s);
+    case MEMRCHR:
+      return offset (generic ? generic_memrchr (s, 'z', len)
+		     : memrchr (s, 'z', len), s);
+    case RAWMEMCHR:
+      return (generic ? (char *) generic_rawmemchr (s, 0)
+	      : (char *) rawmemchr (s, 0)) - s;
+    case STRCHR:
+      return (generic ? generic_strchr (s, 0) : strchr (s, 0)) - s;
+    case STRRCHR:
+      return (generic ? generic_strrchr (s, 'a') : strrchr (s, 'a')) - s;
+    case STRCMP:
+      return generic ? generic_strcmp (s, t) : strcmp (s, t);
+    case STRNCMP:
+      return generic ? generic_strncmp (s, t, len) : strncmp (s, t, len);
+    case MEMCMP:
+      return generic ? generic_memcmp (s, t, len) : memcmp (s, t, len);
+    case MEMMOVE:
+      if (generic)
+	generic_memmove (dst + 1, s, len);
+      else
+	memmove (dst + 1, s, len);
+      return dst[len];
+    case STPCPY:
+      return (generic ? generic_stpcpy (dst + 3, s) : stpcpy (dst + 3, s))
+	- dst;
+    }
+  return 0;
+}
+
+int
+main (void)
+{
+  double rate[2], secs;
+  long n, i, r[2];
+  clock_t t;
+  size_t len;
+  int f, g, k;
+
+  for (f = 0; f < NFUNCS; f++)
+    for (k = 0; k < (int) (sizeof (lengths) / sizeof (lengths[0])); k++)
+      {
+	len = lengths[k];
+	/* 'a'..'y', with the last byte of the second string a 'z' */
+	for (i = 0; i < (long) len; i++)
+	  buf1[i + 1] = buf2[i + 3] = 'a' + i % 25;
+	buf1[len + 1] = buf2[len + 3] = '\0';
+	buf2[len + 2] = 'z';
+	n = NBYTES / (len + 1);
+	for (g = 0; g < 2; g++)
+	  {
+	    r[g] = run (f, g, buf1 + 1, buf2 + 3, len);
+	    t = clock ();
+	    for (i = 0; i < n; i++)
+	      run (f, g, buf1 + 1, buf2 + 3, len);
+	    t = clock () - t;
+	    secs = (double) t / CLOCKS_PER_SEC;
+	    rate[g] = secs > 0 ? (double) n * len / secs : 0.0;
+	  }
+	CHECK ((r[0] > 0) == (r[1] > 0) && (r[0] < 0) == (r[1] < 0));
+	if (f != STRNCMP && f != STRCMP && f != MEMCMP)
+	  CHECK (r[0] == r[1]);
+	printf ("%-10s %5lu bytes %10.0f MB/s, generic %10.0f MB/s\n",
+		names[f], (unsigned long) len, rate[0] / 1e6, rate[1] / 1e6);
+      }
+  exit (0);
+}
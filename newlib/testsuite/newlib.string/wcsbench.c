@@ -0,0 +1,125 @@
+/*
+ * Test and benchmark for wcsstr and wmemmem.
+ *
+ * Searches for needles of 1 to 256 wide characters, both in text where
+ * they are absent and in repetitive text that makes a naive search
+ * quadratic, and checks that wcsstr and wmemmem agree with the naive
+ * version of wcsstr, which is compiled in here under another name.  The
+ * rate of each in characters per second is printed.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include <time.h>
+#include "check.h"
+
+/* The naive, size-optimized version.  */
+#define PREFER_SIZE_OVER_SPEED
+#define wcsstr naive_wcsstr
+#include "../../libc/string/wcsstr.c"
+#undef wcsstr
+#undef PREFER_SIZE_OVER_SPEED
+
+#define HSLEN	16384
+#define NCHARS	(1L << 22)	/* haystack characters searched per run */
+
+static wchar_t hs[HSLEN + 1], ne[257];
+static const size_t lengths[] = { 1, 2, 3, 4, 8, 16, 31, 32, 64, 128, 256 };
+
+enum { WCSSTR, WMEMMEM, NAIVE, NFUNCS };
+
+static long
+run (int f, size_t len)
+{
+  wchar_t *p;
+
+  switch (f)
+    {
+    case WCSSTR:
+      p = wcsstr (hs, ne);
+      break;
+    case WMEMMEM:
+      p = wmemmem (hs, HSLEN, ne, len);
+      break;
+    default:
+      p = naive_wcsstr (hs, ne);
+      break;
+    }
+  return p ? p - hs : -1;
+}
+
+int
+main (void)
+{
+  double rate[NFUNCS], secs;
+  long n, i, r[NFUNCS];
+  clock_t t;
+  size_t len;
+  int f, k, rep;
+
+  for (rep = 0; rep < 2; rep++)
+    for (k = 0; k < (int) (sizeof (lengths) / sizeof (lengths[0])); k++)
+      {
+	len = lengths[k];
+	if (rep)
+	  {
+	    /* "aaa...a" in "aaa...ab", found only at the end */
+	    for (i = 0; i < HSLEN; i++)
+	      hs[i] = L'a';
+	    hs[HSLEN - 1] = L'b';
+	    for (i = 0; i < (long) len; i++)
+	      ne[i] = L'a';
+	    ne[len - 1] = L'b';
+	  }
+	else
+	  {
+	    /* Cyrillic text with the needle made of its characters,
+	       but in an order that does not occur */
+	    for (i = 0; i < HSLEN; i++)
+	      hs[i] = 0x430 + i * 7 % 31;
+	    for (i = 0; i < (long) len; i++)
+	      ne[i] = 0x430 + i * 11 % 31;
+	    ne[len - 1] = 0x42F;
+	  }
+	hs[HSLEN] = ne[len] = L'\0';
+	n = NCHARS / HSLEN;
+	for (f = 0; f < NFUNCS; f++)
+	  {
+	    r[f] = run (f, len);
+	    t = clock ();
+	    for (i = 0; i < n; i++)
+	      run (f, len);
+	    t = clock () - t;
+	    secs = (double) t / CLOCKS_PER_SEC;
+	    rate[f] = secs > 0 ? (double) n * HSLEN / secs : 0.0;
+	  }
+	CHECK (r[0] == r[2] && r[1] == r[2]);
+	CHECK (r[2] == (rep ? (long) (HSLEN - len) : -1));
+	printf ("%-10s %3lu chars %8.0f Mchars/s, wmemmem %8.0f, naive %8.0f\n",
+		rep ? "repeated" : "absent", (unsigned long) len,
+		rate[WCSSTR] / 1e6, rate[WMEMMEM] / 1e6, rate[NAIVE] / 1e6);
+      }
+
+  /* Matches at the start, in the middle, at the end, and overlapping */
+  wcscpy (hs, L"abababcabababcababcab");
+  CHECK (wcsstr (hs, L"abab") == hs);
+  CHECK (wcsstr (hs, L"ababc") == hs + 2);
+  CHECK (wcsstr (hs, L"ababcab\0") == hs + 2);
+  CHECK (wcsstr (hs, L"cabababca") == hs + 6);
+  CHECK (wcsstr (hs, L"ababcababcab") == hs + 9);
+  CHECK (wcsstr (hs, L"abababab") == NULL);
+  CHECK (wcsstr (hs, L"") == hs);
+  CHECK (wcsstr (L"", L"a") == NULL);
+  CHECK (wmemmem (hs, 21, L"cab", 3) == hs + 6);
+  CHECK (wmemmem (hs, 21, L"abcab", 5) == hs + 4);
+  CHECK (wmemmem (hs + 15, 6, L"cab", 3) == hs + 18);
+  CHECK (wmemmem (hs + 15, 5, L"cab", 3) == NULL);
+  CHECK (wmemmem (hs, 4, L"abab", 4) == hs);
+  CHECK (wmemmem (hs, 3, L"abab", 4) == NULL);
+  CHECK (wmemmem (hs, 0, L"", 0) == hs);
+  CHECK (wmemmem (L"a\0b\0c", 5, L"b\0c", 3) != NULL);
+
+  exit (0);
+}
@@ -0,0 +1,53 @@
+/* Test that localtime(3) notices changes to TZ made by setenv(3),
+   unsetenv(3) and by replacing environ without a call to tzset(3).  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+extern char **environ;
+
+/* July, 15th 2022 at 10:50am and 40 seconds UTC */
+static const time_t summer_time = 1657882240;
+
+static int failed;
+
+static void
+check (const char *what, int hour, int isdst)
+{
+  struct tm tm;
+
+  localtime_r (&summer_time, &tm);
+  if (tm.tm_hour != hour || tm.tm_isdst != isdst)
+    {
+      printf ("%s: hour %d isdst %d, expected %d %d\n", what, tm.tm_hour,
+	      tm.tm_isdst, hour, isdst);
+      failed = 1;
+    }
+}
+
+int
+main (void)
+{
+  static char *env[] = { "TZ=JST-9", NULL };
+  char **save;
+
+  setenv ("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+  tzset ();
+  check ("CET", 12, 1);
+  setenv ("TZ", "EST5EDT,M3.2.0,M11.1.0", 1);
+  check ("setenv", 6, 1);
+  /* a shorter value is copied over the old one */
+  setenv ("TZ", "MSK-3", 1);
+  check ("setenv in place", 13, 0);
+  putenv ("TZ=IST-5:30");
+  check ("putenv", 16, 0);
+  unsetenv ("TZ");
+  check ("unsetenv", 10, 0);
+
+  save = environ;
+  environ = env;
+  check ("environ", 19, 0);
+  environ = save;
+  check ("environ restored", 10, 0);
+  return failed;
+}
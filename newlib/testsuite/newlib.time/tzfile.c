@@ -0,0 +1,173 @@
+/* Test that tzset(3) reads TZif files when configured with
+   --enable-newlib-tzfile, and that localtime(3) and mktime(3) use both
+   the transitions in the file and its TZ string.  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <newlib.h>
+
+#ifdef _WANT_TZFILE
+
+/* A version 2 file for a zone one hour east of UTC with DST in 2000 and
+   2001 only, then the EU rules from the TZ string.  */
+#define T2000_DST  954032400	/* 2000-03-26 01:00 UTC */
+#define T2000_STD  972781200	/* 2000-10-29 01:00 UTC */
+#define T2001_DST  985482000	/* 2001-03-25 01:00 UTC */
+#define T2001_STD 1004230800	/* 2001-10-28 01:00 UTC */
+
+static const char rule[] = "\nTST-1TDT,M3.5.0,M10.5.0/3\n";
+
+static unsigned char *
+put32 (unsigned char *p, long v)
+{
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+  return p + 4;
+}
+
+static unsigned char *
+header (unsigned char *p, int timecnt, int typecnt, int charcnt)
+{
+  memcpy (p, "TZif2", 5);
+  memset (p + 5, 0, 15);
+  p = put32 (p + 20, 0);	/* isutcnt */
+  p = put32 (p, 0);		/* isstdcnt */
+  p = put32 (p, 0);		/* leapcnt */
+  p = put32 (p, timecnt);
+  p = put32 (p, typecnt);
+  return put32 (p, charcnt);
+}
+
+static void
+mkzone (const char *path)
+{
+  static const long ats[] = { T2000_DST, T2000_STD, T2001_DST, T2001_STD };
+  unsigned char buf[256], *p = buf;
+  FILE *fp;
+  int i;
+
+  /* version 1 data, which is not used */
+  p = header (p, 0, 1, 4);
+  p = put32 (p, 3600);
+  *p++ = 0;
+  *p++ = 0;
+  memcpy (p, "TST", 4);
+  p += 4;
+
+  p = header (p, 4, 2, 8);
+  for (i = 0; i < 4; i++)
+    p = put32 (put32 (p, 0), ats[i]);
+  for (i = 0; i < 4; i++)
+    *p++ = i % 2 == 0;
+  p = put32 (p, 3600);
+  *p++ = 0;
+  *p++ = 0;
+  p = put32 (p, 7200);
+  *p++ = 1;
+  *p++ = 4;
+  memcpy (p, "TST\0TDT", 8);
+  p += 8;
+  memcpy (p, rule, sizeof (rule) - 1);
+  p += sizeof (rule) - 1;
+
+  if ((fp = fopen (path, "wb")) == NULL
+      || fwrite (buf, 1, p - buf, fp) != (size_t) (p - buf)
+      || fclose (fp) != 0)
+    {
+      printf ("cannot write %s\n", path);
+      exit (1);
+    }
+}
+
+static int failed;
+
+static void
+check (time_t t, int hour, int isdst)
+{
+  struct tm tm;
+  time_t u;
+
+  localtime_r (&t, &tm);
+  if (tm.tm_hour != hour || tm.tm_isdst != isdst)
+    {
+      printf ("localtime (%ld): hour %d isdst %d, expected %d %d\n",
+	      (long) t, tm.tm_hour, tm.tm_isdst, hour, isdst);
+      failed = 1;
+    }
+  if ((u = mktime (&tm)) != t)
+    {
+      printf ("mktime (localtime (%ld)) = %ld\n", (long) t, (long) u);
+      failed = 1;
+    }
+}
+
+int
+main (void)
+{
+  char path[L_tmpnam];
+  struct tm tm;
+
+  if (tmpnam (path) == NULL)
+    return 1;
+  mkzone (path);
+  setenv ("TZ", path, 1);
+  tzset ();
+  if (strcmp (tzname[0], "TST") != 0 || strcmp (tzname[1], "TDT") != 0)
+    {
+      printf ("tzname %s %s\n", tzname[0], tzname[1]);
+      failed = 1;
+    }
+
+  check (T2000_DST - 1, 1, 0);
+  check (T2000_DST, 3, 1);
+  check (T2000_STD - 1, 2, 1);
+  check (T2000_STD, 2, 0);
+  check (T2001_DST + 86400 * 30, 3, 1);
+  /* after the last transition */
+  check (T2001_STD + 86400 * 100, 2, 0);
+  check (1657882240, 12, 1);		/* 2022-07-15 10:50:40 UTC */
+
+  /* 02:30 on 2000-03-26 does not exist; 2000-10-29 02:30 happens twice */
+  memset (&tm, 0, sizeof (tm));
+  tm.tm_year = 100;
+  tm.tm_mon = 2;
+  tm.tm_mday = 26;
+  tm.tm_hour = 2;
+  tm.tm_min = 30;
+  tm.tm_isdst = -1;
+  if (mktime (&tm) != T2000_DST + 1800 || tm.tm_hour != 3 || !tm.tm_isdst)
+    failed = 1;
+  tm.tm_mon = 9;
+  tm.tm_mday = 29;
+  tm.tm_hour = 2;
+  tm.tm_isdst = 1;
+  if (mktime (&tm) != T2000_STD - 1800 || !tm.tm_isdst)
+    failed = 1;
+  tm.tm_hour = 2;
+  tm.tm_isdst = 0;
+  if (mktime (&tm) != T2000_STD + 1800 || tm.tm_isdst)
+    failed = 1;
+
+  /* switching to another zone and back */
+  setenv ("TZ", "EST5", 1);
+  tzset ();
+  check (T2000_DST, 20, 0);
+  setenv ("TZ", path, 1);
+  check (T2000_DST, 3, 1);
+
+  remove (path);
+  return failed;
+}
+
+#else
+
+int
+main (void)
+{
+  return 0;
+}
+
+#endif